@@ -0,0 +1,39 @@
+// Check where the VCD dump stops when the $dumplimit is reached. The
+// limit is checked once at the end of each time step, so the comment
+// comes after the $dumpall that went over the limit, and the other
+// changes of that time step are not dumped. The dump is read back from
+// the end of the header, as the header has the date in it.
+
+module test;
+
+reg [31:0] a;
+reg [7:0] b;
+reg [8*80:1] line;
+integer fd, i, shown;
+
+initial begin
+  $dumpfile("work/dumplimit1.vcd");
+  $dumpvars(0, a, b);
+  $dumplimit(380);
+  a = 0;
+  b = 0;
+  for (i = 1 ; i < 4 ; i = i + 1) begin
+    #1 a = i;
+    b = i;
+  end
+  #1 a = 4;
+  $dumpall;
+  b = 4;
+  #1 a = 5;
+  #1 $dumpflush;
+
+  fd = $fopen("work/dumplimit1.vcd", "r");
+  shown = 0;
+  while ($fgets(line, fd)) begin
+    if (line == "$enddefinitions $end\n") shown = 1;
+    if (shown) $write("%0s", line);
+  end
+  $fclose(fd);
+end
+
+endmodule
@@ -0,0 +1,42 @@
+// Write an FST dump that ends with an $error. fst_ring1a writes it
+// normally and fst_ring1b with +fst+ring=1000, a window that holds the
+// whole simulation, so the $error writes out everything. The change of
+// c after the $error is in the same time step, so it must be in the
+// ring dump too. fst_ring1c checks that the two files are the same.
+
+module dut;
+
+reg [7:0] c;
+reg [63:0] w;
+real r;
+
+initial begin
+  c = 0;
+  w = 64'h0123456789abcdef;
+  r = 0.5;
+  repeat (30) begin
+    #1 c = c + 1;
+    w = {w[62:0], w[63]};
+    r = r + 1.0;
+  end
+  #1 $error("c is %0d", c);
+  c = 8'hff;
+  $display("PASSED");
+end
+
+endmodule
+
+module test;
+
+reg [8*40:1] fname;
+
+dut dut();
+
+initial begin
+  if (! $value$plusargs("dumpfile=%s", fname))
+    fname = "work/fst_ring1.fst";
+  $dumpfile(fname);
+  $dumpvars(0, dut);
+end
+
+endmodule
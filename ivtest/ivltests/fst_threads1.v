@@ -0,0 +1,42 @@
+// Write an FST dump of many blocks. The $dumpflush calls end a block
+// every 100 steps. fst_threads1a writes it with +fst+threads=0,
+// fst_threads1b with the writer thread and fst_threads1c with
+// +fst+threads=2, so each block is compressed in its own thread and
+// the file is closed while the thread of the last block may still be
+// running. fst_threads1d checks that the three files are the same.
+
+module dut;
+
+reg [63:0] wide;
+reg [7:0] count;
+integer i;
+
+initial begin
+  wide = 64'h0123456789abcdef;
+  count = 0;
+  for (i = 0 ; i < 2000 ; i = i + 1) begin
+    #1 count = count + 1;
+    wide = {wide[62:0], wide[63] ^ wide[62]};
+    if (i % 100 == 99) $dumpflush;
+  end
+
+  if (count !== 8'd208) $display("FAILED: count is %0d", count);
+  else $display("PASSED");
+end
+
+endmodule
+
+module test;
+
+reg [8*40:1] fname;
+
+dut dut();
+
+initial begin
+  if (! $value$plusargs("dumpfile=%s", fname))
+    fname = "work/fst_threads1.fst";
+  $dumpfile(fname);
+  $dumpvars(0, dut);
+end
+
+endmodule
@@ -0,0 +1,44 @@
+// Check that fst_threads1b and fst_threads1c wrote the same FST file
+// as fst_threads1a. The date in the header (bytes 202 to 320) is not
+// compared.
+
+module test;
+
+integer fd0, fd1, fd2, ch0, ch1, ch2, pos, errors;
+
+initial begin
+  fd0 = $fopen("work/fst_threads1a.fst", "rb");
+  fd1 = $fopen("work/fst_threads1b.fst", "rb");
+  fd2 = $fopen("work/fst_threads1c.fst", "rb");
+  if (fd0 == 0 || fd1 == 0 || fd2 == 0) begin
+    $display("FAILED: cannot open the dump files");
+    $finish;
+  end
+
+  errors = 0;
+  pos = 0;
+  ch0 = $fgetc(fd0);
+  ch1 = $fgetc(fd1);
+  ch2 = $fgetc(fd2);
+  while (errors == 0 && ch0 != -1) begin
+    if ((pos < 202 || pos > 320) && (ch1 != ch0 || ch2 != ch0)) begin
+      $display("FAILED: the dump files differ at byte %0d", pos);
+      errors = errors + 1;
+    end
+    pos = pos + 1;
+    ch0 = $fgetc(fd0);
+    ch1 = $fgetc(fd1);
+    ch2 = $fgetc(fd2);
+  end
+  if (errors == 0 && (ch1 != -1 || ch2 != -1)) begin
+    $display("FAILED: the dump files differ in size");
+    errors = errors + 1;
+  end
+  $fclose(fd0);
+  $fclose(fd1);
+  $fclose(fd2);
+
+  if (errors == 0) $display("PASSED");
+end
+
+endmodule
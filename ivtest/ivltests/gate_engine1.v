@@ -0,0 +1,157 @@
+// Check a netlist of zero delay gates against the same logic computed
+// by behavioral code. The netlist has nets with several fan-outs, gates
+// with more than two inputs, a buf and a not with two outputs and a
+// long chain of gates. The inputs are driven with 0, 1, x and z. This
+// is run both with the default engine and with --gate-engine, which
+// must give the same settled values.
+
+module test;
+
+reg [7:0] in;
+reg failed;
+integer i, j, k;
+
+  // A small netlist with fan-out from both the inputs and the gates.
+wire n1, n2, n3, n4, n5, n6, n7, n8, n9, n10, o1, o2a, o2b, o3a, o3b;
+
+and  g1(n1, in[0], in[1]);
+or   g2(n2, in[1], in[2]);
+xor  g3(n3, n1, n2);
+nand g4(n4, n1, in[3]);
+nor  g5(n5, n2, n3, in[4]);
+xnor g6(n6, n4, n5);
+not  g7(n7, n6);
+buf  g8(n8, n7);
+and  g9(n9, n8, n3, in[5]);
+or   g10(n10, n9, n6, in[6]);
+xor  g11(o1, n10, in[7]);
+buf  g12(o2a, o2b, n3);
+not  g13(o3a, o3b, n9);
+
+  // A chain of 64 gates, each also taking one of the inputs.
+genvar gi;
+generate
+  for (gi = 0 ; gi < 64 ; gi = gi + 1) begin : chain
+    wire o;
+    if (gi == 0) begin : first
+      not g(o, in[0]);
+    end else if (gi % 4 == 1) begin : s1
+      and g(o, chain[gi-1].o, in[gi % 8]);
+    end else if (gi % 4 == 2) begin : s2
+      nor g(o, chain[gi-1].o, in[(gi+3) % 8]);
+    end else if (gi % 4 == 3) begin : s3
+      xor g(o, chain[gi-1].o, in[(gi+5) % 8]);
+    end else begin : s0
+      nand g(o, chain[gi-1].o, in[(gi+1) % 8]);
+    end
+  end
+endgenerate
+
+  // One net that fans out to 16 gates.
+wire [15:0] fan;
+generate
+  for (gi = 0 ; gi < 16 ; gi = gi + 1) begin : fanout
+    wire o;
+    if (gi % 4 == 0) begin : f0
+      and g(o, n3, in[gi % 8]);
+    end else if (gi % 4 == 1) begin : f1
+      or g(o, n3, in[gi % 8]);
+    end else if (gi % 4 == 2) begin : f2
+      xnor g(o, n3, in[gi % 8]);
+    end else begin : f3
+      not g(o, n3);
+    end
+    assign fan[gi] = o;
+  end
+endgenerate
+
+reg e1, e2, e3, e4, e5, e6, e7, e8, e9, e10, eo1, echain;
+reg [15:0] efan;
+
+task check;
+  begin
+      // The behavioral operators treat z inputs as x, as the gates do.
+    e1 = in[0] & in[1];
+    e2 = in[1] | in[2];
+    e3 = e1 ^ e2;
+    e4 = ~(e1 & in[3]);
+    e5 = ~(e2 | e3 | in[4]);
+    e6 = ~(e4 ^ e5);
+    e7 = ~e6;
+    e8 = e7 | 1'b0;
+    e9 = e8 & e3 & in[5];
+    e10 = e9 | e6 | in[6];
+    eo1 = e10 ^ in[7];
+
+    echain = ~in[0];
+    for (k = 1 ; k < 64 ; k = k + 1)
+      case (k % 4)
+        1: echain = echain & in[k % 8];
+        2: echain = ~(echain | in[(k+3) % 8]);
+        3: echain = echain ^ in[(k+5) % 8];
+        0: echain = ~(echain & in[(k+1) % 8]);
+      endcase
+
+    for (k = 0 ; k < 16 ; k = k + 1)
+      case (k % 4)
+        0: efan[k] = e3 & in[k % 8];
+        1: efan[k] = e3 | in[k % 8];
+        2: efan[k] = ~(e3 ^ in[k % 8]);
+        3: efan[k] = ~e3;
+      endcase
+
+    if ({n1, n2, n3, n4, n5, n6, n7, n8, n9, n10, o1} !==
+        {e1, e2, e3, e4, e5, e6, e7, e8, e9, e10, eo1}) begin
+      $display("FAILED: in=%b netlist %b, expected %b", in,
+               {n1, n2, n3, n4, n5, n6, n7, n8, n9, n10, o1},
+               {e1, e2, e3, e4, e5, e6, e7, e8, e9, e10, eo1});
+      failed = 1;
+    end
+    if ({o2a, o2b, o3a, o3b} !== {e3 | 1'b0, e3 | 1'b0, ~e9, ~e9}) begin
+      $display("FAILED: in=%b two output gates %b", in, {o2a, o2b, o3a, o3b});
+      failed = 1;
+    end
+    if (chain[63].o !== echain) begin
+      $display("FAILED: in=%b chain %b, expected %b", in, chain[63].o, echain);
+      failed = 1;
+    end
+    if (fan !== efan) begin
+      $display("FAILED: in=%b fan-out %b, expected %b", in, fan, efan);
+      failed = 1;
+    end
+  end
+endtask
+
+initial begin
+  failed = 0;
+
+    // All 0/1 input values.
+  for (i = 0 ; i < 256 ; i = i + 1) begin
+    in = i;
+    #1 check;
+  end
+
+    // Random input values with x and z bits.
+  for (i = 0 ; i < 1000 ; i = i + 1) begin
+    for (j = 0 ; j < 8 ; j = j + 1)
+      case ($random & 3)
+        0: in[j] = 1'b0;
+        1: in[j] = 1'b1;
+        2: in[j] = 1'bx;
+        3: in[j] = 1'bz;
+      endcase
+    #1 check;
+  end
+
+    // Change one input at a time, so only a part of the netlist
+    // changes.
+  in = 8'b0;
+  for (i = 0 ; i < 64 ; i = i + 1) begin
+    in[i % 8] = (i / 8) % 2 ? 1'bx : ~in[i % 8];
+    #1 check;
+  end
+
+  if (!failed) $display("PASSED");
+end
+
+endmodule
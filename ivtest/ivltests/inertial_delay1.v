@@ -0,0 +1,105 @@
+// Check that gate and continuous assignment delays reject pulses that
+// are shorter than the delay, and pass pulses that are longer. This is
+// run both with the default delay model and with --inertial-delay,
+// which must give the same output changes.
+
+module test;
+
+reg a, b;
+wire ya, yb;
+reg failed;
+
+assign #5 ya = a;
+buf #5 (yb, b);
+
+  // The times and values of the output changes.
+integer na, nb;
+reg [63:0] ta [0:7];
+reg [63:0] tb [0:7];
+reg va [0:7];
+reg vb [0:7];
+
+always @(ya) begin
+  if (na < 8) begin
+    ta[na] = $time;
+    va[na] = ya;
+  end
+  na = na + 1;
+end
+
+always @(yb) begin
+  if (nb < 8) begin
+    tb[nb] = $time;
+    vb[nb] = yb;
+  end
+  nb = nb + 1;
+end
+
+task drive;
+  input v;
+  begin
+    a = v;
+    b = v;
+  end
+endtask
+
+task check;
+  input [8*8:1] what;
+  input integer n;
+  input integer idx;
+  input [63:0] t;
+  input [63:0] tv;
+  input v;
+  input vv;
+  begin
+    if (n <= idx) begin
+      $display("FAILED: %0s has only %0d changes", what, n);
+      failed = 1;
+    end else if (tv !== t || vv !== v) begin
+      $display("FAILED: %0s change %0d is %b at %0t, expected %b at %0t",
+               what, idx, vv, tv, v, t);
+      failed = 1;
+    end
+  end
+endtask
+
+initial begin
+  failed = 0;
+  na = 0;
+  nb = 0;
+
+  drive(1'b0);
+    // A pulse shorter than the delay is rejected.
+  #20 drive(1'b1);
+  #2  drive(1'b0);
+    // A pulse longer than the delay is passed.
+  #18 drive(1'b1);
+  #8  drive(1'b0);
+    // A train of short pulses is rejected.
+  #12 drive(1'b1);
+  #1  drive(1'b0);
+  #1  drive(1'b1);
+  #1  drive(1'b0);
+    // Only the last of several changes is passed.
+  #17 drive(1'b1);
+  #3  drive(1'b0);
+  #1  drive(1'b1);
+  #20;
+
+  check("assign", na, 0, 5, ta[0], 1'b0, va[0]);
+  check("assign", na, 1, 45, ta[1], 1'b1, va[1]);
+  check("assign", na, 2, 53, ta[2], 1'b0, va[2]);
+  check("assign", na, 3, 89, ta[3], 1'b1, va[3]);
+  check("buf", nb, 0, 5, tb[0], 1'b0, vb[0]);
+  check("buf", nb, 1, 45, tb[1], 1'b1, vb[1]);
+  check("buf", nb, 2, 53, tb[2], 1'b0, vb[2]);
+  check("buf", nb, 3, 89, tb[3], 1'b1, vb[3]);
+  if (na != 4 || nb != 4) begin
+    $display("FAILED: %0d and %0d changes, expected 4", na, nb);
+    failed = 1;
+  end
+
+  if (!failed) $display("PASSED");
+end
+
+endmodule
@@ -0,0 +1,25 @@
+// Check that a $monitor is displayed only once in a time step, when
+// $monitoron is called after a monitored value has already changed in
+// that time step. A change before a $monitoroff in the same time step
+// is still displayed.
+
+module test;
+
+integer a;
+
+initial begin
+  a = 0;
+  $monitor("@%0t a = %0d", $time, a);
+  #1 a = 1;
+  #1 a = 2;
+  $monitoron;
+  #1 a = 3;
+  $monitoroff;
+  #1 a = 4;
+  #1 a = 5;
+  $monitoron;
+  #1 a = 6;
+  #1 $finish(0);
+end
+
+endmodule
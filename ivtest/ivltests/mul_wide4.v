@@ -0,0 +1,107 @@
+// Check wide 4-state multiplies against a shift and add reference. The
+// widths are and are not a multiple of the word size, and the widest ones
+// are large enough for the Karatsuba multiply. A multiply with an x or z
+// operand bit must give all x bits.
+
+module mul_check;
+
+parameter W = 8;
+
+reg [W-1:0] a, b, r, sum;
+reg failed;
+integer i, n;
+
+task fill_random;
+  begin
+    a = 0;
+    b = 0;
+    for (i = 0 ; i < W ; i = i + 32) begin
+      a = {a, $random};
+      b = {b, $random};
+    end
+  end
+endtask
+
+task check_2state;
+  begin
+    sum = 0;
+    for (i = 0 ; i < W ; i = i + 1)
+      if (b[i]) sum = sum + (a << i);
+    r = a * b;
+    if (r !== sum) begin
+      $display("FAILED: W=%0d %h * %h = %h, expected %h", W, a, b, r, sum);
+      failed = 1;
+    end
+  end
+endtask
+
+task check_4state;
+  begin
+    r = a * b;
+    if (r !== {W{1'bx}}) begin
+      $display("FAILED: W=%0d %h * %h = %h, expected all x", W, a, b, r);
+      failed = 1;
+    end
+  end
+endtask
+
+initial begin
+  failed = 0;
+
+  for (n = 0 ; n < 4 ; n = n + 1) begin
+    fill_random;
+    check_2state;
+  end
+
+    // All ones times all ones, and a value times itself.
+  a = {W{1'b1}};
+  b = {W{1'b1}};
+  check_2state;
+  fill_random;
+  b = a;
+  check_2state;
+
+    // A multiply by a constant.
+  fill_random;
+  r = a * 3;
+  if (r !== a + a + a) begin
+    $display("FAILED: W=%0d %h * 3 = %h", W, a, r);
+    failed = 1;
+  end
+
+    // An x or z bit anywhere in either operand.
+  fill_random;
+  b[W-1] = 1'bx;
+  check_4state;
+  fill_random;
+  a[W/2] = 1'bz;
+  check_4state;
+  fill_random;
+  a[0] = 1'bx;
+  b[0] = 1'bz;
+  check_4state;
+end
+
+endmodule
+
+module top;
+
+mul_check #(.W(33))   m33();
+mul_check #(.W(64))   m64();
+mul_check #(.W(65))   m65();
+mul_check #(.W(100))  m100();
+mul_check #(.W(128))  m128();
+mul_check #(.W(2048)) m2048();
+mul_check #(.W(2113)) m2113();
+mul_check #(.W(4096)) m4096();
+
+initial begin
+  #1;
+  if (m33.failed | m64.failed | m65.failed | m100.failed | m128.failed |
+      m2048.failed | m2113.failed | m4096.failed)
+    $display("FAILED");
+  else
+    $display("PASSED");
+end
+
+endmodule
@@ -0,0 +1,18 @@
+// Run with the profiler (-p) to write work/profile1.json, which the
+// profile1b test then checks. The net "a" drives more gates than fit
+// in a functor's inline fan-out, and the loop increment is one of the
+// sequences that vvp fuses into a superinstruction.
+module test;
+   reg a;
+   wire y0, y1, y2, y3, y4;
+   integer i;
+
+   not g0(y0, a), g1(y1, a), g2(y2, a), g3(y3, a), g4(y4, a);
+
+   initial begin
+      a = 0;
+      for (i = 0; i < 10; i = i + 1)
+	 #1 a = ~a;
+      $display("PASSED");
+   end
+endmodule
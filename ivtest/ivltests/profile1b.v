@@ -0,0 +1,45 @@
+// Check the profile that profile1a wrote. The instruction counts of
+// the loop lines include the instructions that were fused into
+// superinstructions, and the not gates each receive the values sent
+// through the fan-out of "a".
+module test;
+   string want[6];
+   integer found[6];
+   string line, text;
+   integer fd, idx, errors;
+
+   initial begin
+      want[0] = "  \"threads\": { \"instructions\": 153,";
+      want[1] = "    { \"file\": \"ivltests/profile1a.v\", \"line\": 14, \"instructions\": 80 }";
+      want[2] = "    { \"file\": \"ivltests/profile1a.v\", \"line\": 15, \"instructions\": 40 }";
+      want[3] = "    { \"file\": \"ivltests/profile1a.v\", \"line\": 15, \"instructions\": 20 }";
+      want[4] = "    { \"class\": \"vvp_fun_not\", \"received\": 75 }";
+      want[5] = "    { \"class\": \"vvp_fun_signal4_sa\", \"received\": 24 }";
+
+      fd = $fopen("work/profile1.json", "r");
+      if (fd == 0) begin
+	 $display("FAILED -- cannot open work/profile1.json");
+	 $finish;
+      end
+
+      for (idx = 0; idx < 6; idx = idx + 1)
+	found[idx] = 0;
+      while ($fgets(line, fd)) begin
+	 for (idx = 0; idx < 6; idx = idx + 1) begin
+	    text = want[idx];
+	    if (line.substr(0, text.len()-1) == text)
+	      found[idx] = 1;
+	 end
+      end
+      $fclose(fd);
+
+      errors = 0;
+      for (idx = 0; idx < 6; idx = idx + 1)
+	if (! found[idx]) begin
+	   $display("FAILED -- missing: %s", want[idx]);
+	   errors = errors + 1;
+	end
+      if (errors == 0)
+	$display("PASSED");
+   end
+endmodule
@@ -0,0 +1,32 @@
+// Check the $readmemh and $readmemb file scanner: address records,
+// comments, x and z digits, underscores, words with too many digits,
+// ascending and descending load ranges, and files with too few or too
+// many words for the range.
+
+module test;
+
+reg [7:0]  mh [0:15];
+reg [39:0] mw [0:15];
+reg [3:0]  mb [7:0];
+reg [3:0]  md [0:7];
+reg [7:0]  ms [0:7];
+reg [7:0]  mt [0:7];
+integer i;
+
+initial begin
+  $readmemh("ivltests/readmem_bulk1h.dat", mh);
+  $readmemh("ivltests/readmem_bulk1h.dat", mw);
+  $readmemb("ivltests/readmem_bulk1b.dat", mb, 2, 6);
+  $readmemb("ivltests/readmem_bulk1b.dat", md, 6, 2);
+  $readmemh("ivltests/readmem_bulk1s.dat", ms);
+  $readmemh("ivltests/readmem_bulk1s.dat", mt, 6);
+
+  for (i = 0 ; i < 16 ; i = i + 1)
+    $display("mh[%0d] = %h, mw[%0d] = %h", i, mh[i], i, mw[i]);
+  for (i = 0 ; i < 8 ; i = i + 1)
+    $display("mb[%0d] = %b, md[%0d] = %b", i, mb[i], i, md[i]);
+  for (i = 0 ; i < 8 ; i = i + 1)
+    $display("ms[%0d] = %h, mt[%0d] = %h", i, ms[i], i, mt[i]);
+end
+
+endmodule
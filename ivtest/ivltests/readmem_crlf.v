@@ -0,0 +1,35 @@
+// Check that $readmemh and $readmemb read files with DOS (CR LF)
+// line ends the same as files with LF line ends.
+
+module test;
+
+reg [7:0] mh [0:7];
+reg [3:0] mb [0:3];
+reg failed;
+integer i;
+
+initial begin
+  failed = 0;
+  $readmemh("ivltests/readmem_crlf.dat", mh);
+  $readmemb("ivltests/readmem_crlf_b.dat", mb);
+
+  for (i = 0 ; i < 4 ; i = i + 1)
+    if (mh[i] !== i) begin
+      $display("FAILED -- mh[%0d] = %h", i, mh[i]);
+      failed = 1;
+    end
+  if (mh[4] !== 8'hxx || mh[5] !== 8'hxx || mh[6] !== 8'ha5 || mh[7] !== 8'h5a) begin
+    $display("FAILED -- mh[4:7] = %h %h %h %h", mh[4], mh[5], mh[6], mh[7]);
+    failed = 1;
+  end
+  if (mb[0] !== 4'bxxxx || mb[1] !== 4'b1010 || mb[2] !== 4'bxz01
+      || mb[3] !== 4'bxxxx) begin
+    $display("FAILED -- mb = %b %b %b %b", mb[0], mb[1], mb[2], mb[3]);
+    failed = 1;
+  end
+
+  if (!failed)
+    $display("PASSED");
+end
+
+endmodule
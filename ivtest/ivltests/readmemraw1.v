@@ -0,0 +1,32 @@
+// Check $readmemraw with words of whole bytes, words that are not a
+// whole number of bytes, a file that is not a whole number of words
+// and a descending load range.
+
+module test;
+
+reg [31:0] m32 [0:3];
+reg [11:0] m12 [0:7];
+reg [39:0] m40 [3:0];
+reg [11:0] md [0:7];
+integer fd, i;
+
+initial begin
+  fd = $fopen("work/readmemraw1.bin", "wb");
+  $fwrite(fd, "%u", 32'h04030201);
+  $fwrite(fd, "%u", 32'h08070605);
+  $fwrite(fd, "%u", 32'h0c0b0a09);
+  $fwrite(fd, "%u", 32'h100f0e0d);
+  $fclose(fd);
+
+  $readmemraw("work/readmemraw1.bin", m32);
+  $readmemraw("work/readmemraw1.bin", m12);
+  $readmemraw("work/readmemraw1.bin", m40, 0, 3);
+  $readmemraw("work/readmemraw1.bin", md, 6, 3);
+
+  for (i = 0 ; i < 4 ; i = i + 1)
+    $display("m32[%0d] = %h, m40[%0d] = %h", i, m32[i], i, m40[i]);
+  for (i = 0 ; i < 8 ; i = i + 1)
+    $display("m12[%0d] = %h, md[%0d] = %h", i, m12[i], i, md[i]);
+end
+
+endmodule
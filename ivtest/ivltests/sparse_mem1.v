@@ -0,0 +1,67 @@
+// Run with --sparse-memory 64, so that mem and copy are stored
+// sparsely and full is not. Words that were never written read as
+// x, and $readmemh and $writememh work across the pages.
+module test;
+   reg [7:0] mem [0:4095];
+   reg [7:0] copy [0:4095];
+   reg [7:0] full [0:15];
+   integer fd, idx, errors;
+
+   initial begin
+      errors = 0;
+
+	// Untouched pages of a sparse memory read as x.
+      if (mem[0] !== 8'bx || mem[4095] !== 8'bx) begin
+	 $display("FAILED -- unwritten word is %b/%b", mem[0], mem[4095]);
+	 errors = errors + 1;
+      end
+
+      mem[1500] = 8'h15;
+      if (mem[1500] !== 8'h15 || mem[1499] !== 8'bx || mem[1501] !== 8'bx) begin
+	 $display("FAILED -- mem[1499:1501] = %h %h %h",
+		  mem[1499], mem[1500], mem[1501]);
+	 errors = errors + 1;
+      end
+
+	// Load words scattered over several pages.
+      fd = $fopen("work/sparse_mem1.hex", "w");
+      $fdisplay(fd, "@0 a0 a1");
+      $fdisplay(fd, "@3ff 3f 40");
+      $fdisplay(fd, "@ffe fe ff");
+      $fclose(fd);
+      fd = $fopen("work/sparse_mem1_full.hex", "w");
+      $fdisplay(fd, "a0 a1");
+      $fclose(fd);
+      $readmemh("work/sparse_mem1.hex", mem);
+      $readmemh("work/sparse_mem1_full.hex", full, 0, 1);
+      if (mem[0] !== 8'ha0 || mem[1] !== 8'ha1 || mem[1023] !== 8'h3f
+	  || mem[1024] !== 8'h40 || mem[4094] !== 8'hfe || mem[4095] !== 8'hff
+	  || mem[2] !== 8'bx || mem[1500] !== 8'h15) begin
+	 $display("FAILED -- $readmemh into the sparse memory");
+	 errors = errors + 1;
+      end
+      if (full[0] !== 8'ha0 || full[1] !== 8'ha1 || full[2] !== 8'bx) begin
+	 $display("FAILED -- $readmemh into the full memory");
+	 errors = errors + 1;
+      end
+
+	// Write part of the memory out and read it back into the copy.
+      $writememh("work/sparse_mem1.out", mem, 1000, 1599);
+      $readmemh("work/sparse_mem1.out", copy, 1000, 1599);
+      for (idx = 0; idx < 4096; idx = idx + 1) begin
+	 if (idx >= 1000 && idx < 1600) begin
+	    if (copy[idx] !== mem[idx]) begin
+	       $display("FAILED -- copy[%0d] = %h, mem[%0d] = %h",
+			idx, copy[idx], idx, mem[idx]);
+	       errors = errors + 1;
+	    end
+	 end else if (copy[idx] !== 8'bx) begin
+	    $display("FAILED -- copy[%0d] = %h", idx, copy[idx]);
+	    errors = errors + 1;
+	 end
+      end
+
+      if (errors == 0)
+	$display("PASSED");
+   end
+endmodule
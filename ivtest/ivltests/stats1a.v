@@ -0,0 +1,18 @@
+// Run with --stats to write work/stats1.json, which the stats1b test
+// then checks. The design schedules events in the active, inactive,
+// nonblocking assign and read-only synch regions.
+module test;
+   reg [3:0] a, b;
+   integer i;
+
+   always @(a) b <= a;
+
+   initial begin
+      a = 0;
+      for (i = 0; i < 4; i = i + 1) begin
+	 #1 a = a + 1;
+	 #0 $strobe("a=%0d b=%0d", a, b);
+      end
+      #1 $display("PASSED");
+   end
+endmodule
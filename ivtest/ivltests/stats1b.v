@@ -0,0 +1,55 @@
+// Check the statistics that stats1a wrote. The times and rates change
+// from run to run, so only their keys are checked, and the event
+// counts of the regions add up to the events executed.
+module test;
+   string want[17];
+   integer found[17];
+   string line, text;
+   integer fd, idx, errors;
+
+   initial begin
+      want[0]  = "  \"version\": ";
+      want[1]  = "  \"design\": \"work/a.out\",";
+      want[2]  = "  \"compile_seconds\": ";
+      want[3]  = "  \"run_seconds\": ";
+      want[4]  = "  \"simulation_time\": 5,";
+      want[5]  = "    \"advanced\": 5,";
+      want[6]  = "    \"executed\": 26,";
+      want[7]  = "    \"peak_queue_depth\": 3,";
+      want[8]  = "    \"per_time_unit\": 5.2,";
+      want[9]  = "    \"per_time_step\": 5.2,";
+      want[10] = "    \"per_second\": ";
+      want[11] = "      \"start\": 0,";
+      want[12] = "      \"active\": 12,";
+      want[13] = "      \"inactive\": 4,";
+      want[14] = "      \"nbassign\": 5,";
+      want[15] = "      \"rwsync\": 0,";
+      want[16] = "      \"rosync\": 5";
+
+      fd = $fopen("work/stats1.json", "r");
+      if (fd == 0) begin
+	 $display("FAILED -- cannot open work/stats1.json");
+	 $finish;
+      end
+
+      for (idx = 0; idx < 17; idx = idx + 1)
+	found[idx] = 0;
+      while ($fgets(line, fd)) begin
+	 for (idx = 0; idx < 17; idx = idx + 1) begin
+	    text = want[idx];
+	    if (line.substr(0, text.len()-1) == text)
+	      found[idx] = 1;
+	 end
+      end
+      $fclose(fd);
+
+      errors = 0;
+      for (idx = 0; idx < 17; idx = idx + 1)
+	if (! found[idx]) begin
+	   $display("FAILED -- missing: %s", want[idx]);
+	   errors = errors + 1;
+	end
+      if (errors == 0)
+	$display("PASSED");
+   end
+endmodule
@@ -0,0 +1,140 @@
+// Check that a tran island gets the same values when only the parts of
+// it that a change reaches are resolved again. Values are passed both
+// ways along a chain, rtran reduces the strengths along a chain, and
+// tranif switches join and split the mesh as their control inputs are
+// toggled, including a switch controlled by a net of the island.
+
+module test;
+
+reg failed;
+reg [8*64:1] str;
+
+task check;
+  input [8*16:1] what;
+  input [8*64:1] exp;
+  begin
+    if (str !== exp) begin
+      $display("FAILED: %0s is %0s, expected %0s", what, str, exp);
+      failed = 1;
+    end
+  end
+endtask
+
+  // A chain of tran switches, driven from either end.
+reg d0, d7;
+wire w0, w1, w2, w3, w4, w5, w6, w7;
+
+assign w0 = d0;
+assign w7 = d7;
+
+tran c0(w0, w1);
+tran c1(w1, w2);
+tran c2(w2, w3);
+tran c3(w3, w4);
+tran c4(w4, w5);
+tran c5(w5, w6);
+tran c6(w6, w7);
+
+task check_chain;
+  input [8*64:1] exp;
+  begin
+    #1 $sformat(str, "%v %v %v %v %v %v %v %v", w0, w1, w2, w3, w4, w5, w6, w7);
+    check("chain", exp);
+  end
+endtask
+
+  // A chain of rtran switches, with a strong driver at one end and a
+  // weak driver at the other.
+reg r, rw;
+wire r0, r1, r2, r3;
+
+assign r0 = r;
+assign (weak1, weak0) r3 = rw;
+
+rtran q0(r0, r1);
+rtran q1(r1, r2);
+rtran q2(r2, r3);
+
+task check_rchain;
+  input [8*64:1] exp;
+  begin
+    #1 $sformat(str, "%v %v %v %v", r0, r1, r2, r3);
+    check("rtran chain", exp);
+  end
+endtask
+
+  // The tranif1 joins tb and tc to ta. The net tc controls the second
+  // tranif1, so resolving the island changes which parts it joins.
+  // The tranif0 has the opposite sense.
+reg da, en;
+wire ta, tb, tc, td, ha, hb;
+
+assign ta = da;
+pulldown (tc);
+assign (weak1, weak0) td = 1'b0;
+
+tranif1 g1(ta, tb, en);
+tran    g2(tb, tc);
+tranif1 g3(tb, td, tc);
+
+assign ha = da;
+pullup (hb);
+
+tranif0 h1(ha, hb, en);
+
+task check_tranif;
+  input [8*64:1] exp;
+  begin
+    #1 $sformat(str, "%v %v %v %v %v %v", ta, tb, tc, td, ha, hb);
+    check("tranif", exp);
+  end
+endtask
+
+initial begin
+  failed = 0;
+
+  d0 = 1'b1; d7 = 1'bz;
+  check_chain("St1 St1 St1 St1 St1 St1 St1 St1");
+  d0 = 1'bz; d7 = 1'b0;
+  check_chain("St0 St0 St0 St0 St0 St0 St0 St0");
+  d7 = 1'bz;
+  check_chain("HiZ HiZ HiZ HiZ HiZ HiZ HiZ HiZ");
+  d0 = 1'b0; d7 = 1'b1;
+  check_chain("StX StX StX StX StX StX StX StX");
+  d0 = 1'bz;
+  check_chain("St1 St1 St1 St1 St1 St1 St1 St1");
+
+  r = 1'b1; rw = 1'bz;
+  check_rchain("St1 Pu1 We1 Me1");
+  r = 1'b0;
+  check_rchain("St0 Pu0 We0 Me0");
+  rw = 1'b1;
+  check_rchain("St0 Pu0 We0 We1");
+  r = 1'bz;
+  check_rchain("Sm1 Sm1 Me1 We1");
+  r = 1'b1; rw = 1'bz;
+  check_rchain("St1 Pu1 We1 Me1");
+
+  da = 1'b1; en = 1'b0;
+  check_tranif("St1 Pu0 Pu0 We0 St1 St1");
+  en = 1'b1;
+  check_tranif("St1 St1 St1 St1 St1 Pu1");
+  da = 1'b0;
+  check_tranif("St0 St0 St0 We0 St0 Pu1");
+  en = 1'b0;
+  check_tranif("St0 Pu0 Pu0 We0 St0 St0");
+    // A change while the switch is off must be seen when it is
+    // turned on again.
+  da = 1'b1;
+  check_tranif("St1 Pu0 Pu0 We0 St1 St1");
+  en = 1'b1;
+  check_tranif("St1 St1 St1 St1 St1 Pu1");
+
+    // The chain is a separate island, and is not upset by the
+    // others.
+  check_chain("St1 St1 St1 St1 St1 St1 St1 St1");
+
+  if (!failed) $display("PASSED");
+end
+
+endmodule
@@ -0,0 +1,180 @@
+// Drive UDPs through every input transition, with 0, 1, x and z
+// values, and print the outputs. The primitives cover level rows
+// with ? and b, edge rows with explicit edges and the r, f, p, n and *
+// shorthands, the no-change (-) output, and a sequential primitive
+// that is wider than the lookup tables, so it uses the row scans.
+
+primitive comb_mux(out, s, a, b);
+   output out;
+   input s, a, b;
+   table
+   // s a b : out
+      0 0 ? : 0;
+      0 1 ? : 1;
+      1 ? 0 : 0;
+      1 ? 1 : 1;
+      x 0 0 : 0;
+      x 1 1 : 1;
+   endtable
+endprimitive
+
+primitive comb_maj(out, a, b, c, d);
+   output out;
+   input a, b, c, d;
+   table
+   // a b c d : out
+      1 1 ? b : 1;
+      1 ? 1 ? : 1;
+      ? 1 1 ? : 1;
+      0 0 ? ? : 0;
+      0 ? 0 ? : 0;
+      ? 0 0 ? : 0;
+      x x x 1 : 1;
+      x x x 0 : 0;
+   endtable
+endprimitive
+
+primitive seq_dff(q, clk, d, r);
+   output q;
+   reg q;
+   input clk, d, r;
+   initial q = 1'b0;
+   table
+   // clk   d   r   : q : q+
+      ?     ?   1   : ? : 0;
+      ?     ?   (10): ? : -;
+      ?     *   0   : ? : -;
+      r     0   0   : ? : 0;
+      r     1   0   : ? : 1;
+      (0x)  1   0   : 1 : 1;
+      (0x)  0   0   : 0 : 0;
+      (x1)  1   0   : 1 : 1;
+      (x1)  0   0   : 0 : 0;
+      n     ?   0   : ? : -;
+      (?x)  ?   0   : ? : x;
+      ?     ?   (x0): 0 : 0;
+   endtable
+endprimitive
+
+primitive seq_latch(q, en, d);
+   output q;
+   reg q;
+   input en, d;
+   table
+   // en d : q : q+
+      1  0 : ? : 0;
+      1  1 : ? : 1;
+      0  ? : ? : -;
+      p  1 : 1 : 1;
+      f  ? : ? : -;
+      x  0 : 0 : 0;
+      x  1 : 1 : 1;
+   endtable
+endprimitive
+
+primitive seq_wide(q, clk, d0, d1, d2, d3, d4, d5, d6, d7);
+   output q;
+   reg q;
+   input clk, d0, d1, d2, d3, d4, d5, d6, d7;
+   table
+   // clk d0 d1 d2 d3 d4 d5 d6 d7 : q : q+
+      (01) 1  1  ?  ?  ?  ?  ?  1 : ? : 1;
+      (01) 0  ?  ?  ?  ?  ?  ?  ? : ? : 0;
+      (01) ?  0  ?  ?  ?  ?  ?  ? : ? : 0;
+      (01) ?  ?  ?  ?  ?  ?  ?  0 : ? : 0;
+      (1?) ?  ?  ?  ?  ?  ?  ?  ? : ? : -;
+      (?0) ?  ?  ?  ?  ?  ?  ?  ? : ? : -;
+      ?    *  ?  ?  ?  ?  ?  ?  ? : ? : -;
+      ?    ?  *  ?  ?  ?  ?  ?  ? : ? : -;
+      ?    ?  ?  ?  ?  ?  ?  ?  * : ? : -;
+   endtable
+endprimitive
+
+module test;
+   reg [2:0] mux_in;
+   reg [3:0] maj_in;
+   reg [2:0] dff_in;
+   reg [1:0] latch_in;
+   reg [8:0] wide_in;
+   wire mux_out, maj_out, dff_out, latch_out, wide_out;
+
+   comb_mux mux(mux_out, mux_in[2], mux_in[1], mux_in[0]);
+   comb_maj maj(maj_out, maj_in[3], maj_in[2], maj_in[1], maj_in[0]);
+   seq_dff dff(dff_out, dff_in[2], dff_in[1], dff_in[0]);
+   seq_latch latch(latch_out, latch_in[1], latch_in[0]);
+   seq_wide wide(wide_out, wide_in[8], wide_in[7], wide_in[6], wide_in[5],
+		 wide_in[4], wide_in[3], wide_in[2], wide_in[1], wide_in[0]);
+
+   integer start, port, to, q;
+
+   function [0:0] val4;
+      input integer code;
+      case (code)
+	0: val4 = 1'b0;
+	1: val4 = 1'b1;
+	2: val4 = 1'bx;
+	default: val4 = 1'bz;
+      endcase
+   endfunction
+
+   initial begin
+	// Combinational primitives: every input vector.
+      for (start = 0; start < 64; start = start + 1) begin
+	 mux_in = {val4(start/16), val4((start/4)%4), val4(start%4)};
+	 #1 $display("mux %b -> %b", mux_in, mux_out);
+      end
+      for (start = 0; start < 256; start = start + 1) begin
+	 maj_in = {val4(start/64), val4((start/16)%4), val4((start/4)%4),
+		   val4(start%4)};
+	 #1 $write("%b", maj_out);
+	 if (start % 64 == 63) $write("\n");
+      end
+
+	// Sequential primitives: load 0 or 1, go to every input vector,
+	// and from there change each input to every value. The output
+	// is printed after each of the last two steps.
+      for (start = 0; start < 64; start = start + 1) begin
+	 $write("dff %b:", {val4(start/16), val4((start/4)%4), val4(start%4)});
+	 for (port = 0; port < 3; port = port + 1)
+	   for (to = 0; to < 4; to = to + 1)
+	     for (q = 0; q < 2; q = q + 1) begin
+		dff_in = {1'b0, val4(q), 1'b0};
+		#1 dff_in[2] = 1'b1;
+		#1 dff_in = {val4(start/16), val4((start/4)%4), val4(start%4)};
+		#1 $write(" %b", dff_out);
+		dff_in[port] = val4(to);
+		#1 $write("%b", dff_out);
+	     end
+	 $write("\n");
+      end
+      for (start = 0; start < 16; start = start + 1) begin
+	 $write("latch %b:", {val4(start/4), val4(start%4)});
+	 for (port = 0; port < 2; port = port + 1)
+	   for (to = 0; to < 4; to = to + 1)
+	     for (q = 0; q < 2; q = q + 1) begin
+		latch_in = {1'b1, val4(q)};
+		#1 latch_in = {val4(start/4), val4(start%4)};
+		#1 $write(" %b", latch_out);
+		latch_in[port] = val4(to);
+		#1 $write("%b", latch_out);
+	     end
+	 $write("\n");
+      end
+
+	// The wide primitive: clock edges with a few data patterns.
+      wide_in = 9'b0_1111_1111;
+      for (start = 0; start < 36; start = start + 1) begin
+	 to = start % 4;
+	 port = start / 4;
+	 wide_in[port] = val4(to);
+	 #1 wide_in[8] = 1'b1;
+	 #1 $write(" %b", wide_out);
+	 wide_in[8] = val4(to);
+	 #1 $write("%b", wide_out);
+	 wide_in[8] = 1'b0;
+	 #1 wide_in[port] = 1'b1;
+      end
+      $write("\n");
+      $finish(0);
+   end
+endmodule
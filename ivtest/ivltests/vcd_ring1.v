@@ -0,0 +1,35 @@
+// Check the flight recorder mode of the VCD dumper (+vcd+ring=5). Each
+// $dumpflush writes the changes since the flush before it. The first
+// starts with the values at the start of the window. By the last flush
+// some changes have left the window, so the lost time is shown as a
+// $dumpoff section. The dump is read back from the end of the header,
+// as the header has the date in it.
+
+module test;
+
+reg [7:0] c;
+reg [8*80:1] line;
+integer fd, shown;
+
+initial begin
+  $dumpfile("work/vcd_ring1.vcd");
+  $dumpvars(0, c);
+  c = 0;
+  repeat (10) #1 c = c + 1;
+  $dumpflush;
+  repeat (2) #1 c = c + 1;
+  $dumpflush;
+  repeat (13) #1 c = c + 1;
+  $dumpflush;
+  #1;
+
+  fd = $fopen("work/vcd_ring1.vcd", "r");
+  shown = 0;
+  while ($fgets(line, fd)) begin
+    if (line == "$enddefinitions $end\n") shown = 1;
+    if (shown) $write("%0s", line);
+  end
+  $fclose(fd);
+end
+
+endmodule
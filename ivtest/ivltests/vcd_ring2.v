@@ -0,0 +1,28 @@
+// Check that +vcd+ring_max= limits the flight recorder ring. The window
+// is long enough to keep every change, but the ring only has room for
+// about four time steps, so the flush starts at time 15 instead of 0.
+
+module test;
+
+reg [7:0] c;
+reg [8*80:1] line;
+integer fd, shown;
+
+initial begin
+  $dumpfile("work/vcd_ring2.vcd");
+  $dumpvars(0, c);
+  c = 0;
+  repeat (20) #1 c = c + 1;
+  $dumpflush;
+  #1;
+
+  fd = $fopen("work/vcd_ring2.vcd", "r");
+  shown = 0;
+  while ($fgets(line, fd)) begin
+    if (line == "$enddefinitions $end\n") shown = 1;
+    if (shown) $write("%0s", line);
+  end
+  $fclose(fd);
+end
+
+endmodule
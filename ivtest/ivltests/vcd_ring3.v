@@ -0,0 +1,35 @@
+// Check that an $error writes out the flight recorder ring of the VCD
+// dumper (+vcd+ring=5), with the events in the window. The change of c
+// after the $error is in the same time step, so it must be in the dump
+// too. The dump is read back
+// from the end of the header, as the header has the date in it.
+
+module test;
+
+reg [7:0] c;
+event e;
+reg [8*80:1] line;
+integer fd, shown;
+
+initial begin
+  $dumpfile("work/vcd_ring3.vcd");
+  $dumpvars(0, c, e);
+  c = 0;
+  repeat (10) begin
+    #1 c = c + 1;
+    if (c[0]) -> e;
+  end
+  #1 $error("c is %0d", c);
+  c = 8'hff;
+  #1;
+
+  fd = $fopen("work/vcd_ring3.vcd", "r");
+  shown = 0;
+  while ($fgets(line, fd)) begin
+    if (line == "$enddefinitions $end\n") shown = 1;
+    if (shown) $write("%0s", line);
+  end
+  $fclose(fd);
+end
+
+endmodule
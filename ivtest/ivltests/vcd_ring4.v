@@ -0,0 +1,18 @@
+// Check that a $fatal writes out the flight recorder ring of the VCD
+// dumper (+vcd+ring=5). The simulation ends in the time step of the
+// $fatal, so the ring is written when the dump is closed. vcd_ring6
+// reads the dump back.
+
+module test;
+
+reg [7:0] c;
+
+initial begin
+  $dumpfile("work/vcd_ring4.vcd");
+  $dumpvars(0, c);
+  c = 0;
+  repeat (10) #1 c = c + 1;
+  #1 $fatal(1, "c is %0d", c);
+end
+
+endmodule
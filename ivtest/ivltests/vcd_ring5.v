@@ -0,0 +1,17 @@
+// Check that a $finish_and_return with a failure code writes out the
+// flight recorder ring of the VCD dumper (+vcd+ring=5). vcd_ring6
+// reads the dump back.
+
+module test;
+
+reg [7:0] c;
+
+initial begin
+  $dumpfile("work/vcd_ring5.vcd");
+  $dumpvars(0, c);
+  c = 0;
+  repeat (10) #1 c = c + 1;
+  #1 $finish_and_return(2);
+end
+
+endmodule
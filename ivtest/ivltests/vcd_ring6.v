@@ -0,0 +1,27 @@
+// Show the dumps that vcd_ring4 and vcd_ring5 wrote, from the end of
+// the header, as the header has the date in it.
+
+module test;
+
+reg [8*80:1] line;
+integer fd, shown;
+
+task show(input [8*40:1] fname);
+  begin
+    $display("--- %0s", fname);
+    fd = $fopen(fname, "r");
+    shown = 0;
+    while ($fgets(line, fd)) begin
+      if (line == "$enddefinitions $end\n") shown = 1;
+      if (shown) $write("%0s", line);
+    end
+    $fclose(fd);
+  end
+endtask
+
+initial begin
+  show("work/vcd_ring4.vcd");
+  show("work/vcd_ring5.vcd");
+end
+
+endmodule
@@ -0,0 +1,53 @@
+// Write a VCD dump that uses $dumpoff, $dumpon, $dumpflush, $dumpall
+// and $dumplimit. vcd_thread1a writes it with +vcd+threads=0 and
+// vcd_thread1b with the writer thread, and vcd_thread1c checks that
+// the two files are the same.
+module dut;
+   reg clk;
+   reg [3:0] nib;
+   reg [63:0] wide;
+   reg [99:0] huge;
+   real r;
+   event ev;
+   wire [3:0] inv = ~nib;
+
+   always #1 clk = !clk;
+
+   always @(posedge clk) begin
+      nib = nib + 1;
+      wide = {wide[62:0], wide[63] ^ nib[0]};
+      huge = {huge[98:0], nib[1]};
+      r = r + 0.25;
+      if (nib[2]) -> ev;
+   end
+
+   initial begin
+      clk = 0;
+      nib = 4'bx;
+      wide = 64'h0123_4567_89ab_cdef;
+      huge = {100{1'bz}};
+      r = 0.0;
+      #4 nib = 0;
+      huge = {25{4'b10xz}};
+   end
+endmodule
+
+module test;
+   reg [8*40:1] fname;
+
+   dut dut();
+
+   initial begin
+      if (! $value$plusargs("dumpfile=%s", fname))
+	fname = "work/vcd_thread1.vcd";
+      $dumpfile(fname);
+      $dumpvars(0, dut);
+      #14 $dumpoff;
+      #10 $dumpon;
+      #10 $dumpflush;
+      #5 $dumpall;
+      #5 $dumplimit(4000);
+      #100 $display("PASSED");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,33 @@
+// Check that vcd_thread1a (no writer thread) and vcd_thread1b (with
+// the writer thread) wrote the same VCD file.
+module test;
+   reg [8*200:1] line0, line1;
+   integer fd0, fd1, cnt0, cnt1, lines;
+
+   initial begin
+      fd0 = $fopen("work/vcd_thread1a.vcd", "r");
+      fd1 = $fopen("work/vcd_thread1b.vcd", "r");
+      if (fd0 == 0 || fd1 == 0) begin
+	 $display("FAILED -- cannot open the dump files");
+	 $finish;
+      end
+
+      lines = 0;
+      cnt0 = $fgets(line0, fd0);
+      cnt1 = $fgets(line1, fd1);
+      while (cnt0 != 0 && cnt1 != 0 && line0 == line1) begin
+	 lines = lines + 1;
+	 cnt0 = $fgets(line0, fd0);
+	 cnt1 = $fgets(line1, fd1);
+      end
+      $fclose(fd0);
+      $fclose(fd1);
+
+      if (cnt0 != 0 || cnt1 != 0)
+	$display("FAILED -- the dump files differ after line %0d", lines);
+      else if (lines < 100)
+	$display("FAILED -- only %0d lines were dumped", lines);
+      else
+	$display("PASSED");
+   end
+endmodule
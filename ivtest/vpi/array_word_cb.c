@@ -0,0 +1,110 @@
+/*
+ * Value change callbacks on array words that remove themselves from
+ * inside the callback, and then write the word they watch, so that
+ * the array runs the callbacks of the word again before the first
+ * pass over them is done.
+ */
+
+#include <vpi_user.h>
+#include <string.h>
+#include <assert.h>
+
+static vpiHandle once_cb[2];
+
+static void print_word(const char*name, vpiHandle word)
+{
+    s_vpi_time  time;
+    s_vpi_value value;
+
+    time.type = vpiSimTime;
+    vpi_get_time(NULL, &time);
+    value.format = vpiIntVal;
+    vpi_get_value(word, &value);
+    vpi_printf("At time %d %s: %s = %d\n", time.low, name,
+               vpi_get_str(vpiFullName, word), value.value.integer);
+}
+
+static PLI_INT32 watch_cb(p_cb_data cb_data)
+{
+    print_word("watch", cb_data->obj);
+    return 0;
+}
+
+static PLI_INT32 once_cb_rtn(p_cb_data cb_data)
+{
+    s_vpi_value value;
+    int idx = (int)(long)cb_data->user_data;
+
+    print_word("once", cb_data->obj);
+    vpi_remove_cb(once_cb[idx]);
+    once_cb[idx] = 0;
+
+    value.format = vpiIntVal;
+    value.value.integer = 100 + idx;
+    vpi_put_value(cb_data->obj, &value, NULL, vpiNoDelay);
+    return 0;
+}
+
+static void register_cb(vpiHandle word, PLI_INT32 (*rtn)(p_cb_data),
+                        vpiHandle*handle, long idx)
+{
+    s_cb_data   cb_data;
+    s_vpi_time  time;
+    s_vpi_value value;
+
+    memset(&cb_data, 0, sizeof(cb_data));
+    time.type = vpiSuppressTime;
+    value.format = vpiSuppressVal;
+    cb_data.reason    = cbValueChange;
+    cb_data.cb_rtn    = rtn;
+    cb_data.obj       = word;
+    cb_data.time      = &time;
+    cb_data.value     = &value;
+    cb_data.user_data = (char*)idx;
+    if (handle)
+        *handle = vpi_register_cb(&cb_data);
+    else
+        vpi_free_object(vpi_register_cb(&cb_data));
+}
+
+/*
+ * $watch_words(mem[1], mem[2]) puts a callback that removes itself
+ * on each word, and a callback that prints every change on the first
+ * word. The printing callback is newer, so it runs first.
+ */
+static PLI_INT32 watch_calltf(char*xx)
+{
+    vpiHandle sys  = vpi_handle(vpiSysTfCall, 0);
+    vpiHandle argv = vpi_iterate(vpiArgument, sys);
+    vpiHandle word1, word2;
+
+    (void)xx;  /* Parameter is not used. */
+
+    assert(argv);
+    word1 = vpi_scan(argv);
+    word2 = vpi_scan(argv);
+    assert(word1 && word2);
+    vpi_free_object(argv);
+
+    register_cb(word1, once_cb_rtn, &once_cb[0], 0);
+    register_cb(word2, once_cb_rtn, &once_cb[1], 1);
+    register_cb(word1, watch_cb, 0, 0);
+    return 0;
+}
+
+static void watch_register(void)
+{
+    s_vpi_systf_data tf_data;
+
+    tf_data.type      = vpiSysTask;
+    tf_data.tfname    = "$watch_words";
+    tf_data.calltf    = watch_calltf;
+    tf_data.compiletf = 0;
+    tf_data.sizetf    = 0;
+    vpi_register_systf(&tf_data);
+}
+
+void (*vlog_startup_routines[])(void) = {
+    watch_register,
+    0
+};
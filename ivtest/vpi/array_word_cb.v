@@ -0,0 +1,16 @@
+module test;
+
+reg [7:0] mem [0:3];
+
+initial begin
+    $watch_words(mem[1], mem[2]);
+    #1 mem[1] = 1;
+    #1 mem[1] = 2;
+    #1 mem[2] = 3;
+    #1 mem[2] = 4;
+    #1 mem[1] = 5;
+    #1 $display("mem[1] = %0d, mem[2] = %0d", mem[1], mem[2]);
+    $finish(0);
+end
+
+endmodule
@@ -0,0 +1,104 @@
+/*
+ * Check hierarchical names given to vpi_handle_by_name(). Each item
+ * that is found holds a different value, so the value tells whether
+ * the right item was found. A value of -1 means the name must not be
+ * found.
+ */
+#include "vpi_user.h"
+
+struct lookup {
+    const char *name;
+    int relative;    /* Look up relative to top.u1 */
+    int value;
+};
+
+static struct lookup lookups[] = {
+    { "top.r",              0,  1 },
+    { "\\top .r",           0,  1 },
+    { "top.mem[2]",         0,  2 },
+    { "top.mem[4]",         0, -1 },
+    { "top.mem[02]",        0, -1 },
+    { "top.\\esc.name ",    0,  3 },
+    { "top.\\a[1] ",        0,  4 },
+    { "top.blk[0].q",       0, 30 },
+    { "top.blk[1].q",       0, 31 },
+    { "top.blk[2].q",       0, -1 },
+    { "top.\\gen.esc .s",   0, 40 },
+    { "top.\\inst.esc .v",  0, 50 },
+    { "top.u1.v",           0, 60 },
+      /* Paths through items that are not scopes. */
+    { "top.r.x",            0, -1 },
+    { "top.mem[2].x",       0, -1 },
+    { "top.nosuch.v",       0, -1 },
+      /* A path that is not in the scope is looked for in the
+         scopes above it, but a plain name is not. */
+    { "v",                  1, 60 },
+    { "blk[1].q",           1, 31 },
+    { "u1.v",               1, 60 },
+    { "r",                  1, -1 },
+    { 0,                    0,  0 }
+};
+
+static PLI_INT32 test_calltf(PLI_BYTE8 *xx)
+{
+    vpiHandle u1, item;
+    s_vpi_value value;
+    int idx, failed = 0;
+
+    (void)xx;  /* Parameter is not used. */
+
+    u1 = vpi_handle_by_name("top.u1", 0);
+    if (u1 == 0) {
+        vpi_printf("FAILED: top.u1 was not found\n");
+        return 0;
+    }
+
+    for (idx = 0; lookups[idx].name; idx += 1) {
+        item = vpi_handle_by_name(lookups[idx].name,
+                                  lookups[idx].relative ? u1 : 0);
+        if (item == 0) {
+            if (lookups[idx].value != -1) {
+                vpi_printf("FAILED: %s was not found\n", lookups[idx].name);
+                failed = 1;
+            }
+            continue;
+        }
+
+        if (lookups[idx].value == -1) {
+            vpi_printf("FAILED: %s was found as %s\n", lookups[idx].name,
+                       vpi_get_str(vpiFullName, item));
+            failed = 1;
+            continue;
+        }
+
+        value.format = vpiIntVal;
+        vpi_get_value(item, &value);
+        if (value.value.integer != lookups[idx].value) {
+            vpi_printf("FAILED: %s has the value %d, expected %d\n",
+                       lookups[idx].name, (int)value.value.integer,
+                       lookups[idx].value);
+            failed = 1;
+        }
+    }
+
+    if (!failed) vpi_printf("PASSED\n");
+
+    return 0;
+}
+
+static void test_register(void)
+{
+    s_vpi_systf_data tf_data;
+
+    tf_data.type      = vpiSysTask;
+    tf_data.tfname    = "$test";
+    tf_data.calltf    = test_calltf;
+    tf_data.compiletf = 0;
+    tf_data.sizetf    = 0;
+    vpi_register_systf(&tf_data);
+}
+
+void (*vlog_startup_routines[])(void) = {
+    test_register,
+    0
+};
@@ -0,0 +1,38 @@
+// Check hierarchical names given to vpi_handle_by_name, including
+// escaped names, generate scopes, memory words and paths that run
+// through items that are not scopes.
+
+module sub #(parameter P = 0);
+  reg [7:0] v;
+  initial v = P;
+endmodule
+
+module top;
+  reg [7:0] r;
+  reg [7:0] mem [0:3];
+  reg [7:0] \esc.name ;
+  reg [7:0] \a[1] ;
+
+  genvar gi;
+  generate
+    for (gi = 0 ; gi < 2 ; gi = gi + 1) begin : blk
+      reg [7:0] q;
+      initial q = 30 + gi;
+    end
+    if (1) begin : \gen.esc
+      reg [7:0] s;
+      initial s = 40;
+    end
+  endgenerate
+
+  sub #(50) \inst.esc ();
+  sub #(60) u1();
+
+  initial begin
+    r = 1;
+    mem[2] = 2;
+    \esc.name = 3;
+    \a[1] = 4;
+    #1 $test;
+  end
+endmodule
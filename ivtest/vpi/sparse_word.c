@@ -0,0 +1,74 @@
+/*
+ * Get and put words of a memory that is large enough to be stored
+ * sparsely. The words that were never written read as x.
+ */
+
+#include <vpi_user.h>
+#include <assert.h>
+
+static void show_word(vpiHandle mem, PLI_INT32 index)
+{
+    vpiHandle   word = vpi_handle_by_index(mem, index);
+    s_vpi_value value;
+
+    assert(word);
+    value.format = vpiBinStrVal;
+    vpi_get_value(word, &value);
+    vpi_printf("%s = %s\n", vpi_get_str(vpiFullName, word),
+               value.value.str);
+}
+
+static void put_word(vpiHandle mem, PLI_INT32 index, PLI_INT32 val)
+{
+    vpiHandle   word = vpi_handle_by_index(mem, index);
+    s_vpi_value value;
+
+    assert(word);
+    value.format = vpiIntVal;
+    value.value.integer = val;
+    vpi_put_value(word, &value, NULL, vpiNoDelay);
+}
+
+static PLI_INT32 poke_calltf(char*xx)
+{
+    vpiHandle sys  = vpi_handle(vpiSysTfCall, 0);
+    vpiHandle argv = vpi_iterate(vpiArgument, sys);
+    vpiHandle mem;
+
+    (void)xx;  /* Parameter is not used. */
+
+    assert(argv);
+    mem = vpi_scan(argv);
+    assert(mem && vpi_get(vpiType, mem) == vpiMemory);
+    vpi_free_object(argv);
+
+    vpi_printf("%s has %d words\n", vpi_get_str(vpiFullName, mem),
+               vpi_get(vpiSize, mem));
+
+    show_word(mem, 700000);
+    put_word(mem, 700000, 0x5a);
+    show_word(mem, 700000);
+    show_word(mem, 700001);
+    put_word(mem, 1048575, 0xa5);
+    show_word(mem, 1048575);
+    show_word(mem, 1048574);
+    show_word(mem, 1000);
+    return 0;
+}
+
+static void poke_register(void)
+{
+    s_vpi_systf_data tf_data;
+
+    tf_data.type      = vpiSysTask;
+    tf_data.tfname    = "$poke_words";
+    tf_data.calltf    = poke_calltf;
+    tf_data.compiletf = 0;
+    tf_data.sizetf    = 0;
+    vpi_register_systf(&tf_data);
+}
+
+void (*vlog_startup_routines[])(void) = {
+    poke_register,
+    0
+};
@@ -0,0 +1,16 @@
+module test;
+
+// This is large enough to be stored sparsely by default.
+reg [7:0] mem [0:1048575];
+
+initial begin
+    mem[1000] = 8'h10;
+    $poke_words(mem);
+    if (mem[700000] !== 8'h5a || mem[1048575] !== 8'ha5
+        || mem[700001] !== 8'bx || mem[1000] !== 8'h10)
+        $display("FAILED");
+    else
+        $display("PASSED");
+end
+
+endmodule
@@ -0,0 +1,154 @@
+/*
+ * Check vpi_get_value_array and vpi_put_value_array. The first task
+ * gets the values of its memory arguments in several formats, and the
+ * second task puts new values into them.
+ */
+#include "sv_vpi_user.h"
+
+static void get_args(vpiHandle*mem, vpiHandle*wide, vpiHandle*rmem)
+{
+    vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+    vpiHandle argv = vpi_iterate(vpiArgument, callh);
+
+    *mem = vpi_scan(argv);
+    *wide = vpi_scan(argv);
+    *rmem = vpi_scan(argv);
+    vpi_free_object(argv);
+}
+
+static PLI_INT32 get_values_calltf(PLI_BYTE8 *xx)
+{
+    vpiHandle mem, wide, rmem;
+    s_vpi_arrayvalue arr;
+    PLI_INT32 index;
+    PLI_BYTE8 raw[2];
+    int idx;
+
+    (void)xx;  /* Parameter is not used. */
+
+    get_args(&mem, &wide, &rmem);
+
+      /* The X and Z bits read as 0 in the integer formats. */
+    arr.format = vpiIntVal;
+    arr.flags = 0;
+    index = 0;
+    vpi_get_value_array(mem, &arr, &index, 8);
+    vpi_printf("mem int:");
+    for (idx = 0; idx < 8; idx += 1)
+        vpi_printf(" %d", (int)arr.value.integers[idx]);
+    vpi_printf("\n");
+
+    arr.format = vpiVectorVal;
+    arr.flags = 0;
+    index = 4;
+    vpi_get_value_array(mem, &arr, &index, 2);
+    vpi_printf("mem[4:5] vector:");
+    for (idx = 0; idx < 2; idx += 1)
+        vpi_printf(" %02x/%02x", (unsigned)arr.value.vectors[idx].aval,
+                   (unsigned)arr.value.vectors[idx].bval);
+    vpi_printf("\n");
+
+      /* Read into storage that the caller supplies. */
+    arr.format = vpiRawFourStateVal;
+    arr.flags = vpiUserAllocFlag;
+    arr.value.rawvals = raw;
+    index = 5;
+    vpi_get_value_array(mem, &arr, &index, 1);
+    vpi_printf("mem[5] raw: %02x/%02x\n", raw[0] & 0xff, raw[1] & 0xff);
+
+      /* Two vector words for each 40 bit element. */
+    arr.format = vpiVectorVal;
+    arr.flags = 0;
+    index = 0;
+    vpi_get_value_array(wide, &arr, &index, 4);
+    vpi_printf("wide vector:");
+    for (idx = 0; idx < 4; idx += 1)
+        vpi_printf(" %02x_%08x", (unsigned)arr.value.vectors[2*idx+1].aval,
+                   (unsigned)arr.value.vectors[2*idx].aval);
+    vpi_printf("\n");
+
+    arr.format = vpiLongIntVal;
+    arr.flags = 0;
+    index = 2;
+    vpi_get_value_array(wide, &arr, &index, 2);
+    vpi_printf("wide[2:3] long: %lld %lld\n",
+               (long long)arr.value.longints[0],
+               (long long)arr.value.longints[1]);
+
+    arr.format = vpiRealVal;
+    arr.flags = 0;
+    index = 1;
+    vpi_get_value_array(rmem, &arr, &index, 2);
+    vpi_printf("rmem[1:2] real: %f %f\n", arr.value.reals[0],
+               arr.value.reals[1]);
+
+    return 0;
+}
+
+static PLI_INT32 put_values_calltf(PLI_BYTE8 *xx)
+{
+    vpiHandle mem, wide, rmem;
+    s_vpi_arrayvalue arr;
+    PLI_INT32 index;
+    PLI_INT32 ints[3] = { 100, 101, -1 };
+    PLI_BYTE8 raw[4] = { (PLI_BYTE8)0xf0, 0x0f, 0x55, 0x00 };
+    s_vpi_vecval vecs[4];
+    double reals[4] = { -1.25, 0.0, 2.75, 1000.0 };
+
+    (void)xx;  /* Parameter is not used. */
+
+    get_args(&mem, &wide, &rmem);
+
+    arr.format = vpiIntVal;
+    arr.flags = 0;
+    arr.value.integers = ints;
+    index = 1;
+    vpi_put_value_array(mem, &arr, &index, 3);
+
+    arr.format = vpiRawFourStateVal;
+    arr.value.rawvals = raw;
+    index = 6;
+    vpi_put_value_array(mem, &arr, &index, 2);
+
+    vecs[0].aval = 0x3456789a;
+    vecs[0].bval = 0;
+    vecs[1].aval = 0x12;
+    vecs[1].bval = 0;
+    vecs[2].aval = 0xffffffff;
+    vecs[2].bval = 0xffffffff;
+    vecs[3].aval = 0;
+    vecs[3].bval = 0;
+    arr.format = vpiVectorVal;
+    arr.value.vectors = vecs;
+    index = 1;
+    vpi_put_value_array(wide, &arr, &index, 2);
+
+    arr.format = vpiRealVal;
+    arr.value.reals = reals;
+    index = 0;
+    vpi_put_value_array(rmem, &arr, &index, 4);
+
+    return 0;
+}
+
+static void value_array_register(void)
+{
+    s_vpi_systf_data tf_data;
+
+    tf_data.type      = vpiSysTask;
+    tf_data.tfname    = "$get_values";
+    tf_data.calltf    = get_values_calltf;
+    tf_data.compiletf = 0;
+    tf_data.sizetf    = 0;
+    tf_data.user_data = 0;
+    vpi_register_systf(&tf_data);
+
+    tf_data.tfname    = "$put_values";
+    tf_data.calltf    = put_values_calltf;
+    vpi_register_systf(&tf_data);
+}
+
+void (*vlog_startup_routines[])(void) = {
+    value_array_register,
+    0
+};
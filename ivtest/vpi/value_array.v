@@ -0,0 +1,25 @@
+// Check vpi_get_value_array and vpi_put_value_array on vector and
+// real memories, including a memory with a descending range and
+// words that are wider than 32 bits.
+
+module test;
+  reg [7:0] mem [0:7];
+  reg [39:0] wide [3:0];
+  real rmem [0:3];
+  wire [7:0] w2 = mem[2];
+  integer i;
+
+  initial begin
+    for (i = 0 ; i < 8 ; i = i + 1) mem[i] = i * 3;
+    mem[5] = 8'b1x0z0110;
+    for (i = 0 ; i < 4 ; i = i + 1) wide[i] = {i[7:0] + 8'h01, 32'hdead0000 + i};
+    for (i = 0 ; i < 4 ; i = i + 1) rmem[i] = i + 0.5;
+    #1 $get_values(mem, wide, rmem);
+    $put_values(mem, wide, rmem);
+    #1;
+    for (i = 0 ; i < 8 ; i = i + 1) $display("mem[%0d] = %b", i, mem[i]);
+    for (i = 0 ; i < 4 ; i = i + 1) $display("wide[%0d] = %h", i, wide[i]);
+    for (i = 0 ; i < 4 ; i = i + 1) $display("rmem[%0d] = %f", i, rmem[i]);
+    $display("w2 = %0d", w2);
+  end
+endmodule
@@ -87,6 +87,59 @@ EXTERN_C_START
 #define vpiStringFunc       10
 #define vpiSysFuncString    vpiSysFuncString
 
+/********* Value formats ***********/
+#define vpiShortIntVal      14
+#define vpiLongIntVal       15
+#define vpiShortRealVal     16
+#define vpiRawTwoStateVal   17
+#define vpiRawFourStateVal  18
+
+/********* Array value flags ***********/
+#define vpiUserAllocFlag    0x2000
+#define vpiOneValue         0x4000
+#define vpiPropagateOff     0x8000
+
+/*
+ * This structure holds the values of a range of array elements that
+ * are passed to or from vpi_get_value_array and vpi_put_value_array.
+ * The format selects the member of the union that points to the
+ * element values.
+ */
+typedef struct t_vpi_arrayvalue {
+      PLI_UINT32 format;
+      PLI_UINT32 flags;
+      union {
+	    PLI_INT32 *integers;
+	    PLI_INT16 *shortints;
+	    PLI_INT64 *longints;
+	    PLI_BYTE8 *rawvals;
+	    struct t_vpi_vecval *vectors;
+	    struct t_vpi_time *times;
+	    double *reals;
+	    float *shortreals;
+      } value;
+} s_vpi_arrayvalue, *p_vpi_arrayvalue;
+
+/*
+ * These functions get or put the values of num consecutive elements
+ * of an array, starting at the element selected by the index
+ * array. The elements are taken in increasing index order. The
+ * formats vpiIntVal, vpiShortIntVal, vpiLongIntVal, vpiVectorVal,
+ * vpiRawTwoStateVal and vpiRawFourStateVal are supported for vector
+ * arrays, and vpiRealVal for real arrays.
+ *
+ * If the vpiUserAllocFlag is set, then vpi_get_value_array writes
+ * into the storage that the caller points to, otherwise the storage
+ * is supplied by the simulator and remains valid until the next
+ * call. If the vpiPropagateOff flag is given to vpi_put_value_array,
+ * then the new values are stored but are not propagated to the
+ * readers of the array.
+ */
+extern void vpi_get_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
+				PLI_INT32*index_p, PLI_UINT32 num);
+extern void vpi_put_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
+				PLI_INT32*index_p, PLI_UINT32 num);
+
 EXTERN_C_END
 
 #endif /* SV_VPI_USER_H */
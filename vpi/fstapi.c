@@ -1132,7 +1132,7 @@ fstWriterContext *fstWriterCreate(const char *nam, int use_compressed_hier)
 #ifdef FST_WRITER_PARALLEL
             pthread_mutex_init(&xc->mutex, NULL);
             pthread_attr_init(&xc->thread_attr);
-            pthread_attr_setdetachstate(&xc->thread_attr, PTHREAD_CREATE_DETACHED);
+            pthread_attr_setdetachstate(&xc->thread_attr, PTHREAD_CREATE_JOINABLE);
 #endif
         } else {
             fclose(xc->handle);
@@ -1749,12 +1749,25 @@ static void *fstWriterFlushContextPrivate1(void *ctx)
     xc_parent = xc->xc_parent;
     free(xc);
 
-    xc_parent->in_pthread = 0;
     pthread_mutex_unlock(&(xc_parent->mutex));
 
     return (NULL);
 }
 
+/*
+ * wait for the flush thread of this context (if any) to finish. in_pthread
+ * is only used by the thread that creates the flush threads. the threads
+ * are joined rather than detached, so none can still be running code of
+ * this library when the file is closed. (local change, see fstapi-local.txt)
+ */
+static void fstWriterWaitFlushThread(struct fstWriterContext *xc)
+{
+    if (xc->in_pthread) {
+        pthread_join(xc->thread, NULL);
+        xc->in_pthread = 0;
+    }
+}
+
 static void fstWriterFlushContextPrivate(fstWriterContext *xc)
 {
     if (xc->parallel_enabled) {
@@ -1762,8 +1775,9 @@ static void fstWriterFlushContextPrivate(fstWriterContext *xc)
             (struct fstWriterContext *)malloc(sizeof(struct fstWriterContext));
         unsigned int i;
 
-        pthread_mutex_lock(&xc->mutex);
-        pthread_mutex_unlock(&xc->mutex);
+        /* the previous flush thread must be finished before the copy,
+         * as it updates the section start of this context */
+        fstWriterWaitFlushThread(xc);
 
         xc->xc_parent = xc;
         memcpy(xc2, xc, sizeof(struct fstWriterContext));
@@ -1804,21 +1818,12 @@ static void fstWriterFlushContextPrivate(fstWriterContext *xc)
         xc->section_header_only = 0;
         xc->secnum++;
 
-        while (xc->in_pthread) {
-            pthread_mutex_lock(&xc->mutex);
-            pthread_mutex_unlock(&xc->mutex);
-        };
-
-        pthread_mutex_lock(&xc->mutex);
-        xc->in_pthread = 1;
-        pthread_mutex_unlock(&xc->mutex);
-
         pthread_create(&xc->thread, &xc->thread_attr, fstWriterFlushContextPrivate1, xc2);
+        xc->in_pthread = 1;
     } else {
         if (xc->parallel_was_enabled) /* conservatively block */
         {
-            pthread_mutex_lock(&xc->mutex);
-            pthread_mutex_unlock(&xc->mutex);
+            fstWriterWaitFlushThread(xc);
         }
 
         xc->xc_parent = xc;
@@ -1846,8 +1851,8 @@ void fstWriterClose(fstWriterContext *xc)
 {
 #ifdef FST_WRITER_PARALLEL
     if (xc) {
-        pthread_mutex_lock(&xc->mutex);
-        pthread_mutex_unlock(&xc->mutex);
+        /* wait for a flush thread that may still be running */
+        fstWriterWaitFlushThread(xc);
     }
 #endif
 
@@ -1881,13 +1886,7 @@ void fstWriterClose(fstWriterContext *xc)
                 }
                 fstWriterFlushContextPrivate(xc);
 #ifdef FST_WRITER_PARALLEL
-                pthread_mutex_lock(&xc->mutex);
-                pthread_mutex_unlock(&xc->mutex);
-
-                while (xc->in_pthread) {
-                    pthread_mutex_lock(&xc->mutex);
-                    pthread_mutex_unlock(&xc->mutex);
-                };
+                fstWriterWaitFlushThread(xc);
 #endif
             }
         }
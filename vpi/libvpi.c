@@ -19,7 +19,7 @@
 
 #if defined(__MINGW32__) || defined (__CYGWIN__)
 
-#include "vpi_user.h"
+#include "sv_vpi_user.h"
 #include <assert.h>
 
 static vpip_routines_s*vpip_routines = 0;
@@ -128,6 +128,19 @@ vpiHandle vpi_put_value(vpiHandle obj, p_vpi_value value, p_vpi_time when, PLI_I
       return vpip_routines->put_value(obj, value, when, flags);
 }
 
+void vpi_get_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
+			 PLI_INT32*index_p, PLI_UINT32 num)
+{
+      assert(vpip_routines);
+      vpip_routines->get_value_array(object, arrayvalue_p, index_p, num);
+}
+void vpi_put_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
+			 PLI_INT32*index_p, PLI_UINT32 num)
+{
+      assert(vpip_routines);
+      vpip_routines->put_value_array(object, arrayvalue_p, index_p, num);
+}
+
 // time processing
 
 void vpi_get_time(vpiHandle obj, s_vpi_time*t)
@@ -306,6 +319,27 @@ void vpip_set_return_value(int value)
       assert(vpip_routines);
       vpip_routines->set_return_value(value);
 }
+vpiHandle vpip_make_change_set(PLI_INT32 (*cb_rtn)(p_vpip_change_set_data),
+                               PLI_BYTE8*user_data)
+{
+      assert(vpip_routines);
+      return vpip_routines->make_change_set(cb_rtn, user_data);
+}
+PLI_INT32 vpip_change_set_add(vpiHandle set, vpiHandle obj)
+{
+      assert(vpip_routines);
+      return vpip_routines->change_set_add(set, obj);
+}
+void vpip_change_set_enable(vpiHandle set, int flag)
+{
+      assert(vpip_routines);
+      vpip_routines->change_set_enable(set, flag);
+}
+void vpip_remove_change_set(vpiHandle set)
+{
+      assert(vpip_routines);
+      vpip_routines->remove_change_set(set);
+}
 
 DLLEXPORT PLI_UINT32 vpip_set_callback(vpip_routines_s*routines, PLI_UINT32 version)
 {
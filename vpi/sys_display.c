@@ -1468,9 +1468,11 @@ static PLI_INT32 sys_strobe_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
 struct monitor_cb_info {
       struct strobe_cb_info strobe;
-      vpiHandle *callbacks;
+      vpiHandle changes;
       vpiHandle scheduled;
       int disabled;
+      int displayed;
+      PLI_UINT64 display_time;
 };
 
 static struct monitor_cb_info**monitor_info = 0;
@@ -1491,20 +1493,16 @@ found_empty_slot:
 
 static void cancel_monitor(struct monitor_cb_info*monitor)
 {
-      unsigned idx;
-
       if (monitor == 0) return;
 
       if (monitor->scheduled) {
 	    vpi_remove_cb(monitor->scheduled);
 	    monitor->scheduled = 0;
       }
-      for (idx = 0; idx < monitor->strobe.nitems; idx += 1) {
-	    if (monitor->callbacks[idx])
-		  vpi_remove_cb(monitor->callbacks[idx]);
+      if (monitor->changes) {
+	    vpip_remove_change_set(monitor->changes);
+	    monitor->changes = 0;
       }
-      free(monitor->callbacks);
-      monitor->callbacks = 0;
       free(monitor->strobe.filename);
       free(monitor->strobe.items);
       monitor->strobe.items = 0;
@@ -1519,9 +1517,8 @@ static void cancel_fmonitor(unsigned idx)
       monitor_info[idx] = 0;
 }
 
-static PLI_INT32 monitor_cb_2(p_cb_data cb)
+static void display_monitor(struct monitor_cb_info*monitor, PLI_UINT64 now)
 {
-      struct monitor_cb_info*monitor = (struct monitor_cb_info*)cb->user_data;
       char* result;
       unsigned int size;
 	/* Because %u and %z may put embedded NULL characters into the
@@ -1529,8 +1526,16 @@ static PLI_INT32 monitor_cb_2(p_cb_data cb)
       result = get_display(&size, &(monitor->strobe));
       my_mcd_rawwrite(monitor->strobe.fd_mcd, result, size);
       my_mcd_rawwrite(monitor->strobe.fd_mcd, "\n", 1);
-      monitor->scheduled = 0;
       free(result);
+      monitor->displayed = 1;
+      monitor->display_time = now;
+}
+
+static PLI_INT32 monitor_cb_2(p_cb_data cb)
+{
+      struct monitor_cb_info*monitor = (struct monitor_cb_info*)cb->user_data;
+      monitor->scheduled = 0;
+      display_monitor(monitor, timerec_to_time64(cb->time));
       return 0;
 }
 
@@ -1553,21 +1558,22 @@ static void schedule_monitor_display(struct monitor_cb_info*monitor)
 }
 
 /*
- * The monitor_cb_1 callback is called when a monitored value changes.
- * All this function does is schedule the actual display to occur in a
- * ReadOnlySync callback. The scheduled event handle in the monitor info
- * is used to ensure only one display is scheduled in each time slot,
- * and can also be used to cancel the display event if the monitor gets
- * cancelled.
+ * The monitored values are members of a change set, and the
+ * monitor_changes_cb callback is called in the ReadOnlySync region of
+ * each time step in which any of them changed. The monitor is only
+ * displayed once in each time step, so skip the display if it is
+ * already scheduled (by the $monitor or $monitoron call) or has
+ * already happened at this time.
  */
-static PLI_INT32 monitor_cb_1(p_cb_data cb)
+static PLI_INT32 monitor_changes_cb(p_vpip_change_set_data data)
 {
-      struct monitor_cb_info*monitor = (struct monitor_cb_info*)cb->user_data;
+      struct monitor_cb_info*monitor = (struct monitor_cb_info*)data->user_data;
+      PLI_UINT64 now = timerec_to_time64(&data->time);
 
-      if (monitor->disabled) return 0;
       if (monitor->scheduled) return 0;
+      if (monitor->displayed && monitor->display_time == now) return 0;
 
-      schedule_monitor_display(monitor);
+      display_monitor(monitor, now);
 
       return 0;
 }
@@ -1584,8 +1590,6 @@ static PLI_INT32 sys_monitor_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       vpiHandle callh, argv, scope;
       struct monitor_cb_info*monitor;
-      struct t_cb_data cb;
-      struct t_vpi_time timerec;
       PLI_UINT32 fd_mcd;
       unsigned idx;
 
@@ -1619,15 +1623,11 @@ static PLI_INT32 sys_monitor_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       monitor->strobe.scope = scope;
       monitor->strobe.fd_mcd = fd_mcd;
 
-	/* Attach callbacks to all the parameters that might change. */
-      monitor->callbacks = calloc(monitor->strobe.nitems, sizeof(vpiHandle));
-
-      timerec.type = vpiSuppressTime;
-      cb.reason = cbValueChange;
-      cb.cb_rtn = monitor_cb_1;
-      cb.time = &timerec;
-      cb.value = NULL;
-      cb.user_data = (char*)monitor;
+	/* Watch all the parameters that might change. */
+      monitor->changes = vpip_make_change_set(monitor_changes_cb,
+                                              (char*)monitor);
+      vpip_change_set_enable(monitor->changes, !monitor->disabled);
+      monitor->displayed = 0;
       for (idx = 0 ;  idx < monitor->strobe.nitems ;  idx += 1) {
 
 	    switch (vpi_get(vpiType, monitor->strobe.items[idx])) {
@@ -1647,10 +1647,10 @@ static PLI_INT32 sys_monitor_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 		case vpiLongIntVar:
 		case vpiRealVar:
 		case vpiPartSelect:
-		    /* Monitoring reg and net values involves setting
-		       a callback for value changes. */
-		  cb.obj = monitor->strobe.items[idx];
-		  monitor->callbacks[idx] = vpi_register_cb(&cb);
+		    /* Monitoring reg and net values involves adding
+		       them to the change set. */
+		  vpip_change_set_add(monitor->changes,
+		                      monitor->strobe.items[idx]);
 		  break;
 
 	    }
@@ -1668,6 +1668,8 @@ static PLI_INT32 sys_monitoron_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       (void)name; /* Parameter is not used. */
       assert(monitor_info);
       monitor_info[0]->disabled = 0;
+      if (monitor_info[0]->changes)
+	    vpip_change_set_enable(monitor_info[0]->changes, 1);
       schedule_monitor_display(monitor_info[0]);
       return 0;
 }
@@ -1677,6 +1679,8 @@ static PLI_INT32 sys_monitoroff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       (void)name; /* Parameter is not used. */
       assert(monitor_info);
       monitor_info[0]->disabled = 1;
+      if (monitor_info[0]->changes)
+	    vpip_change_set_enable(monitor_info[0]->changes, 0);
       return 0;
 }
 
@@ -2271,6 +2275,10 @@ static PLI_INT32 sys_severity_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       free(info.items);
       free(dstr);
 
+	/* An error writes out the flight recorder of the dumper. */
+      if ((strncmp(name,"$error",6) == 0) || (strncmp(name,"$fatal",6) == 0))
+	    vcd_ring_trigger();
+
       if (strncmp(name,"$fatal",6) == 0) {
 	      /* Set the exit code from vvp as an error code. */
 	    vpip_set_return_value(1);
@@ -40,9 +40,14 @@ static struct t_vpi_time zero_delay = { vpiSimTime, 0, 0, 0.0 };
 DECLARE_VCD_INFO(vcd_info, fstHandle);
 static struct vcd_info *vcd_list = NULL;
 static struct vcd_info *vcd_const_list = NULL;
-static struct vcd_info *vcd_dmp_list = NULL;
+static vpiHandle vcd_change_set = 0;
+static struct vcd_info **vcd_set_info = NULL;
+static unsigned vcd_set_count = 0;
 
 static PLI_UINT64 vcd_cur_time = 0;
+static const char*ring_arg = 0;
+static const char*ring_max_arg = 0;
+static int vcd_ring_flag = 0;
 static int dump_is_off = 0;
 static long dump_limit = 0;
 static int dump_is_full = 0;
@@ -64,6 +69,137 @@ static const char*units_names[] = {
       "fs"
 };
 
+/*
+ * Once the header is complete, the value changes are captured by the
+ * simulation and passed through the vcd_work queue to a writer thread
+ * that does all the calls into the FST writer, including the block
+ * compression. The fst_threads value comes from the +fst+threads=N
+ * plusarg. Zero means no writer thread, one (the default) is just the
+ * writer thread, and two or more also turn on the parallel mode of
+ * the FST writer so that each block is compressed in yet another
+ * thread. The FST writer compresses only one block at a time, so
+ * larger values act like two. The writer thread is not used when
+ * there is a $dumplimit, since the limit is checked after every
+ * value change.
+ */
+static int fst_threads = 1;
+static int fst_writer_flag = 0;
+
+static void write_vec(fstHandle ident, unsigned wid, const s_vpi_vecval*vec)
+{
+      static const char bit_char[4] = { '0', '1', 'z', 'x' };
+      static char*buf = 0;
+      static unsigned buf_size = 0;
+      unsigned idx;
+
+      if (wid >= buf_size) {
+	    buf_size = wid + 1;
+	    buf = realloc(buf, buf_size);
+      }
+
+      for (idx = 0 ; idx < wid ; idx += 1) {
+	    const s_vpi_vecval*cur = vec + idx/32;
+	    unsigned sh = idx%32;
+	    buf[wid-1-idx] = bit_char[((cur->aval>>sh)&1) | ((cur->bval>>sh)&1)<<1];
+      }
+      buf[wid] = 0;
+
+      fstWriterEmitValueChange(dump_file, ident, buf);
+}
+
+static void emit_time(PLI_UINT64 now)
+{
+      if (fst_writer_flag)
+	    vcd_work_emit_time(now);
+      else
+	    fstWriterEmitTimeChange(dump_file, now);
+}
+
+static void emit_real(fstHandle ident, double val)
+{
+      if (fst_writer_flag)
+	    vcd_work_emit_fst_real(ident, val);
+      else
+	    fstWriterEmitValueChange(dump_file, ident, &val);
+}
+
+static void emit_vec(fstHandle ident, unsigned wid, const s_vpi_vecval*vec)
+{
+      if (fst_writer_flag)
+	    vcd_work_emit_fst_vec(ident, wid, vec);
+      else
+	    write_vec(ident, wid, vec);
+}
+
+static void emit_dump_active(int enable)
+{
+      if (! fst_writer_flag)
+	    fstWriterEmitDumpActive(dump_file, enable);
+      else if (enable)
+	    vcd_work_dumpon();
+      else
+	    vcd_work_dumpoff();
+}
+
+static void* fst_writer_thread(void*arg)
+{
+      int run_flag = 1;
+
+      (void)arg; /* Parameter is not used. */
+
+      while (run_flag) {
+	    struct vcd_work_item_s*cell = vcd_work_thread_peek();
+
+	    switch (cell->type) {
+		case WT_EMIT_TIME:
+		  fstWriterEmitTimeChange(dump_file, cell->time);
+		  break;
+		case WT_EMIT_DOUBLE:
+		  fstWriterEmitValueChange(dump_file, cell->sym_.fst,
+					   &cell->op_.val_double);
+		  break;
+		case WT_EMIT_VEC:
+		  write_vec(cell->sym_.fst, cell->wid, cell->wid <= 32
+			    ? &cell->op_.val_vec : cell->op_.val_vecp);
+		  break;
+		case WT_DUMPON:
+		  fstWriterEmitDumpActive(dump_file, 1);
+		  break;
+		case WT_DUMPOFF:
+		  fstWriterEmitDumpActive(dump_file, 0);
+		  break;
+		case WT_FLUSH:
+		  fstWriterFlushContext(dump_file);
+		  break;
+		case WT_TERMINATE:
+		  run_flag = 0;
+		  break;
+		default:
+		  break;
+	    }
+
+	    vcd_work_thread_pop();
+      }
+
+      return 0;
+}
+
+static void start_fst_writer(void)
+{
+      if (fst_writer_flag || fst_threads == 0 || dump_limit > 0) return;
+
+      vcd_work_start(fst_writer_thread, 0);
+      fst_writer_flag = 1;
+}
+
+static void stop_fst_writer(void)
+{
+      if (! fst_writer_flag) return;
+
+      vcd_work_terminate();
+      fst_writer_flag = 0;
+}
+
 static void show_this_item(struct vcd_info*info)
 {
       s_vpi_value value;
@@ -72,15 +208,30 @@ static void show_this_item(struct vcd_info*info)
       if (type == vpiRealVar) {
 	    value.format = vpiRealVal;
 	    vpi_get_value(info->item, &value);
-	    fstWriterEmitValueChange(dump_file, info->ident, &value.value.real);
-      } else if (type == vpiParameter && vpi_get(vpiConstType, info->item) == vpiRealConst) {
-	    value.format = vpiRealVal;
-	    vpi_get_value(info->item, &value);
-	    fstWriterEmitValueChange(dump_file, info->ident, &value.value.real);
+	    emit_real(info->ident, value.value.real);
+      } else if (type == vpiNamedEvent) {
+	    static const s_vpi_vecval one = { 1, 0 };
+	    emit_vec(info->ident, 1, &one);
+      } else if (type == vpiParameter) {
+	      /* Parameters are only shown with the header, before
+	       * there is a writer thread. */
+	    assert(! fst_writer_flag);
+	    if (vpi_get(vpiConstType, info->item) == vpiRealConst) {
+		  value.format = vpiRealVal;
+		  vpi_get_value(info->item, &value);
+		  fstWriterEmitValueChange(dump_file, info->ident,
+					   &value.value.real);
+	    } else {
+		  value.format = vpiBinStrVal;
+		  vpi_get_value(info->item, &value);
+		  fstWriterEmitValueChange(dump_file, info->ident,
+					   value.value.str);
+	    }
       } else {
-	    value.format = vpiBinStrVal;
+	    value.format = vpiVectorVal;
 	    vpi_get_value(info->item, &value);
-	    fstWriterEmitValueChange(dump_file, info->ident, (type != vpiNamedEvent) ? value.value.str : "1");
+	    emit_vec(info->ident, vpi_get(vpiSize, info->item),
+		     value.value.vector);
       }
 }
 
@@ -91,16 +242,22 @@ static void show_this_item_x(struct vcd_info*info)
 
       if (type == vpiRealVar) {
 	      /* Some tools dump nothing here...? */
-            double mynan = strtod("NaN", NULL);
-	    fstWriterEmitValueChange(dump_file, info->ident, &mynan);
+	    emit_real(info->ident, strtod("NaN", NULL));
       } else if (type == vpiNamedEvent) {
 	    /* Do nothing for named events. */
       } else {
-	    int siz = vpi_get(vpiSize, info->item);
-	    char *xmem = malloc(siz);
-	    memset(xmem, 'x', siz);
-	    fstWriterEmitValueChange(dump_file, info->ident, xmem);
-	    free(xmem);
+	      /* An all ones aval/bval pair is x. */
+	    static s_vpi_vecval*xvec = 0;
+	    static unsigned xvec_cnt = 0;
+	    unsigned siz = vpi_get(vpiSize, info->item);
+	    unsigned cnt = (siz + 31) / 32;
+	    if (cnt > xvec_cnt) {
+		  xvec = realloc(xvec, cnt*sizeof(s_vpi_vecval));
+		  memset(xvec + xvec_cnt, 0xff,
+			 (cnt-xvec_cnt)*sizeof(s_vpi_vecval));
+		  xvec_cnt = cnt;
+	    }
+	    emit_vec(info->ident, siz, xvec);
       }
 }
 
@@ -119,63 +276,161 @@ __inline__ static int dump_header_pending(void)
       return dumpvars_status != 2;
 }
 
-static PLI_INT32 variable_cb_2(p_cb_data cause)
+/*
+ * In the flight recorder mode (+fst+ring=<window>) the value changes
+ * go to the ring instead of the FST writer. The ring is written out
+ * when the trigger is pulled or at a $dumpflush. The data of each ring
+ * slot is the vcd_info of the item.
+ */
+static int ring_flushed = 0;
+
+static fstHandle ring_ident(unsigned slot)
 {
-      struct vcd_info* info = vcd_dmp_list;
-      PLI_UINT64 now = timerec_to_time64(cause->time);
+      return ((struct vcd_info*)vcd_ring_item_data(slot))->ident;
+}
 
-      if (now != vcd_cur_time) {
-	    fstWriterEmitTimeChange(dump_file, now);
-	    vcd_cur_time = now;
-      }
+static void ring_show_time(uint64_t time)
+{
+      if (time != vcd_cur_time) fstWriterEmitTimeChange(dump_file, time);
+      vcd_cur_time = time;
+}
 
-      do {
-           show_this_item(info);
-           info->scheduled = 0;
-      } while ((info = info->dmp_next) != 0);
+/*
+ * Some time steps were lost since the last flush, so turn the dump off
+ * from the first lost step until the start of this window.
+ */
+static void ring_show_gap(uint64_t off_time, uint64_t on_time)
+{
+      ring_show_time(off_time);
+      fstWriterEmitDumpActive(dump_file, 0);
+      ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item_x);
 
-      vcd_dmp_list = 0;
+      ring_show_time(on_time);
+      fstWriterEmitDumpActive(dump_file, 1);
+}
 
-      return 0;
+static void ring_show_end(void)
+{
+	/* There is no $dumpvars section to close in an FST dump. */
 }
 
-static PLI_INT32 variable_cb_1(p_cb_data cause)
+static void ring_show_vec(unsigned slot, unsigned wid, const s_vpi_vecval*val)
 {
-      struct t_cb_data cb;
-      struct vcd_info*info = (struct vcd_info*)cause->user_data;
+      write_vec(ring_ident(slot), wid, val);
+}
 
-      if (dump_is_full) return 0;
-      if (dump_is_off) return 0;
-      if (dump_header_pending()) return 0;
-      if (info->scheduled) return 0;
+static void ring_show_real(unsigned slot, double val)
+{
+      fstWriterEmitValueChange(dump_file, ring_ident(slot), &val);
+}
+
+static void ring_show_event(unsigned slot)
+{
+      static const s_vpi_vecval one = { 1, 0 };
+      write_vec(ring_ident(slot), 1, &one);
+}
+
+static const struct vcd_ring_fun_s ring_show_fun = {
+      ring_show_time, ring_show_gap, ring_show_end, ring_show_time,
+      ring_show_vec, ring_show_real, ring_show_event
+};
+
+static void ring_flush(void)
+{
+      vcd_ring_flush(&ring_show_fun);
+      fstWriterFlushContext(dump_file);
+      ring_flushed = 1;
+}
+
+static void add_to_ring(struct vcd_info*info)
+{
+      info->slot = vcd_ring_add_item(info->item, info);
+}
+
+/*
+ * Start the ring with the values at the $dumpvars time as the slot
+ * values. The dump so far only has the header and the parameters.
+ */
+static void start_fst_ring(void)
+{
+      if (! vcd_ring_start("FST", "fst", ring_arg, ring_max_arg,
+                           dumpvars_time, ring_flush))
+	    return;
+
+      vcd_ring_flag = 1;
+      ITERATE_VCD_INFO(vcd_list, vcd_info, next, add_to_ring);
+      vcd_ring_all_items(dump_is_off);
+}
+
+/*
+ * The signals are members of the vcd_change_set, which reports the
+ * signals that changed at the end of each time step. The set only
+ * collects changes while they are being dumped.
+ */
+static void update_change_set(void)
+{
+      if (vcd_change_set == 0) return;
+
+      vpip_change_set_enable(vcd_change_set, !dump_is_off && !dump_is_full
+                                             && !dump_header_pending());
+}
+
+static PLI_INT32 variable_changes_cb(p_vpip_change_set_data data)
+{
+      PLI_UINT64 now = timerec_to_time64(&data->time);
+      PLI_UINT32 idx;
+
+      if (vcd_ring_flag) {
+	    vcd_ring_set_time(now);
+	    for (idx = data->count ; idx > 0 ; idx -= 1)
+		  vcd_ring_item(vcd_set_info[data->index[idx-1]]->slot);
+	    return 0;
+      }
 
       if ((dump_limit > 0) && fstWriterGetDumpSizeLimitReached(dump_file)) {
             dump_is_full = 1;
+            update_change_set();
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                                "exceeded.\n", dump_limit);
             return 0;
       }
 
-      if (!vcd_dmp_list) {
-          cb = *cause;
-	  cb.time = &zero_delay;
-          cb.reason = cbReadOnlySynch;
-          cb.cb_rtn = variable_cb_2;
-          vpi_register_cb(&cb);
+      if (now != vcd_cur_time) {
+	    emit_time(now);
+	    vcd_cur_time = now;
       }
 
-      info->scheduled = 1;
-      info->dmp_next  = vcd_dmp_list;
-      vcd_dmp_list    = info;
+	/* The items are dumped last changed first. */
+      for (idx = data->count ; idx > 0 ; idx -= 1)
+	    show_this_item(vcd_set_info[data->index[idx-1]]);
 
       return 0;
 }
 
+static void add_to_change_set(struct vcd_info*info)
+{
+      PLI_INT32 idx;
+
+      if (vcd_change_set == 0) {
+	    vcd_change_set = vpip_make_change_set(variable_changes_cb, 0);
+	    update_change_set();
+      }
+
+      idx = vpip_change_set_add(vcd_change_set, info->item);
+      if (idx < 0) return;
+
+      assert((unsigned)idx == vcd_set_count);
+      vcd_set_info = realloc(vcd_set_info,
+                             (vcd_set_count+1)*sizeof(struct vcd_info*));
+      vcd_set_info[vcd_set_count++] = info;
+}
+
 static PLI_INT32 dumpvars_cb(p_cb_data cause)
 {
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      update_change_set();
 
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
@@ -186,6 +441,20 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
 	    fstWriterEmitTimeChange(dump_file, dumpvars_time);
 	    /* nothing to do for  $dumpvars... */
 	    ITERATE_VCD_INFO(vcd_const_list, vcd_info, next, show_this_item);
+      }
+
+	/* In the flight recorder mode nothing more is written until
+	 * the ring is flushed. */
+      if (ring_arg) {
+	    start_fst_ring();
+	    if (vcd_ring_flag) return 0;
+      }
+
+	/* The header is complete, so the rest of the dump can be
+	 * done by the writer thread. */
+      start_fst_writer();
+
+      if (!dump_is_off) {
 	    ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item);
 	    /* ...nothing to do for $end */
       }
@@ -203,12 +472,25 @@ static PLI_INT32 finish_cb(p_cb_data cause)
 
       dumpvars_time = timerec_to_time64(cause->time);
 
-      if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
-	    fstWriterEmitTimeChange(dump_file, dumpvars_time);
+      if (vcd_ring_flag) {
+	    vcd_ring_finish();
+	    if (ring_flushed && dumpvars_time != vcd_cur_time)
+		  fstWriterEmitTimeChange(dump_file, dumpvars_time);
+      } else if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
+	    emit_time(dumpvars_time);
       }
 
+      stop_fst_writer();
       fstWriterClose(dump_file);
 
+      if (vcd_change_set) {
+	    vpip_remove_change_set(vcd_change_set);
+	    vcd_change_set = 0;
+      }
+      free(vcd_set_info);
+      vcd_set_info = 0;
+      vcd_set_count = 0;
+
       for (cur = vcd_list ;  cur ;  cur = next) {
 	    next = cur->next;
 	    free(cur);
@@ -267,6 +549,7 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_is_off) return 0;
 
       dump_is_off = 1;
+      update_change_set();
 
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
@@ -275,12 +558,18 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      if (vcd_ring_flag) {
+	    vcd_ring_set_time(now64);
+	    vcd_ring_all_items(1);
+	    return 0;
+      }
+
       if (now64 > vcd_cur_time) {
-	    fstWriterEmitTimeChange(dump_file, now64);
+	    emit_time(now64);
 	    vcd_cur_time = now64;
       }
 
-      fstWriterEmitDumpActive(dump_file, 0); /* $dumpoff */
+      emit_dump_active(0); /* $dumpoff */
       ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item_x);
 
       return 0;
@@ -296,6 +585,7 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (!dump_is_off) return 0;
 
       dump_is_off = 0;
+      update_change_set();
 
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
@@ -304,12 +594,18 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      if (vcd_ring_flag) {
+	    vcd_ring_set_time(now64);
+	    vcd_ring_all_items(0);
+	    return 0;
+      }
+
       if (now64 > vcd_cur_time) {
-	    fstWriterEmitTimeChange(dump_file, now64);
+	    emit_time(now64);
 	    vcd_cur_time = now64;
       }
 
-      fstWriterEmitDumpActive(dump_file, 1); /* $dumpon */
+      emit_dump_active(1); /* $dumpon */
       ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item);
 
       return 0;
@@ -325,13 +621,15 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_is_off) return 0;
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
+	/* The ring already holds all the values. */
+      if (vcd_ring_flag) return 0;
 
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fstWriterEmitTimeChange(dump_file, now64);
+	    emit_time(now64);
 	    vcd_cur_time = now64;
       }
 
@@ -394,6 +692,10 @@ static void open_dumpfile(vpiHandle callh)
 	        (lxm_optimum_mode == LXM_BOTH)) {
 		  fstWriterSetRepackOnClose(dump_file, 1);
 	    }
+#ifdef HAVE_LIBPTHREAD
+	      /* Compress the blocks in a separate thread when asked. */
+	    if (fst_threads > 1) fstWriterSetParallelMode(dump_file, 1);
+#endif
       }
 }
 
@@ -406,7 +708,12 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       (void)name; /* Parameter is not used. */
-      if (dump_file) fstWriterFlushContext(dump_file);
+      if (vcd_ring_flag)
+	    vcd_ring_trigger();
+      else if (fst_writer_flag)
+	    vcd_work_flush();
+      else if (dump_file)
+	    fstWriterFlushContext(dump_file);
 
       return 0;
 }
@@ -423,6 +730,15 @@ static PLI_INT32 sys_dumplimit_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       val.format = vpiIntVal;
       vpi_get_value(vpi_scan(argv), &val);
       dump_limit = val.value.integer;
+
+	/* The limit is checked at the end of every time step, so stop the
+	 * writer thread and call the FST writer directly. The limit is
+	 * also enforced by the block compression, so keep that in the
+	 * calling thread as well. */
+      if (dump_limit > 0) {
+	    stop_fst_writer();
+	    fstWriterSetParallelMode(dump_file, 0);
+      }
       fstWriterSetDumpSizeLimit(dump_file, dump_limit);
 
       vpi_free_object(argv);
@@ -431,7 +747,6 @@ static PLI_INT32 sys_dumplimit_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 
 static void scan_item(unsigned depth, vpiHandle item, int skip)
 {
-      struct t_cb_data cb;
       struct vcd_info* info;
 
       enum fstVarType type = FST_VT_MAX;
@@ -593,26 +908,16 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  if (nexus_id) set_nexus_ident(nexus_id,
 		                                (const char *)(intptr_t)new_ident);
 
-		    /* Add a callback for the signal. */
+		    /* Watch the signal for value changes. */
 		  info = malloc(sizeof(*info));
 
-		  info->time.type = vpiSimTime;
 		  info->item  = item;
 		  info->ident = new_ident;
-		  info->scheduled = 0;
-
-		  cb.time      = &info->time;
-		  cb.user_data = (char*)info;
-		  cb.value     = NULL;
-		  cb.obj       = item;
-		  cb.reason    = cbValueChange;
-		  cb.cb_rtn    = variable_cb_1;
-
-		  info->dmp_next = 0;
+		  info->cb    = NULL;
 		  info->next  = vcd_list;
 		  vcd_list    = info;
 
-		  info->cb    = vpi_register_cb(&cb);
+		  add_to_change_set(info);
 	    }
 
 	    break;
@@ -641,8 +946,6 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	    info = malloc(sizeof(*info));
 	    info->item = item;
 	    info->ident = new_ident;
-	    info->scheduled = 0;
-	    info->dmp_next = 0;
 	    info->next = vcd_const_list;
 	    info->cb = NULL;
 	    vcd_const_list = info;
@@ -905,6 +1208,13 @@ void sys_fst_register(void)
 		  lxm_optimum_mode = LXM_BOTH;
 		} else if (strcmp(vlog_info.argv[idx],"-no-date") == 0) {
 		  dump_no_date = 1;
+		} else if (strncmp(vlog_info.argv[idx],"+fst+threads=",13) == 0) {
+		  fst_threads = atoi(vlog_info.argv[idx]+13);
+		  if (fst_threads < 0) fst_threads = 0;
+		} else if (strncmp(vlog_info.argv[idx],"+fst+ring=",10) == 0) {
+		  ring_arg = vlog_info.argv[idx]+10;
+		} else if (strncmp(vlog_info.argv[idx],"+fst+ring_max=",14) == 0) {
+		  ring_max_arg = vlog_info.argv[idx]+14;
 		}
       }
 
@@ -36,6 +36,9 @@ static PLI_INT32 finish_and_return_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
     /* Set the return value. */
     vpip_set_return_value(val.value.integer);
 
+    /* A failure writes out the flight recorder of the dumper. */
+    if (val.value.integer != 0) vcd_ring_trigger();
+
     /* Now finish. */
     vpi_control(vpiFinish, 1);
     return 0;
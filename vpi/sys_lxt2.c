@@ -48,9 +48,7 @@ static struct t_vpi_time zero_delay = { vpiSimTime, 0, 0, 0.0 };
  */
 struct vcd_info {
       vpiHandle item;
-      vpiHandle cb;
       struct lxt2_wr_symbol *sym;
-      struct vcd_info *dmp_next;
 };
 
 struct vcd_info_chunk {
@@ -98,14 +96,13 @@ static void delete_all_vcd_info(void)
 }
 
 /*
- * Use this pointer to keep a list of vcd_info items that are
- * scheduled to be dumped. Use the VCD_INFO_ENDP value as a trailer
- * pointer instead of 0 so that individual vcd_info objects can tell
- * if they are in the list already, even if they are at the end of the
- * list.
+ * The dumped items are members of the vcd_change_set, which reports
+ * the items that changed at the end of each time step. The
+ * vcd_set_info array maps the member index back to the vcd_info.
  */
-#define VCD_INFO_ENDP ((struct vcd_info*)(uintptr_t) 0x01)
-static struct vcd_info *vcd_dmp_list = VCD_INFO_ENDP;
+static vpiHandle vcd_change_set = 0;
+static struct vcd_info **vcd_set_info = NULL;
+static unsigned vcd_set_count = 0;
 
 static PLI_UINT64 vcd_cur_time = 0;
 static int dump_is_off = 0;
@@ -263,62 +260,67 @@ static void vcd_checkpoint_x(void)
       functor_all_vcd_info( show_this_item_x );
 }
 
-static PLI_INT32 variable_cb_2(p_cb_data cause)
+/*
+ * Value changes are only collected while they are being dumped.
+ */
+static void update_change_set(void)
 {
-      assert(cause->time->type == vpiSimTime);
-      PLI_UINT64 now = timerec_to_time64(cause->time);
-
-      if (now != vcd_cur_time) {
-	    vcd_work_set_time(now);
-	    vcd_cur_time = now;
-      }
-
-      while (vcd_dmp_list != VCD_INFO_ENDP) {
-	    struct vcd_info* info = vcd_dmp_list;
-	    show_this_item(info);
-	    vcd_dmp_list = info->dmp_next;
-	    info->dmp_next = 0;
-      }
+      if (vcd_change_set == 0) return;
 
-      return 0;
+      vpip_change_set_enable(vcd_change_set, !dump_is_off && !dump_is_full
+                                             && !dump_header_pending());
 }
 
-static PLI_INT32 variable_cb_1(p_cb_data cause)
+static PLI_INT32 variable_changes_cb(p_vpip_change_set_data data)
 {
-      struct t_cb_data cb;
-      struct vcd_info*info = (struct vcd_info*)cause->user_data;
-
-      if (dump_is_full) return 0;
-      if (dump_is_off) return 0;
-      if (dump_header_pending()) return 0;
-      if (info->dmp_next) return 0;
+      assert(data->time.type == vpiSimTime);
+      PLI_UINT64 now = timerec_to_time64(&data->time);
+      PLI_UINT32 idx;
 
       if ((dump_limit > 0) && (ftell(dump_file->handle) > dump_limit)) {
             dump_is_full = 1;
+            update_change_set();
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                        "exceeded.\n", dump_limit);
             return 0;
       }
 
-      if (vcd_dmp_list == VCD_INFO_ENDP) {
-          cb = *cause;
-	  cb.time = &zero_delay;
-          cb.reason = cbReadOnlySynch;
-          cb.cb_rtn = variable_cb_2;
-          vpi_register_cb(&cb);
+      if (now != vcd_cur_time) {
+	    vcd_work_set_time(now);
+	    vcd_cur_time = now;
       }
 
-      info->dmp_next  = vcd_dmp_list;
-      vcd_dmp_list    = info;
+	/* The items are dumped last changed first. */
+      for (idx = data->count ; idx > 0 ; idx -= 1)
+	    show_this_item(vcd_set_info[data->index[idx-1]]);
 
       return 0;
 }
 
+static void add_to_change_set(struct vcd_info*info)
+{
+      PLI_INT32 idx;
+
+      if (vcd_change_set == 0) {
+	    vcd_change_set = vpip_make_change_set(variable_changes_cb, 0);
+	    update_change_set();
+      }
+
+      idx = vpip_change_set_add(vcd_change_set, info->item);
+      if (idx < 0) return;
+
+      assert((unsigned)idx == vcd_set_count);
+      vcd_set_info = realloc(vcd_set_info,
+                             (vcd_set_count+1)*sizeof(struct vcd_info*));
+      vcd_set_info[vcd_set_count++] = info;
+}
+
 static PLI_INT32 dumpvars_cb(p_cb_data cause)
 {
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      update_change_set();
 
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
@@ -343,6 +345,14 @@ static PLI_INT32 finish_cb(p_cb_data cause)
       }
 
       vcd_work_terminate();
+
+      if (vcd_change_set) {
+	    vpip_remove_change_set(vcd_change_set);
+	    vcd_change_set = 0;
+      }
+      free(vcd_set_info);
+      vcd_set_info = 0;
+      vcd_set_count = 0;
       delete_all_vcd_info();
 
       vcd_scope_names_delete();
@@ -392,6 +402,7 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_is_off) return 0;
 
       dump_is_off = 1;
+      update_change_set();
 
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
@@ -421,6 +432,7 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (!dump_is_off) return 0;
 
       dump_is_off = 0;
+      update_change_set();
 
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
@@ -577,7 +589,6 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
             -1
       };
 
-      struct t_cb_data cb;
       struct vcd_info* info;
 
       const char* name;
@@ -639,16 +650,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		                                   vpi_get(vpiLeftRange, item),
 		                                   vpi_get(vpiRightRange, item),
 		                                   LXT2_WR_SYM_F_BITS);
-		  info->dmp_next = 0;
-
-		  cb.time      = 0;
-		  cb.user_data = (char*)info;
-		  cb.value     = NULL;
-		  cb.obj       = item;
-		  cb.reason    = cbValueChange;
-		  cb.cb_rtn    = variable_cb_1;
-
-		  info->cb    = vpi_register_cb(&cb);
+		  add_to_change_set(info);
 
 	    } else {
 		  char *n = create_full_name(name);
@@ -675,16 +677,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	                                    0 /* array rows */,
 	                                    vpi_get(vpiSize, item)-1,
 	                                    0, LXT2_WR_SYM_F_DOUBLE);
-	    info->dmp_next = 0;
-
-	    cb.time      = 0;
-	    cb.user_data = (char*)info;
-	    cb.value     = NULL;
-	    cb.obj       = item;
-	    cb.reason    = cbValueChange;
-	    cb.cb_rtn    = variable_cb_1;
-
-	    info->cb    = vpi_register_cb(&cb);
+	    add_to_change_set(info);
 
 	    break;
 
@@ -833,6 +826,9 @@ static void* lxt2_thread(void*arg)
 
 	    switch (cell->type) {
 		case WT_NONE:
+		case WT_EMIT_VEC:
+		case WT_EMIT_TEXT:
+		case WT_EMIT_TIME:
 		  break;
 		case WT_FLUSH:
 		  lxt2_wr_flush(dump_file);
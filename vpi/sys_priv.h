@@ -69,6 +69,13 @@ extern vpiHandle sys_func_module(vpiHandle obj);
 
 extern void sys_monitor_fclose(PLI_UINT32 fd_mcd);
 
+/*
+ * The $dumpflush, $error and $fatal tasks, and a $finish_and_return
+ * with a failure code, call this to write out the flight recorder ring
+ * of the VCD or FST dumper. It does nothing if there is no ring.
+ */
+extern void vcd_ring_trigger(void);
+
 /*
  * The standard compiletf routines.
  */
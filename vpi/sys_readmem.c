@@ -25,6 +25,9 @@
 # include  <assert.h>
 # include  "sys_readmem_lex.h"
 # include  <sys/stat.h>
+#if !defined(__MINGW32__)
+# include  <sys/mman.h>
+#endif
 # include  "ivl_alloc.h"
 
 char **search_list = NULL;
@@ -194,6 +197,442 @@ static int process_params(vpiHandle mitem,
       return 0;
 }
 
+/*
+ * Open a memory file for reading, looking through the $readmempath
+ * search list if the file is not found as given.
+ */
+static FILE* open_mem_file(const char*fname, const char*mode)
+{
+      FILE*file = fopen(fname, mode);
+	/* Check to see if we have other directories to look for this file. */
+      if (file == 0 && sl_count > 0 && fname[0] != '/') {
+	    unsigned idx;
+	    char path[4096];
+
+	    for (idx = 0; idx < sl_count; idx += 1) {
+		  snprintf(path, sizeof(path), "%s/%s",
+		           search_list[idx], fname);
+		  path[sizeof(path)-1] = 0;
+		  if ((file = fopen(path, mode))) break;
+	    }
+      }
+      return file;
+}
+
+/*
+ * Get the entire contents of an open memory file. A regular file is
+ * mapped if the system supports it and read into an allocated buffer
+ * if not. Other files (pipes for example) are only read into memory if
+ * the stream_flag is set, otherwise this returns nil and the caller
+ * is expected to stream the file.
+ */
+static char* map_mem_file(FILE*file, int stream_flag, size_t*size, int*mapped)
+{
+      struct stat sb;
+      size_t cap;
+      char*buf;
+
+      *size = 0;
+      *mapped = 0;
+
+      if (fstat(fileno(file), &sb) == 0 && S_ISREG(sb.st_mode)) {
+	    *size = sb.st_size;
+#if !defined(__MINGW32__)
+	    if (*size > 0) {
+		  buf = mmap(0, *size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+		  if (buf != MAP_FAILED) {
+			*mapped = 1;
+			return buf;
+		  }
+	    }
+#endif
+	    buf = malloc(*size + 1);
+	      /* A file opened in text mode reads short of its size
+		 when the CR of CR LF line ends is dropped, so the size
+		 is what was read. */
+	    *size = fread(buf, 1, *size, file);
+	    if (ferror(file)) {
+		  free(buf);
+		  rewind(file);
+		  return 0;
+	    }
+	    return buf;
+      }
+
+      if (! stream_flag) return 0;
+
+      cap = 64*1024;
+      buf = malloc(cap);
+      for (;;) {
+	    size_t cnt = fread(buf + *size, 1, cap - *size, file);
+	    *size += cnt;
+	    if (cnt == 0) break;
+	    if (*size == cap) {
+		  cap *= 2;
+		  buf = realloc(buf, cap);
+	    }
+      }
+      return buf;
+}
+
+static void unmap_mem_file(char*buf, size_t size, int mapped)
+{
+#if !defined(__MINGW32__)
+      if (mapped) {
+	    munmap(buf, size);
+	    return;
+      }
+#else
+      (void)size; /* Parameter is not used. */
+      (void)mapped; /* Parameter is not used. */
+#endif
+      free(buf);
+}
+
+/*
+ * The memory loaders collect words with consecutive addresses into a
+ * run and write the whole run into the memory with a single call to
+ * vpi_put_value_array. Memories with words that cannot take vector
+ * values (real or string arrays) are written a word at a time. The
+ * runs, and the chunks that $writememh and $writememb read with
+ * vpi_get_value_array, hold about this many 32 bit values.
+ */
+# define MEM_RUN_VALS 16384
+
+struct mem_run_s {
+      vpiHandle mitem;
+      int bulk_flag;
+      unsigned nval;
+      int incr;
+      int first;
+      unsigned cnt, cap;
+      s_vpi_vecval*buf;
+};
+
+static void mem_run_start(struct mem_run_s*run, vpiHandle mitem,
+                          int min_addr, unsigned wwid, int addr_incr)
+{
+      s_vpi_value val;
+
+      val.format = vpiObjTypeVal;
+      vpi_get_value(vpi_handle_by_index(mitem, min_addr), &val);
+
+      run->mitem = mitem;
+      run->bulk_flag = val.format != vpiRealVal && val.format != vpiStringVal;
+      run->nval = (wwid + 31) / 32;
+      run->incr = addr_incr;
+      run->first = 0;
+      run->cnt = 0;
+      run->cap = run->bulk_flag ? MEM_RUN_VALS / run->nval : 1;
+      if (run->cap == 0) run->cap = 1;
+      run->buf = calloc(run->cap * run->nval, sizeof(s_vpi_vecval));
+}
+
+static void mem_run_flush(struct mem_run_s*run)
+{
+      s_vpi_arrayvalue arr;
+      PLI_INT32 index;
+      unsigned idx;
+
+      if (run->cnt == 0) return;
+
+      if (! run->bulk_flag) {
+	    s_vpi_value val;
+	    vpiHandle word = vpi_handle_by_index(run->mitem, run->first);
+	    assert(word);
+	    assert(run->cnt == 1);
+	    val.format = vpiVectorVal;
+	    val.value.vector = run->buf;
+	    vpi_put_value(word, &val, 0, vpiNoDelay);
+	    run->cnt = 0;
+	    return;
+      }
+
+      arr.format = vpiVectorVal;
+      arr.flags = 0;
+
+	/* The words of a descending run are written one at a time in
+	   file order so that the word changes propagate in the same
+	   order as they would for individual writes. */
+      if (run->incr < 0) {
+	    for (idx = 0 ; idx < run->cnt ; idx += 1) {
+		  index = run->first - (int)idx;
+		  arr.value.vectors = run->buf + idx*run->nval;
+		  vpi_put_value_array(run->mitem, &arr, &index, 1);
+	    }
+      } else {
+	    index = run->first;
+	    arr.value.vectors = run->buf;
+	    vpi_put_value_array(run->mitem, &arr, &index, run->cnt);
+      }
+      run->cnt = 0;
+}
+
+/*
+ * Return the run slot for the word at the given address. This flushes
+ * the current run if the address does not extend it.
+ */
+static s_vpi_vecval* mem_run_word(struct mem_run_s*run, int addr)
+{
+      if (run->cnt > 0) {
+	    if (run->cnt == run->cap
+	        || addr != run->first + run->incr*(int)run->cnt)
+		  mem_run_flush(run);
+      }
+      if (run->cnt == 0) run->first = addr;
+      run->cnt += 1;
+      return run->buf + (run->cnt-1)*run->nval;
+}
+
+static void mem_run_finish(struct mem_run_s*run)
+{
+      mem_run_flush(run);
+      free(run->buf);
+}
+
+/*
+ * This is a table driven scanner for the text of $readmemh and
+ * $readmemb files that matches sys_readmem_lex.lex exactly. Every
+ * character is classified by a single table lookup: hex digits
+ * classify as their value, and the other classes follow.
+ */
+enum mem_char_class_e {
+      MC_X = 16, MC_Z, MC_SKIP, MC_SPACE, MC_AT, MC_SLASH, MC_OTHER
+};
+
+static unsigned char mem_char_class[256];
+
+static void mem_char_class_init(void)
+{
+      unsigned idx;
+
+      if (mem_char_class['@'] == MC_AT) return;
+
+      for (idx = 0 ; idx < 256 ; idx += 1)
+	    mem_char_class[idx] = MC_OTHER;
+      for (idx = 0 ; idx < 10 ; idx += 1)
+	    mem_char_class['0'+idx] = idx;
+      for (idx = 0 ; idx < 6 ; idx += 1) {
+	    mem_char_class['a'+idx] = 10 + idx;
+	    mem_char_class['A'+idx] = 10 + idx;
+      }
+      mem_char_class['x'] = MC_X;
+      mem_char_class['X'] = MC_X;
+      mem_char_class['z'] = MC_Z;
+      mem_char_class['Z'] = MC_Z;
+      mem_char_class['_'] = MC_SKIP;
+      mem_char_class[' '] = MC_SPACE;
+      mem_char_class['\t'] = MC_SPACE;
+      mem_char_class['\f'] = MC_SPACE;
+      mem_char_class['\n'] = MC_SPACE;
+      mem_char_class['\r'] = MC_SPACE;
+      mem_char_class['/'] = MC_SLASH;
+      mem_char_class['@'] = MC_AT;
+}
+
+static inline int mem_is_word_char(unsigned cls, int bin_flag)
+{
+      if (cls >= MC_X) return cls <= MC_SKIP;
+      return bin_flag ? cls <= 1 : 1;
+}
+
+/*
+ * Convert the word text [beg,end) into the vector, filling from the
+ * least significant digit. Return the number of digits (not counting
+ * underscores) that did not fit in the word.
+ */
+static unsigned mem_make_word(const unsigned char*beg, const unsigned char*end,
+                              int bin_flag, unsigned wwid, s_vpi_vecval*val)
+{
+      unsigned dwid = bin_flag ? 1 : 4;
+      PLI_UINT32 dmask = bin_flag ? 1 : 15;
+      unsigned ndig = (wwid + dwid - 1) / dwid;
+      unsigned pos = 0;
+      unsigned extra = 0;
+      unsigned idx;
+
+      for (idx = 0 ; idx < (wwid+31)/32 ; idx += 1) {
+	    val[idx].aval = 0;
+	    val[idx].bval = 0;
+      }
+
+      while (end > beg && ndig > 0) {
+	    unsigned cls = mem_char_class[*--end];
+	    PLI_UINT32 aval, bval;
+	    switch (cls) {
+		case MC_SKIP:
+		  continue;
+		case MC_X:
+		  aval = dmask;
+		  bval = dmask;
+		  break;
+		case MC_Z:
+		  aval = 0;
+		  bval = dmask;
+		  break;
+		default:
+		  aval = cls;
+		  bval = 0;
+		  break;
+	    }
+	    val[pos/32].aval |= aval << (pos%32);
+	    val[pos/32].bval |= bval << (pos%32);
+	    pos += dwid;
+	    ndig -= 1;
+      }
+
+      while (end > beg) {
+	    if (*--end != '_') extra += 1;
+      }
+      return extra;
+}
+
+/*
+ * Load a memory from the text of a $readmemh/$readmemb file that is
+ * entirely in memory. The messages are the same as the messages for
+ * the streaming (lexor based) loader in sys_readmem_calltf below.
+ */
+static void sys_readmem_scan(vpiHandle callh, const char*name,
+                             const char*fname, const char*text, size_t size,
+                             int bin_flag, unsigned wwid, vpiHandle mitem,
+                             int start_addr, int stop_addr, int addr_incr,
+                             int min_addr, int max_addr)
+{
+      const unsigned char*cp = (const unsigned char*)text;
+      const unsigned char*end = cp + size;
+      unsigned word_count = max_addr-min_addr+1;
+      int extra_warning = 0;
+      int addr = start_addr;
+      struct mem_run_s run;
+
+      mem_char_class_init();
+      mem_run_start(&run, mitem, min_addr, wwid, addr_incr);
+
+      while (cp < end) {
+	    const unsigned char*tok = cp;
+	    unsigned cls = mem_char_class[*cp];
+
+	    if (cls == MC_SPACE) {
+		  cp += 1;
+		  continue;
+	    }
+
+	    if (cls == MC_SLASH && cp+1 < end && cp[1] == '/') {
+		  cp = memchr(cp, '\n', end-cp);
+		  if (cp == 0) cp = end;
+		  continue;
+	    }
+
+	    if (cls == MC_SLASH && cp+1 < end && cp[1] == '*') {
+		  cp += 2;
+		  for (;;) {
+			cp = memchr(cp, '*', end-cp);
+			if (cp == 0) {
+			      cp = end;
+			      break;
+			}
+			cp += 1;
+			if (cp < end && *cp == '/') {
+			      cp += 1;
+			      break;
+			}
+		  }
+		  continue;
+	    }
+
+	    if (cls == MC_AT && cp+1 < end && mem_char_class[cp[1]] < 16) {
+		  PLI_UINT64 val = 0;
+		  cp += 1;
+		  while (cp < end && (cls = mem_char_class[*cp]) < 16) {
+			  /* Saturate like the sscanf() in the lexor. */
+			if (val >> 60)
+			      val = ~(PLI_UINT64)0;
+			else
+			      val = (val << 4) | cls;
+			cp += 1;
+		  }
+		  addr = (int)(PLI_UINT32)val;
+		  if (addr < min_addr || addr > max_addr) {
+			mem_run_flush(&run);
+			vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+			           (int)vpi_get(vpiLineNo, callh));
+			vpi_printf("%s(%s): address (0x%x) is out of range "
+			           "[0x%x:0x%x]\n",
+			           name, fname, addr, start_addr, stop_addr);
+			goto bailout;
+		  }
+		    /* An address in the file turns off the warning
+		       about not having enough words. */
+		  word_count = 0;
+		  continue;
+	    }
+
+	    if (mem_is_word_char(cls, bin_flag)) {
+		  unsigned extra;
+		  s_vpi_vecval*val;
+
+		  do {
+			cp += 1;
+		  } while (cp < end && mem_is_word_char(mem_char_class[*cp], bin_flag));
+
+		    /* A word outside the range is still converted (into
+		       the emptied run) so that the messages come out in
+		       the same order as the lexor based loader. */
+		  if (addr < min_addr || addr > max_addr) {
+			mem_run_flush(&run);
+			val = run.buf;
+		  } else {
+			val = mem_run_word(&run, addr);
+		  }
+
+		  extra = mem_make_word(tok, cp, bin_flag, wwid, val);
+		  if (extra && ! extra_warning) {
+			vpi_printf("WARNING: %s:%d: Excess %s digits (%u of "
+			           "'%.*s') while reading %u-bit words.\n",
+			           vpi_get_str(vpiFile, callh),
+			           (int)vpi_get(vpiLineNo, callh),
+			           bin_flag ? "binary" : "hex", extra,
+			           (int)(cp-tok), (const char*)tok, wwid);
+			extra_warning = 1;
+		  }
+
+		  if (addr < min_addr || addr > max_addr) {
+			vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+			           (int)vpi_get(vpiLineNo, callh));
+			vpi_printf("%s(%s): Too many words in the file for the "
+			           "requested range [%d:%d].\n",
+			           name, fname, start_addr, stop_addr);
+			goto bailout;
+		  }
+
+		  if (word_count > 0) word_count -= 1;
+		  addr += addr_incr;
+		  continue;
+	    }
+
+	    mem_run_flush(&run);
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s(%s): Invalid input character: %.*s\n", name,
+	               fname, 1, (const char*)tok);
+	    goto bailout;
+      }
+
+      mem_run_flush(&run);
+
+	/* Print a warning if there are not enough words in the data file. */
+      if (word_count > 0) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s(%s): Not enough words in the file for the "
+		       "requested range [%d:%d].\n", name, fname,
+		       start_addr, stop_addr);
+      }
+
+ bailout:
+      mem_run_finish(&run);
+}
+
 static PLI_INT32 sys_mem_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
@@ -274,6 +713,9 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       int code, wwid, addr;
       FILE*file;
       char *fname = 0;
+      char *text;
+      size_t text_size;
+      int text_mapped;
       s_vpi_value value;
       vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
       vpiHandle argv = vpi_iterate(vpiArgument, callh);
@@ -310,19 +752,7 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       }
 
 	/* Open the data file. */
-      file = fopen(fname, "r");
-	/* Check to see if we have other directories to look for this file. */
-      if (file == 0 && sl_count > 0 && fname[0] != '/') {
-	    unsigned idx;
-	    char path[4096];
-
-	    for (idx = 0; idx < sl_count; idx += 1) {
-		  snprintf(path, sizeof(path), "%s/%s",
-		           search_list[idx], fname);
-		  path[sizeof(path)-1] = 0;
-		  if ((file = fopen(path, "r"))) break;
-	    }
-      }
+      file = open_mem_file(fname, "r");
       if (file == 0) {
 	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
 	               (int)vpi_get(vpiLineNo, callh));
@@ -336,6 +766,21 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
       wwid = vpi_get(vpiSize, vpi_handle_by_index(mitem, min_addr));
 
+      /* A file that can be held in memory is scanned in place and
+	 loaded in runs of words. Other files are streamed through the
+	 lexor and loaded a word at a time. */
+      text = map_mem_file(file, 0, &text_size, &text_mapped);
+      if (text) {
+	    sys_readmem_scan(callh, name, fname, text, text_size,
+	                     strcmp(name,"$readmemb") == 0, wwid, mitem,
+	                     start_addr, stop_addr, addr_incr,
+	                     min_addr, max_addr);
+	    unmap_mem_file(text, text_size, text_mapped);
+	    free(fname);
+	    fclose(file);
+	    return 0;
+      }
+
       /* variable that will be used by the lexer to pass values
 	 back to this code */
       value.format = vpiVectorVal;
@@ -421,6 +866,112 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * $readmemraw loads a memory from a binary image of pre-packed words.
+ * Each word is (width+7)/8 bytes, least significant byte first, and
+ * the words are in load order from the start address to the finish
+ * address. The image only holds 2-state values.
+ */
+static PLI_INT32 sys_readmemraw_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      FILE*file;
+      char *fname = 0;
+      char *image;
+      size_t image_size, nwords;
+      int image_mapped;
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle mitem = 0;
+      vpiHandle start_item = 0;
+      vpiHandle stop_item = 0;
+      int start_addr, stop_addr, addr_incr;
+      int min_addr, max_addr;
+      unsigned word_count, wwid, nbytes, idx;
+      const unsigned char*cp;
+      struct mem_run_s run;
+      int addr;
+
+      get_mem_params(argv, callh, name,
+                     &fname, &mitem, &start_item, &stop_item);
+      if (fname == 0) return 0;
+
+      if (process_params(mitem, start_item, stop_item, callh, name,
+                         &start_addr, &stop_addr, &addr_incr,
+                         &min_addr, &max_addr)) {
+	    free(fname);
+	    return 0;
+      }
+
+      file = open_mem_file(fname, "rb");
+      if (file == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s: Unable to open %s for reading.\n", name, fname);
+	    free(fname);
+	    return 0;
+      }
+
+      image = map_mem_file(file, 1, &image_size, &image_mapped);
+      fclose(file);
+      if (image == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s: Unable to read %s.\n", name, fname);
+	    free(fname);
+	    return 0;
+      }
+
+      word_count = max_addr-min_addr+1;
+      wwid = vpi_get(vpiSize, vpi_handle_by_index(mitem, min_addr));
+      nbytes = (wwid + 7) / 8;
+      nwords = image_size / nbytes;
+
+      if (image_size % nbytes) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s(%s): The file size is not a multiple of the "
+	               "%u byte word size. The partial word is ignored.\n",
+	               name, fname, nbytes);
+      }
+
+      mem_run_start(&run, mitem, min_addr, wwid, addr_incr);
+
+      cp = (const unsigned char*)image;
+      addr = start_addr;
+      for (idx = 0 ; idx < word_count && idx < nwords ; idx += 1) {
+	    s_vpi_vecval*val = mem_run_word(&run, addr);
+	    unsigned bdx;
+	    for (bdx = 0 ; bdx < run.nval ; bdx += 1) {
+		  val[bdx].aval = 0;
+		  val[bdx].bval = 0;
+	    }
+	    for (bdx = 0 ; bdx < nbytes ; bdx += 1)
+		  val[bdx/4].aval |= (PLI_UINT32)cp[bdx] << 8*(bdx%4);
+	    cp += nbytes;
+	    addr += addr_incr;
+      }
+
+      mem_run_finish(&run);
+
+      if (nwords < word_count) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s(%s): Not enough words in the file for the "
+		       "requested range [%d:%d].\n", name, fname,
+		       start_addr, stop_addr);
+      } else if (nwords > word_count) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s(%s): Too many words in the file for the "
+	               "requested range [%d:%d].\n",
+	               name, fname, start_addr, stop_addr);
+      }
+
+      unmap_mem_file(image, image_size, image_mapped);
+      free(fname);
+      return 0;
+}
+
 static PLI_INT32 free_readmempath(p_cb_data cb_data)
 {
       unsigned idx;
@@ -520,6 +1071,64 @@ static PLI_INT32 sys_readmempath_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * Format a word of a vpiVectorVal array value as vpi_get_value does
+ * for the vpiHexStrVal (hex_flag) or vpiBinStrVal format. A hex digit
+ * is x or z if all its bits are, X if any of its bits is x and Z if
+ * any is z, and the bits of the top digit that are past the width of
+ * the word count as 0.
+ */
+static void format_mem_word(char*buf, const s_vpi_vecval*vec,
+                            unsigned wwid, int hex_flag)
+{
+      unsigned dbits = hex_flag ? 4 : 1;
+      unsigned ndig = (wwid + dbits - 1) / dbits;
+      unsigned dig;
+
+      for (dig = 0 ; dig < ndig ; dig += 1) {
+	    unsigned lsb = dig * dbits;
+	    unsigned cnt = wwid - lsb < dbits ? wwid - lsb : dbits;
+	    unsigned val = 0, cnt_x = 0, cnt_z = 0, bit;
+	    char ch;
+
+	    for (bit = 0 ; bit < cnt ; bit += 1) {
+		  unsigned idx = lsb + bit;
+		  unsigned aval = ((PLI_UINT32)vec[idx/32].aval >> idx%32) & 1;
+		  unsigned bval = ((PLI_UINT32)vec[idx/32].bval >> idx%32) & 1;
+		  if (bval && aval) cnt_x += 1;
+		  else if (bval) cnt_z += 1;
+		  else val |= aval << bit;
+	    }
+
+	    if (cnt_z == cnt) ch = 'z';
+	    else if (cnt_x == cnt) ch = 'x';
+	    else if (cnt_x > 0) ch = 'X';
+	    else if (cnt_z > 0) ch = 'Z';
+	    else ch = "0123456789abcdef"[val];
+	    buf[ndig-1-dig] = ch;
+      }
+      buf[ndig] = 0;
+}
+
+/*
+ * Return true if all the bits of the word are x.
+ */
+static int mem_word_is_x(const s_vpi_vecval*vec, unsigned wwid)
+{
+      unsigned nval = (wwid + 31) / 32;
+      unsigned idx;
+
+      for (idx = 0 ; idx < nval ; idx += 1) {
+	    PLI_UINT32 mask = 0xffffffff;
+	    if (idx == nval-1 && wwid%32)
+		  mask = ((PLI_UINT32)1 << wwid%32) - 1;
+	    if (((PLI_UINT32)vec[idx].aval & (PLI_UINT32)vec[idx].bval & mask)
+	        != mask)
+		  return 0;
+      }
+      return 1;
+}
+
 static PLI_INT32 sys_writemem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       int addr;
@@ -532,6 +1141,11 @@ static PLI_INT32 sys_writemem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpiHandle mitem = 0;
       vpiHandle start_item = 0;
       vpiHandle stop_item = 0;
+      vpiHandle word;
+      int hex_flag;
+      unsigned wwid, nval, chunk, remain;
+      char*buf;
+      char*x_line;
 
       int start_addr, stop_addr, addr_incr;
       int min_addr, max_addr; // Not used in this routine.
@@ -562,23 +1176,88 @@ static PLI_INT32 sys_writemem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 	    return 0;
       }
 
-      if (strcmp(name,"$writememb")==0) value.format = vpiBinStrVal;
-      else value.format = vpiHexStrVal;
+      hex_flag = strcmp(name,"$writememb") != 0;
+
+      word = vpi_handle_by_index(mitem, start_addr);
+      assert(word);
+      value.format = vpiObjTypeVal;
+      vpi_get_value(word, &value);
 
       /*======================================== Write memory file */
 
+	/* Memories with words that do not have vector values (real
+	   or string arrays) are written a word at a time. */
+      if (value.format == vpiRealVal || value.format == vpiStringVal) {
+	    value.format = hex_flag ? vpiHexStrVal : vpiBinStrVal;
+	    cnt = 0;
+	    for (addr=start_addr; addr!=stop_addr+addr_incr; addr+=addr_incr, ++cnt) {
+		  vpiHandle word_index;
+
+		  if (cnt%16 == 0) fprintf(file, "// 0x%08x\n", cnt);
+
+		  word_index = vpi_handle_by_index(mitem, addr);
+		  assert(word_index);
+		  vpi_get_value(word_index, &value);
+		  fprintf(file, "%s\n", value.value.str);
+	    }
+
+	    fclose(file);
+	    free(fname);
+	    return 0;
+      }
+
+	/* The words are read a chunk at a time with vpi_get_value_array
+	   and formatted here. Words that are all x, which include all
+	   the words of the pages of a sparse memory that have never been
+	   written, are written from a line of x digits that is made only
+	   once, so those pages are neither formatted nor allocated. */
+      wwid = vpi_get(vpiSize, word);
+      nval = (wwid + 31) / 32;
+      chunk = MEM_RUN_VALS / nval;
+      if (chunk == 0) chunk = 1;
+      buf = malloc(wwid + 2);
+      x_line = malloc(wwid + 2);
+      {
+	    unsigned ndig = hex_flag ? (wwid + 3) / 4 : wwid;
+	    memset(x_line, 'x', ndig);
+	    x_line[ndig] = '\n';
+	    x_line[ndig+1] = 0;
+      }
+
       cnt = 0;
-      for(addr=start_addr; addr!=stop_addr+addr_incr; addr+=addr_incr, ++cnt) {
-	  vpiHandle word_index;
+      addr = start_addr;
+      remain = (stop_addr - start_addr) * addr_incr + 1;
+      while (remain > 0) {
+	    s_vpi_arrayvalue arr;
+	    PLI_INT32 index;
+	    unsigned num = remain < chunk ? remain : chunk;
+	    unsigned idx;
+
+	    arr.format = vpiVectorVal;
+	    arr.flags = 0;
+	    index = addr_incr > 0 ? addr : addr - (int)(num - 1);
+	    vpi_get_value_array(mitem, &arr, &index, num);
+
+	    for (idx = 0 ; idx < num ; idx += 1, ++cnt) {
+		  unsigned pos = addr_incr > 0 ? idx : num - 1 - idx;
+		  const s_vpi_vecval*vec = arr.value.vectors + pos*nval;
+
+		  if (cnt%16 == 0) fprintf(file, "// 0x%08x\n", cnt);
 
-	  if (cnt%16 == 0) fprintf(file, "// 0x%08x\n", cnt);
+		  if (mem_word_is_x(vec, wwid)) {
+			fputs(x_line, file);
+		  } else {
+			format_mem_word(buf, vec, wwid, hex_flag);
+			fprintf(file, "%s\n", buf);
+		  }
+	    }
 
-	  word_index = vpi_handle_by_index(mitem, addr);
-	  assert(word_index);
-	  vpi_get_value(word_index, &value);
-	  fprintf(file, "%s\n", value.value.str);
+	    addr += addr_incr * (int)num;
+	    remain -= num;
       }
 
+      free(x_line);
+      free(buf);
       fclose(file);
       free(fname);
       return 0;
@@ -608,6 +1287,15 @@ void sys_readmem_register(void)
       res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
 
+      tf_data.type      = vpiSysTask;
+      tf_data.tfname    = "$readmemraw";
+      tf_data.calltf    = sys_readmemraw_calltf;
+      tf_data.compiletf = sys_mem_compiletf;
+      tf_data.sizetf    = 0;
+      tf_data.user_data = "$readmemraw";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
       tf_data.type      = vpiSysTask;
       tf_data.tfname    = "$readmempath";
       tf_data.calltf    = sys_readmempath_calltf;
@@ -39,8 +39,10 @@ static struct t_vpi_time zero_delay = { vpiSimTime, 0, 0, 0.0 };
 /*
  * The vcd_list is the list of all the objects that are tracked for
  * dumping. The vcd_checkpoint goes through the list to dump the current
- * values for everything. When the item has a value change, it is added to the
- * vcd_dmp_list for dumping in the current time step.
+ * values for everything. The objects are also members of the
+ * vcd_change_set, which reports the objects that changed at the end of
+ * each time step, and the vcd_set_info array maps the member index
+ * back to the object.
  *
  * The vcd_const_list is a list of all of the parameters that are being
  * dumped. This list is scanned less often, since parameters do not change
@@ -49,9 +51,14 @@ static struct t_vpi_time zero_delay = { vpiSimTime, 0, 0, 0.0 };
 DECLARE_VCD_INFO(vcd_info, const char*);
 static struct vcd_info *vcd_const_list = NULL;
 static struct vcd_info *vcd_list = NULL;
-static struct vcd_info *vcd_dmp_list = NULL;
+static vpiHandle vcd_change_set = 0;
+static struct vcd_info **vcd_set_info = NULL;
+static unsigned vcd_set_count = 0;
 
 static PLI_UINT64 vcd_cur_time = 0;
+static const char*ring_arg = 0;
+static const char*ring_max_arg = 0;
+static int vcd_ring_flag = 0;
 static int dump_is_off = 0;
 static long dump_limit = 0;
 static int dump_is_full = 0;
@@ -103,6 +110,154 @@ static char *truncate_bitvec(char *s)
       }
 }
 
+/*
+ * Once the header is complete, the value changes are captured by the
+ * simulation and passed through the vcd_work queue to a writer thread
+ * that does all the formatting and writing of the dump file. The
+ * writer thread is not used when there is a $dumplimit, since the
+ * limit needs the exact size of the file at each value change, or
+ * when vcd_threads (from the +vcd+threads=N plusarg) is zero. The
+ * write_* functions do the formatting, and the emit_* functions send
+ * the work to the writer thread, or do it directly if there is none.
+ */
+static int vcd_threads = 1;
+static int vcd_writer_flag = 0;
+
+static void write_time(PLI_UINT64 now)
+{
+      fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now);
+}
+
+static void write_text(const char*text, const char*ident)
+{
+      fputs(text, dump_file);
+      if (ident) fputs(ident, dump_file);
+      fputc('\n', dump_file);
+}
+
+static void write_real(const char*ident, double val)
+{
+      fprintf(dump_file, "r%.16g %s\n", val, ident);
+}
+
+static void write_vec(const char*ident, unsigned wid, const s_vpi_vecval*vec)
+{
+      static const char bit_char[4] = { '0', '1', 'z', 'x' };
+      static char*buf = 0;
+      static unsigned buf_size = 0;
+      unsigned idx;
+
+      if (wid == 1) {
+	    fputc(bit_char[(vec->aval&1) | (vec->bval&1)<<1], dump_file);
+	    fputs(ident, dump_file);
+	    fputc('\n', dump_file);
+	    return;
+      }
+
+      if (wid >= buf_size) {
+	    buf_size = wid + 1;
+	    buf = realloc(buf, buf_size);
+      }
+
+      for (idx = 0 ; idx < wid ; idx += 1) {
+	    const s_vpi_vecval*cur = vec + idx/32;
+	    unsigned sh = idx%32;
+	    buf[wid-1-idx] = bit_char[((cur->aval>>sh)&1) | ((cur->bval>>sh)&1)<<1];
+      }
+      buf[wid] = 0;
+
+      fprintf(dump_file, "b%s %s\n", truncate_bitvec(buf), ident);
+}
+
+static void emit_time(PLI_UINT64 now)
+{
+      if (vcd_writer_flag)
+	    vcd_work_emit_time(now);
+      else
+	    write_time(now);
+}
+
+static void emit_text(const char*text, const char*ident)
+{
+      if (vcd_writer_flag)
+	    vcd_work_emit_text(text, ident);
+      else
+	    write_text(text, ident);
+}
+
+static void emit_real(const char*ident, double val)
+{
+      if (vcd_writer_flag)
+	    vcd_work_emit_real(ident, val);
+      else
+	    write_real(ident, val);
+}
+
+static void emit_vec(const char*ident, unsigned wid, const s_vpi_vecval*vec)
+{
+      if (vcd_writer_flag)
+	    vcd_work_emit_vec(ident, wid, vec);
+      else
+	    write_vec(ident, wid, vec);
+}
+
+static void* vcd_writer_thread(void*arg)
+{
+      int run_flag = 1;
+
+      (void)arg; /* Parameter is not used. */
+
+      while (run_flag) {
+	    struct vcd_work_item_s*cell = vcd_work_thread_peek();
+
+	    switch (cell->type) {
+		case WT_EMIT_TIME:
+		  write_time(cell->time);
+		  break;
+		case WT_EMIT_TEXT:
+		  write_text(cell->op_.val_text, cell->sym_.vcd);
+		  break;
+		case WT_EMIT_DOUBLE:
+		  write_real(cell->sym_.vcd, cell->op_.val_double);
+		  break;
+		case WT_EMIT_VEC:
+		  write_vec(cell->sym_.vcd, cell->wid, cell->wid <= 32
+			    ? &cell->op_.val_vec : cell->op_.val_vecp);
+		  break;
+		case WT_FLUSH:
+		  fflush(dump_file);
+		  break;
+		case WT_TERMINATE:
+		  fflush(dump_file);
+		  run_flag = 0;
+		  break;
+		default:
+		  break;
+	    }
+
+	    vcd_work_thread_pop();
+      }
+
+      return 0;
+}
+
+static void start_vcd_writer(void)
+{
+      if (vcd_writer_flag || vcd_threads == 0 || dump_limit > 0) return;
+
+      setvbuf(dump_file, 0, _IOFBF, 1024*1024);
+      vcd_work_start(vcd_writer_thread, 0);
+      vcd_writer_flag = 1;
+}
+
+static void stop_vcd_writer(void)
+{
+      if (! vcd_writer_flag) return;
+
+      vcd_work_terminate();
+      vcd_writer_flag = 0;
+}
+
 static void show_this_item(struct vcd_info*info)
 {
       s_vpi_value value;
@@ -111,23 +266,32 @@ static void show_this_item(struct vcd_info*info)
       if (type == vpiRealVar) {
 	    value.format = vpiRealVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "r%.16g %s\n", value.value.real, info->ident);
+	    emit_real(info->ident, value.value.real);
       } else if (type == vpiNamedEvent) {
-	    fprintf(dump_file, "1%s\n", info->ident);
-      } else if (type == vpiParameter && vpi_get(vpiConstType, info->item) == vpiRealConst) {
-
-	    value.format = vpiRealVal;
-	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "r%.16g %s\n", value.value.real, info->ident);
-      } else if (vpi_get(vpiSize, info->item) == 1) {
-	    value.format = vpiBinStrVal;
-	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "%s%s\n", value.value.str, info->ident);
+	    emit_text("1", info->ident);
+      } else if (type == vpiParameter) {
+	      /* Parameters are only shown with the header, before
+	       * there is a writer thread. */
+	    assert(! vcd_writer_flag);
+	    if (vpi_get(vpiConstType, info->item) == vpiRealConst) {
+		  value.format = vpiRealVal;
+		  vpi_get_value(info->item, &value);
+		  write_real(info->ident, value.value.real);
+	    } else if (vpi_get(vpiSize, info->item) == 1) {
+		  value.format = vpiBinStrVal;
+		  vpi_get_value(info->item, &value);
+		  fprintf(dump_file, "%s%s\n", value.value.str, info->ident);
+	    } else {
+		  value.format = vpiBinStrVal;
+		  vpi_get_value(info->item, &value);
+		  fprintf(dump_file, "b%s %s\n",
+			  truncate_bitvec(value.value.str), info->ident);
+	    }
       } else {
-	    value.format = vpiBinStrVal;
+	    value.format = vpiVectorVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "b%s %s\n", truncate_bitvec(value.value.str),
-		    info->ident);
+	    emit_vec(info->ident, vpi_get(vpiSize, info->item),
+		     value.value.vector);
       }
 }
 
@@ -138,13 +302,13 @@ static void show_this_item_x(struct vcd_info*info)
 
       if (type == vpiRealVar) {
 	      /* Some tools dump nothing here...? */
-	    fprintf(dump_file, "rNaN %s\n", info->ident);
+	    emit_text("rNaN ", info->ident);
       } else if (type == vpiNamedEvent) {
 	    /* Do nothing for named events. */
       } else if (vpi_get(vpiSize, info->item) == 1) {
-	    fprintf(dump_file, "x%s\n", info->ident);
+	    emit_text("x", info->ident);
       } else {
-	    fprintf(dump_file, "bx %s\n", info->ident);
+	    emit_text("bx ", info->ident);
       }
 }
 
@@ -164,38 +328,130 @@ __inline__ static int dump_header_pending(void)
 }
 
 
-static PLI_INT32 variable_cb_2(p_cb_data cause)
+/*
+ * In the flight recorder mode (+vcd+ring=<window>) the value changes
+ * go to the ring instead of the file. The ring is written out when
+ * the trigger is pulled or at a $dumpflush. The data of each ring slot
+ * is the vcd_info of the item.
+ */
+static int ring_flushed = 0;
+
+static const char*ring_ident(unsigned slot)
 {
-      struct vcd_info* info = vcd_dmp_list;
-      PLI_UINT64 now = timerec_to_time64(cause->time);
+      return ((struct vcd_info*)vcd_ring_item_data(slot))->ident;
+}
 
-      if (now != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now);
-	    vcd_cur_time = now;
-      }
+static void ring_show_start(uint64_t time)
+{
+      write_time(time);
+      vcd_cur_time = time;
+      write_text("$dumpvars", 0);
+}
 
-      do {
-           show_this_item(info);
-           info->scheduled = 0;
-      } while ((info = info->dmp_next) != 0);
+/*
+ * Some time steps were lost since the last flush, so show the dump as
+ * off from the first lost step until the start of this window.
+ */
+static void ring_show_gap(uint64_t off_time, uint64_t on_time)
+{
+      if (off_time != vcd_cur_time) write_time(off_time);
+      write_text("$dumpoff", 0);
+      ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item_x);
+      write_text("$end", 0);
 
-      vcd_dmp_list = 0;
+      if (on_time != off_time) write_time(on_time);
+      vcd_cur_time = on_time;
+      write_text("$dumpon", 0);
+}
 
-      return 0;
+static void ring_show_end(void)
+{
+      write_text("$end", 0);
 }
 
-static PLI_INT32 variable_cb_1(p_cb_data cause)
+static void ring_show_time(uint64_t time)
 {
-      struct t_cb_data cb;
-      struct vcd_info*info = (struct vcd_info*)cause->user_data;
+      if (time != vcd_cur_time) write_time(time);
+      vcd_cur_time = time;
+}
 
-      if (dump_is_full) return 0;
-      if (dump_is_off) return 0;
-      if (dump_header_pending()) return 0;
-      if (info->scheduled) return 0;
+static void ring_show_vec(unsigned slot, unsigned wid, const s_vpi_vecval*val)
+{
+      write_vec(ring_ident(slot), wid, val);
+}
+
+static void ring_show_real(unsigned slot, double val)
+{
+      if (val != val) write_text("rNaN ", ring_ident(slot));
+      else write_real(ring_ident(slot), val);
+}
+
+static void ring_show_event(unsigned slot)
+{
+      write_text("1", ring_ident(slot));
+}
+
+static const struct vcd_ring_fun_s ring_show_fun = {
+      ring_show_start, ring_show_gap, ring_show_end, ring_show_time,
+      ring_show_vec, ring_show_real, ring_show_event
+};
+
+static void ring_flush(void)
+{
+      vcd_ring_flush(&ring_show_fun);
+      ring_flushed = 1;
+      fflush(dump_file);
+}
+
+static void add_to_ring(struct vcd_info*info)
+{
+      info->slot = vcd_ring_add_item(info->item, info);
+}
+
+/*
+ * Start the ring with the values at the $dumpvars time as the slot
+ * values. The file so far only has the header.
+ */
+static void start_vcd_ring(void)
+{
+      if (! vcd_ring_start("VCD", "vcd", ring_arg, ring_max_arg,
+                           dumpvars_time, ring_flush))
+	    return;
+
+      vcd_ring_flag = 1;
+      ITERATE_VCD_INFO(vcd_list, vcd_info, next, add_to_ring);
+      vcd_ring_all_items(dump_is_off);
+}
+
+/*
+ * Value changes are only collected while they are being dumped. The
+ * change set still reports the changes it collected before it was
+ * disabled, so a $dumpoff in the middle of a time step does not lose
+ * the changes that came before it.
+ */
+static void update_change_set(void)
+{
+      if (vcd_change_set == 0) return;
+
+      vpip_change_set_enable(vcd_change_set, !dump_is_off && !dump_is_full
+                                             && !dump_header_pending());
+}
+
+static PLI_INT32 variable_changes_cb(p_vpip_change_set_data data)
+{
+      PLI_UINT64 now = timerec_to_time64(&data->time);
+      PLI_UINT32 idx;
+
+      if (vcd_ring_flag) {
+	    vcd_ring_set_time(now);
+	    for (idx = data->count ; idx > 0 ; idx -= 1)
+		  vcd_ring_item(vcd_set_info[data->index[idx-1]]->slot);
+	    return 0;
+      }
 
       if ((dump_limit > 0) && (ftell(dump_file) > dump_limit)) {
             dump_is_full = 1;
+            update_change_set();
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                                "exceeded.\n", dump_limit);
             fprintf(dump_file, "$comment Dump file limit (%ld bytes) "
@@ -203,21 +459,36 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
             return 0;
       }
 
-      if (!vcd_dmp_list) {
-          cb = *cause;
-	  cb.time = &zero_delay;
-          cb.reason = cbReadOnlySynch;
-          cb.cb_rtn = variable_cb_2;
-          vpi_register_cb(&cb);
+      if (now != vcd_cur_time) {
+	    emit_time(now);
+	    vcd_cur_time = now;
       }
 
-      info->scheduled = 1;
-      info->dmp_next  = vcd_dmp_list;
-      vcd_dmp_list    = info;
+	/* The items are dumped last changed first. */
+      for (idx = data->count ; idx > 0 ; idx -= 1)
+	    show_this_item(vcd_set_info[data->index[idx-1]]);
 
       return 0;
 }
 
+static void add_to_change_set(struct vcd_info*info)
+{
+      PLI_INT32 idx;
+
+      if (vcd_change_set == 0) {
+	    vcd_change_set = vpip_make_change_set(variable_changes_cb, 0);
+	    update_change_set();
+      }
+
+      idx = vpip_change_set_add(vcd_change_set, info->item);
+      if (idx < 0) return;
+
+      assert((unsigned)idx == vcd_set_count);
+      vcd_set_info = realloc(vcd_set_info,
+                             (vcd_set_count+1)*sizeof(struct vcd_info*));
+      vcd_set_info[vcd_set_count++] = info;
+}
+
 /*
  * This is called at the end of the timestep where the $dumpvars task is
  * called. This allows for values to settle for the timestep, so that the
@@ -228,6 +499,7 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      update_change_set();
 
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
@@ -239,12 +511,25 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
 	    fprintf(dump_file, "$dumpall\n");
 	    ITERATE_VCD_INFO(vcd_const_list, vcd_info, next, show_this_item);
 	    fprintf(dump_file, "$end\n");
+      }
+
+	/* In the flight recorder mode nothing more is written until
+	 * the ring is flushed. */
+      if (ring_arg) {
+	    start_vcd_ring();
+	    if (vcd_ring_flag) return 0;
+      }
 
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
+	/* The header is complete, so the rest of the file can be
+	 * written by the writer thread. */
+      start_vcd_writer();
 
-	    fprintf(dump_file, "$dumpvars\n");
+      if (!dump_is_off) {
+	    emit_time(dumpvars_time);
+
+	    emit_text("$dumpvars", 0);
 	    ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item);
-	    fprintf(dump_file, "$end\n");
+	    emit_text("$end", 0);
       }
 
       return 0;
@@ -260,12 +545,25 @@ static PLI_INT32 finish_cb(p_cb_data cause)
 
       dumpvars_time = timerec_to_time64(cause->time);
 
-      if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
+      if (vcd_ring_flag) {
+	    vcd_ring_finish();
+	    if (ring_flushed && dumpvars_time != vcd_cur_time)
+		  write_time(dumpvars_time);
+      } else if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
+	    emit_time(dumpvars_time);
       }
 
+      stop_vcd_writer();
       fclose(dump_file);
 
+      if (vcd_change_set) {
+	    vpip_remove_change_set(vcd_change_set);
+	    vcd_change_set = 0;
+      }
+      free(vcd_set_info);
+      vcd_set_info = 0;
+      vcd_set_count = 0;
+
       for (cur = vcd_list ;  cur ;  cur = next) {
 	    next = cur->next;
 	    free((char *)cur->ident);
@@ -326,6 +624,7 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_is_off) return 0;
 
       dump_is_off = 1;
+      update_change_set();
 
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
@@ -334,14 +633,20 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      if (vcd_ring_flag) {
+	    vcd_ring_set_time(now64);
+	    vcd_ring_all_items(1);
+	    return 0;
+      }
+
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    emit_time(now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpoff\n");
+      emit_text("$dumpoff", 0);
       ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item_x);
-      fprintf(dump_file, "$end\n");
+      emit_text("$end", 0);
 
       return 0;
 }
@@ -356,6 +661,7 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (!dump_is_off) return 0;
 
       dump_is_off = 0;
+      update_change_set();
 
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
@@ -364,14 +670,20 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      if (vcd_ring_flag) {
+	    vcd_ring_set_time(now64);
+	    vcd_ring_all_items(0);
+	    return 0;
+      }
+
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    emit_time(now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpon\n");
+      emit_text("$dumpon", 0);
       ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item);
-      fprintf(dump_file, "$end\n");
+      emit_text("$end", 0);
 
       return 0;
 }
@@ -386,19 +698,21 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_is_off) return 0;
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
+	/* The ring already holds all the values. */
+      if (vcd_ring_flag) return 0;
 
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    emit_time(now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpall\n");
+      emit_text("$dumpall", 0);
       ITERATE_VCD_INFO(vcd_list, vcd_info, next, show_this_item);
-      fprintf(dump_file, "$end\n");
+      emit_text("$end", 0);
 
       return 0;
 }
@@ -461,7 +775,16 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       (void)name; /* Parameter is not used. */
-      if (dump_file) fflush(dump_file);
+      if (dump_file == 0) return 0;
+
+      if (vcd_ring_flag) {
+	    vcd_ring_trigger();
+      } else if (vcd_writer_flag) {
+	    vcd_work_flush();
+	    vcd_work_sync();
+      } else {
+	    fflush(dump_file);
+      }
 
       return 0;
 }
@@ -479,6 +802,10 @@ static PLI_INT32 sys_dumplimit_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       vpi_get_value(vpi_scan(argv), &val);
       dump_limit = val.value.integer;
 
+	/* The limit is checked against the file as written so far, so
+	 * stop the writer thread and write the file directly. */
+      if (dump_limit > 0) stop_vcd_writer();
+
       vpi_free_object(argv);
       return 0;
 }
@@ -502,7 +829,6 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
             -1
       };
 
-      struct t_cb_data cb;
       struct vcd_info* info;
 
       const char *type;
@@ -633,26 +959,16 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 
 		  if (nexus_id) set_nexus_ident(nexus_id, ident);
 
-		    /* Add a callback for the signal. */
+		    /* Watch the signal for value changes. */
 		  info = malloc(sizeof(*info));
 
-		  info->time.type = vpiSimTime;
 		  info->item  = item;
 		  info->ident = ident;
-		  info->scheduled = 0;
-
-		  cb.time      = &info->time;
-		  cb.user_data = (char*)info;
-		  cb.value     = NULL;
-		  cb.obj       = item;
-		  cb.reason    = cbValueChange;
-		  cb.cb_rtn    = variable_cb_1;
-
-		  info->dmp_next = 0;
+		  info->cb    = NULL;
 		  info->next  = vcd_list;
 		  vcd_list    = info;
 
-		  info->cb    = vpi_register_cb(&cb);
+		  add_to_change_set(info);
 	    }
 
 	      /* Named events do not have a size, but other tools use
@@ -692,8 +1008,6 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	    info = malloc(sizeof(*info));
 	    info->item = item;
 	    info->ident = ident;
-	    info->scheduled = 0;
-	    info->dmp_next = 0;
 	    info->next = vcd_const_list;
 	    vcd_const_list = info;
 	    info->cb = NULL;
@@ -896,6 +1210,14 @@ void sys_vcd_register(void)
       for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
         if (strcmp(vlog_info.argv[idx],"-no-date") == 0) {
           dump_no_date = 1;
+        } else if (strncmp(vlog_info.argv[idx],"+vcd+threads=",13) == 0) {
+          vcd_threads = atoi(vlog_info.argv[idx]+13);
+        }
+        if (strncmp(vlog_info.argv[idx],"+vcd+ring=",10) == 0) {
+          ring_arg = vlog_info.argv[idx]+10;
+        }
+        if (strncmp(vlog_info.argv[idx],"+vcd+ring_max=",14) == 0) {
+          ring_max_arg = vlog_info.argv[idx]+14;
         }
       }
 
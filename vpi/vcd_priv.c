@@ -25,6 +25,8 @@
 #include  <string.h>
 #include  <assert.h>
 #include  <ctype.h>
+#include  <errno.h>
+#include  <stdint.h>
 #include  "stringheap.h"
 
 static const char* vcd_dump_path_default = "dump";
@@ -298,3 +300,242 @@ PLI_INT32 sys_dumpfile_common(const char*title, const char*suffix)
 
       return 0;
 }
+
+/*
+ * Convert the window argument of the +vcd+ring= and +fst+ring= flags
+ * to simulation ticks. The text is a number with an optional s, ms,
+ * us, ns, ps or fs unit. Without a unit the number is in ticks.
+ * Return 0 if the text is not a valid window.
+ */
+static int ring_parse_window(const char*text, uint64_t*window)
+{
+      static const char*units[] = { "s", "ms", "us", "ns", "ps", "fs" };
+      char*end;
+      unsigned long long val;
+      int prec, exp;
+      unsigned idx;
+
+      errno = 0;
+      val = strtoull(text, &end, 10);
+      if (end == text || val == 0 || errno == ERANGE) return 0;
+
+      if (*end == 0) {
+	    *window = val;
+	    return 1;
+      }
+
+      for (idx = 0 ; idx < sizeof(units)/sizeof(units[0]) ; idx += 1) {
+	    if (strcmp(end, units[idx]) == 0) break;
+      }
+      if (idx == sizeof(units)/sizeof(units[0])) return 0;
+
+	/* Scale the value from the unit to the simulation precision,
+	 * but always keep at least one tick. */
+      prec = vpi_get(vpiTimePrecision, 0);
+      for (exp = -3*(int)idx ; exp > prec ; exp -= 1) {
+	    if (val > UINT64_MAX/10) return 0;
+	    val *= 10;
+      }
+      for ( ; exp < prec ; exp += 1) val /= 10;
+      *window = val ? val : 1;
+      return 1;
+}
+
+/*
+ * Convert the size argument of the +vcd+ring_max= and +fst+ring_max=
+ * flags to bytes. The text is a number with an optional k, M or G
+ * suffix. Return 0 if the text is not a valid size.
+ */
+static int ring_parse_size(const char*text, uint64_t*size)
+{
+      char*end;
+      unsigned long long val;
+      unsigned shift = 0;
+
+      errno = 0;
+      val = strtoull(text, &end, 10);
+      if (end == text || val == 0 || errno == ERANGE) return 0;
+
+      switch (*end) {
+	  case 0:
+	    break;
+	  case 'k':
+	    shift = 10;
+	    break;
+	  case 'M':
+	    shift = 20;
+	    break;
+	  case 'G':
+	    shift = 30;
+	    break;
+	  default:
+	    return 0;
+      }
+      if (shift && end[1] != 0) return 0;
+      if (val > UINT64_MAX >> shift) return 0;
+
+      *size = val << shift;
+      return 1;
+}
+
+/*
+ * The ring_items array holds the item of each ring slot, with its
+ * type and the data pointer of the dumper.
+ */
+struct ring_item_s {
+      vpiHandle item;
+      PLI_INT32 type;
+      void*data;
+};
+
+static struct ring_item_s*ring_items = 0;
+static unsigned ring_item_count = 0;
+static void (*ring_flush_fun)(void) = 0;
+static int ring_flush_pending = 0;
+
+int vcd_ring_start(const char*title, const char*suffix,
+		   const char*window_arg, const char*max_arg,
+		   uint64_t now, void (*flush)(void))
+{
+      uint64_t window, max = 0;
+
+      if (! ring_parse_window(window_arg, &window)) {
+	    vpi_printf("%s warning: Invalid +%s+ring window (%s), "
+	               "dumping everything.\n", title, suffix, window_arg);
+	    return 0;
+      }
+
+      if (max_arg && ! ring_parse_size(max_arg, &max)) {
+	    vpi_printf("%s warning: Invalid +%s+ring_max size (%s), "
+	               "the ring size is not limited.\n", title, suffix,
+	               max_arg);
+	    max = 0;
+      }
+
+      vcd_ring_init(window, max, now);
+      ring_flush_fun = flush;
+      return 1;
+}
+
+unsigned vcd_ring_add_item(vpiHandle item, void*data)
+{
+      PLI_INT32 type = vpi_get(vpiType, item);
+      unsigned wid, slot;
+
+      if (type == vpiRealVar) wid = VCD_RING_REAL;
+      else if (type == vpiNamedEvent) wid = VCD_RING_EVENT;
+      else wid = vpi_get(vpiSize, item);
+
+      slot = vcd_ring_add_slot(wid);
+      assert(slot == ring_item_count);
+      ring_items = realloc(ring_items, (slot+1)*sizeof(struct ring_item_s));
+      ring_items[slot].item = item;
+      ring_items[slot].type = type;
+      ring_items[slot].data = data;
+      ring_item_count = slot + 1;
+      return slot;
+}
+
+void* vcd_ring_item_data(unsigned slot)
+{
+      assert(slot < ring_item_count);
+      return ring_items[slot].data;
+}
+
+void vcd_ring_item(unsigned slot)
+{
+      struct ring_item_s*cur = ring_items + slot;
+      s_vpi_value value;
+
+      if (cur->type == vpiRealVar) {
+	    value.format = vpiRealVal;
+	    vpi_get_value(cur->item, &value);
+	    vcd_ring_real(slot, value.value.real);
+      } else if (cur->type == vpiNamedEvent) {
+	    vcd_ring_event(slot);
+      } else {
+	    value.format = vpiVectorVal;
+	    vpi_get_value(cur->item, &value);
+	    vcd_ring_vec(slot, value.value.vector);
+      }
+}
+
+void vcd_ring_item_x(unsigned slot)
+{
+      static s_vpi_vecval*xvec = 0;
+      static unsigned xvec_words = 0;
+      struct ring_item_s*cur = ring_items + slot;
+
+      if (cur->type == vpiRealVar) {
+	    vcd_ring_real(slot, strtod("NaN", 0));
+      } else if (cur->type != vpiNamedEvent) {
+	    unsigned words = (vpi_get(vpiSize, cur->item) + 31) / 32;
+	    if (words > xvec_words) {
+		  xvec = realloc(xvec, words*sizeof(s_vpi_vecval));
+		  for ( ; xvec_words < words ; xvec_words += 1) {
+			xvec[xvec_words].aval = 0xffffffff;
+			xvec[xvec_words].bval = 0xffffffff;
+		  }
+	    }
+	    vcd_ring_vec(slot, xvec);
+      }
+}
+
+void vcd_ring_all_items(int x_flag)
+{
+      unsigned slot;
+
+      for (slot = 0 ; slot < ring_item_count ; slot += 1) {
+	    if (x_flag) vcd_ring_item_x(slot);
+	    else vcd_ring_item(slot);
+      }
+}
+
+static PLI_INT32 ring_trigger_cb(p_cb_data cause)
+{
+      (void)cause; /* Parameter is not used. */
+      if (ring_flush_pending) {
+	    ring_flush_pending = 0;
+	    ring_flush_fun();
+      }
+      return 0;
+}
+
+/*
+ * The trigger comes from a task in the middle of a time step, so
+ * write the ring when the next time step starts. The changes of this
+ * step are only passed to the dumper in its change set callback in
+ * the ReadOnlySync region, and that may be scheduled after a
+ * cbReadOnlySynch callback registered here, if the first change of
+ * the step comes after the trigger. If the simulation finishes first,
+ * vcd_ring_finish writes the ring instead.
+ */
+void vcd_ring_trigger(void)
+{
+      struct t_cb_data cb;
+      struct t_vpi_time zero_delay = { vpiSimTime, 0, 0, 0.0 };
+
+      if (ring_flush_fun == 0 || ring_flush_pending) return;
+      ring_flush_pending = 1;
+
+      cb.time = &zero_delay;
+      cb.reason = cbNextSimTime;
+      cb.cb_rtn = ring_trigger_cb;
+      cb.user_data = 0x0;
+      cb.obj = 0x0;
+      vpi_register_cb(&cb);
+}
+
+void vcd_ring_finish(void)
+{
+      if (ring_flush_pending) {
+	    ring_flush_pending = 0;
+	    ring_flush_fun();
+      }
+      ring_flush_fun = 0;
+
+      vcd_ring_delete();
+      free(ring_items);
+      ring_items = 0;
+      ring_item_count = 0;
+}
@@ -73,6 +73,9 @@ typedef enum vcd_work_item_type_e {
       WT_NONE,
       WT_EMIT_BITS,
       WT_EMIT_DOUBLE,
+      WT_EMIT_VEC,
+      WT_EMIT_TEXT,
+      WT_EMIT_TIME,
       WT_DUMPON,
       WT_DUMPOFF,
       WT_FLUSH,
@@ -81,16 +84,30 @@ typedef enum vcd_work_item_type_e {
 
 struct lxt2_wr_symbol;
 
+/*
+ * The VCD dumper items carry the identifier string in sym_.vcd, and
+ * the FST dumper items carry the fstHandle in sym_.fst. A
+ * WT_EMIT_VEC value with a width (wid) of 32 bits or less is kept in
+ * op_.val_vec, and wider values are in an allocated copy at
+ * op_.val_vecp. The op_.val_text of a WT_EMIT_TEXT is a constant
+ * string that is not freed.
+ */
 struct vcd_work_item_s {
       vcd_work_item_type_t type;
+      unsigned wid;
       uint64_t time;
       union {
 	    struct lxt2_wr_symbol*lxt2;
+	    const char*vcd;
+	    uint32_t fst;
       } sym_;
 
       union {
 	    double val_double;
 	    char*val_char;
+	    const char*val_text;
+	    struct t_vpi_vecval val_vec;
+	    struct t_vpi_vecval*val_vecp;
       } op_;
 };
 
@@ -128,6 +145,95 @@ EXTERN void vcd_work_dumpoff(void);
 EXTERN void vcd_work_emit_double(struct lxt2_wr_symbol*sym, double val);
 EXTERN void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char*bits);
 
+/*
+ * These vcd_work_* functions are used by the VCD dumper. The text
+ * must be a constant string, and the ident (if not nil) is written
+ * right after it.
+ */
+EXTERN void vcd_work_emit_time(uint64_t val);
+EXTERN void vcd_work_emit_text(const char*text, const char*ident);
+EXTERN void vcd_work_emit_real(const char*ident, double val);
+EXTERN void vcd_work_emit_vec(const char*ident, unsigned wid,
+			      const struct t_vpi_vecval*val);
+
+/*
+ * These vcd_work_* functions are used by the FST dumper. The value is
+ * sent to the variable with the given fstHandle.
+ */
+EXTERN void vcd_work_emit_fst_real(uint32_t handle, double val);
+EXTERN void vcd_work_emit_fst_vec(uint32_t handle, unsigned wid,
+				  const struct t_vpi_vecval*val);
+
+/*
+ * The ring keeps the value changes of the most recent window of
+ * simulation time in memory, for the flight recorder mode of the VCD
+ * and FST dumpers. Each dumped item gets a slot from vcd_ring_add_slot
+ * with its width, or VCD_RING_REAL or VCD_RING_EVENT. The values given
+ * before the first vcd_ring_set_time are the starting values of the
+ * slots. After that, vcd_ring_set_time starts each time step and the
+ * values are recorded as changes. Changes that fall out of the window,
+ * or that do not fit in the max bytes (if not 0), are folded into the
+ * slot values a time step at a time, so the slots always hold the
+ * values at the start of the window.
+ *
+ * vcd_ring_flush passes the window to the dumper through the
+ * vcd_ring_fun_s functions. The first flush calls start with the time
+ * of the window start, then passes the value of every slot and calls
+ * end. A later flush does the same, but with gap instead of start, if
+ * some time steps were folded since the last flush: the dump is off
+ * from the time of the first lost step to the window start. Then the
+ * recorded changes follow, with a time before each time step. The
+ * ring is then empty, and the next window starts where this one ended.
+ */
+#define VCD_RING_REAL  0
+#define VCD_RING_EVENT (~0U)
+
+struct vcd_ring_fun_s {
+      void (*start)(uint64_t time);
+      void (*gap)(uint64_t off_time, uint64_t on_time);
+      void (*end)(void);
+      void (*time)(uint64_t time);
+      void (*vec)(unsigned slot, unsigned wid, const struct t_vpi_vecval*val);
+      void (*real)(unsigned slot, double val);
+      void (*event)(unsigned slot);
+};
+
+EXTERN void vcd_ring_init(uint64_t window, uint64_t max, uint64_t now);
+EXTERN unsigned vcd_ring_add_slot(unsigned wid);
+EXTERN void vcd_ring_set_time(uint64_t now);
+EXTERN void vcd_ring_vec(unsigned slot, const struct t_vpi_vecval*val);
+EXTERN void vcd_ring_real(unsigned slot, double val);
+EXTERN void vcd_ring_event(unsigned slot);
+EXTERN void vcd_ring_flush(const struct vcd_ring_fun_s*fun);
+EXTERN void vcd_ring_delete(void);
+
+/*
+ * These are the parts of the flight recorder mode that the VCD and FST
+ * dumpers share. vcd_ring_start checks the +<suffix>+ring= window and
+ * the +<suffix>+ring_max= size arguments and starts the ring, or
+ * returns 0 if the window is not valid. The dumper then adds each item
+ * with vcd_ring_add_item, which returns its slot, and the data pointer
+ * can be fetched back with vcd_ring_item_data. vcd_ring_item records
+ * the current value of the item of a slot, vcd_ring_item_x records an
+ * x (NaN for a real), and vcd_ring_all_items does one or the other for
+ * all the slots.
+ *
+ * The flush function writes out the ring. vcd_ring_trigger (declared
+ * in sys_priv.h) calls it when the next time step starts, after the
+ * dumper has recorded the changes of the current one. vcd_ring_finish
+ * calls the flush function if the trigger was pulled but no later time
+ * step started, and deletes the ring.
+ */
+EXTERN int vcd_ring_start(const char*title, const char*suffix,
+			  const char*window_arg, const char*max_arg,
+			  uint64_t now, void (*flush)(void));
+EXTERN unsigned vcd_ring_add_item(vpiHandle item, void*data);
+EXTERN void* vcd_ring_item_data(unsigned slot);
+EXTERN void vcd_ring_item(unsigned slot);
+EXTERN void vcd_ring_item_x(unsigned slot);
+EXTERN void vcd_ring_all_items(int x_flag);
+EXTERN void vcd_ring_finish(void);
+
 /* The compiletf routines are common for the VCD, LXT and LXT2 dumpers. */
 EXTERN PLI_INT32 sys_dumpvars_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name);
 
@@ -158,6 +264,7 @@ EXTERN int dumpvars_status;
 	    struct vcd_info *next; \
 	    struct vcd_info *dmp_next; \
 	    int scheduled; \
+	    unsigned slot; \
 	    ident_type ident; \
       }
 
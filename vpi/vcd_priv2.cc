@@ -20,6 +20,8 @@
 # include  "vcd_priv.h"
 # include  <map>
 # include  <set>
+# include  <deque>
+# include  <vector>
 # include  <string>
 # include  <cstdlib>
 # include  <cstdint>
@@ -86,6 +88,299 @@ extern "C" void vcd_scope_names_delete(void)
       vcd_scope_names_set.clear();
 }
 
+/*
+ * The flight recorder ring. The ring_data holds the records of the
+ * window, oldest first. Each record starts with a word that has the
+ * record kind in the low 2 bits and the slot number above that. A
+ * time record is followed by the time in two words, a vector record
+ * by the aval and bval words of the value, and a real record by the
+ * two words of the double. An event record is just the one word. The
+ * ring_base holds the words of the slot values at the start of the
+ * window, at the offset of each slot.
+ *
+ * The ring_gap is set when a time step is folded into the slot values
+ * after the ring was last flushed, so its changes will never be
+ * written. The ring_gap_time is the time of the first such step.
+ */
+enum ring_kind_e { RING_TIME = 0, RING_VEC = 1, RING_REAL = 2, RING_EVENT = 3 };
+
+struct ring_slot_s {
+      unsigned wid;
+      size_t off;
+};
+
+static std::vector<ring_slot_s> ring_slots;
+static std::vector<uint32_t> ring_base;
+static std::deque<uint32_t> ring_data;
+static uint64_t ring_window = 0;
+static uint64_t ring_max = 0;
+static uint64_t ring_start = 0;
+static uint64_t ring_now = 0;
+static uint64_t ring_gap_time = 0;
+static bool ring_timed = false;
+static bool ring_step_open = false;
+static bool ring_flushed = false;
+static bool ring_gap = false;
+
+static inline unsigned ring_vec_words(unsigned wid)
+{
+      return 2 * ((wid + 31) / 32);
+}
+
+static inline unsigned ring_slot_words(const ring_slot_s&slot)
+{
+      if (slot.wid == VCD_RING_EVENT) return 0;
+      if (slot.wid == VCD_RING_REAL) return 2;
+      return ring_vec_words(slot.wid);
+}
+
+extern "C" void vcd_ring_init(uint64_t window, uint64_t max, uint64_t now)
+{
+      ring_window = window;
+      ring_max = max;
+      ring_start = now;
+      ring_now = now;
+      ring_timed = false;
+      ring_step_open = false;
+      ring_flushed = false;
+      ring_gap = false;
+}
+
+extern "C" unsigned vcd_ring_add_slot(unsigned wid)
+{
+      ring_slot_s slot;
+      slot.wid = wid;
+      slot.off = ring_base.size();
+      ring_slots.push_back(slot);
+
+	// Vectors start out as all x.
+      ring_base.resize(slot.off + ring_slot_words(slot),
+		       wid == VCD_RING_REAL? 0 : 0xffffffff);
+      return ring_slots.size() - 1;
+}
+
+/*
+ * Fold the record at the front of the ring into the slot values, and
+ * pop it from the ring.
+ */
+static void ring_fold_front(void)
+{
+      uint32_t head = ring_data.front();
+      ring_data.pop_front();
+
+      const ring_slot_s&slot = ring_slots[head >> 2];
+      switch (head & 3) {
+	  case RING_VEC:
+	  case RING_REAL:
+	    for (unsigned idx = 0 ; idx < ring_slot_words(slot) ; idx += 1) {
+		  ring_base[slot.off + idx] = ring_data.front();
+		  ring_data.pop_front();
+	    }
+	    break;
+	  default:
+	    break;
+      }
+}
+
+static inline uint64_t ring_front_time(void)
+{
+      assert((ring_data.front() & 3) == RING_TIME);
+      return (uint64_t)ring_data[1] | (uint64_t)ring_data[2] << 32;
+}
+
+/*
+ * Fold the oldest time step into the slot values, which become the
+ * values at the end of that step. Return the time of the step.
+ */
+static uint64_t ring_fold_step(void)
+{
+      uint64_t time = ring_front_time();
+      ring_data.erase(ring_data.begin(), ring_data.begin() + 3);
+      while (!ring_data.empty() && (ring_data.front() & 3) != RING_TIME)
+	    ring_fold_front();
+
+      if (! ring_gap) {
+	    ring_gap = true;
+	    ring_gap_time = time;
+      }
+      return time;
+}
+
+/*
+ * Fold the time steps that are no longer in the window.
+ */
+static void ring_evict(uint64_t start)
+{
+      if (start <= ring_start) return;
+      ring_start = start;
+
+      while (!ring_data.empty() && ring_front_time() <= start)
+	    ring_fold_step();
+}
+
+/*
+ * Fold the oldest time steps until the ring fits in the ring_max
+ * bytes. The window then starts at the last folded step.
+ */
+static void ring_evict_size(void)
+{
+      if (ring_max == 0) return;
+
+      while (!ring_data.empty() && ring_data.size()*sizeof(uint32_t) > ring_max) {
+	    uint64_t time = ring_fold_step();
+	    if (time > ring_start) ring_start = time;
+      }
+}
+
+extern "C" void vcd_ring_set_time(uint64_t now)
+{
+      if (ring_timed && ring_step_open && now == ring_now)
+	    return;
+
+      if (now > ring_window)
+	    ring_evict(now - ring_window);
+      ring_evict_size();
+
+      ring_data.push_back(RING_TIME);
+      ring_data.push_back((uint32_t)now);
+      ring_data.push_back((uint32_t)(now >> 32));
+      ring_now = now;
+      ring_timed = true;
+      ring_step_open = true;
+}
+
+extern "C" void vcd_ring_vec(unsigned slot, const struct t_vpi_vecval*val)
+{
+      const ring_slot_s&cur = ring_slots[slot];
+      unsigned words = ring_vec_words(cur.wid) / 2;
+      assert(cur.wid != VCD_RING_REAL && cur.wid != VCD_RING_EVENT);
+
+	// The last word of a vector keeps only the bits of the vector.
+      uint32_t mask = cur.wid % 32 ? (1U << cur.wid%32) - 1 : 0xffffffff;
+
+      if (! ring_timed) {
+	    for (unsigned idx = 0 ; idx < words ; idx += 1) {
+		  uint32_t use_mask = idx == words-1? mask : 0xffffffff;
+		  ring_base[cur.off + 2*idx + 0] = val[idx].aval & use_mask;
+		  ring_base[cur.off + 2*idx + 1] = val[idx].bval & use_mask;
+	    }
+	    return;
+      }
+
+      ring_data.push_back(slot << 2 | RING_VEC);
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    uint32_t use_mask = idx == words-1? mask : 0xffffffff;
+	    ring_data.push_back(val[idx].aval & use_mask);
+	    ring_data.push_back(val[idx].bval & use_mask);
+      }
+}
+
+extern "C" void vcd_ring_real(unsigned slot, double val)
+{
+      const ring_slot_s&cur = ring_slots[slot];
+      uint32_t words[2];
+      assert(cur.wid == VCD_RING_REAL);
+      memcpy(words, &val, sizeof words);
+
+      if (! ring_timed) {
+	    ring_base[cur.off + 0] = words[0];
+	    ring_base[cur.off + 1] = words[1];
+	    return;
+      }
+
+      ring_data.push_back(slot << 2 | RING_REAL);
+      ring_data.push_back(words[0]);
+      ring_data.push_back(words[1]);
+}
+
+extern "C" void vcd_ring_event(unsigned slot)
+{
+      assert(ring_slots[slot].wid == VCD_RING_EVENT);
+      if (! ring_timed) return;
+
+      ring_data.push_back(slot << 2 | RING_EVENT);
+}
+
+static void ring_show_slot(const struct vcd_ring_fun_s*fun, unsigned slot,
+			   const uint32_t*words)
+{
+      static std::vector<t_vpi_vecval> vec;
+      const ring_slot_s&cur = ring_slots[slot];
+
+      if (cur.wid == VCD_RING_REAL) {
+	    double val;
+	    memcpy(&val, words, sizeof val);
+	    fun->real(slot, val);
+	    return;
+      }
+
+      unsigned count = ring_vec_words(cur.wid) / 2;
+      vec.resize(count);
+      for (unsigned idx = 0 ; idx < count ; idx += 1) {
+	    vec[idx].aval = words[2*idx + 0];
+	    vec[idx].bval = words[2*idx + 1];
+      }
+      fun->vec(slot, cur.wid, &vec[0]);
+}
+
+extern "C" void vcd_ring_flush(const struct vcd_ring_fun_s*fun)
+{
+      std::vector<uint32_t> words;
+
+	// The dump already has the values at the start of the window,
+	// unless this is the first window or some steps were lost.
+      if (!ring_flushed || ring_gap) {
+	    if (ring_flushed)
+		  fun->gap(ring_gap_time, ring_start);
+	    else
+		  fun->start(ring_start);
+	    for (unsigned slot = 0 ; slot < ring_slots.size() ; slot += 1) {
+		  if (ring_slots[slot].wid == VCD_RING_EVENT) continue;
+		  ring_show_slot(fun, slot, &ring_base[ring_slots[slot].off]);
+	    }
+	    fun->end();
+      }
+
+      while (! ring_data.empty()) {
+	    uint32_t head = ring_data.front();
+	    unsigned slot = head >> 2;
+	    switch (head & 3) {
+		case RING_TIME:
+		  fun->time(ring_front_time());
+		  ring_data.erase(ring_data.begin(), ring_data.begin() + 3);
+		  break;
+		case RING_EVENT:
+		  fun->event(slot);
+		  ring_data.pop_front();
+		  break;
+		default:
+		  words.assign(ring_data.begin() + 1, ring_data.begin() + 1
+			       + ring_slot_words(ring_slots[slot]));
+		  ring_show_slot(fun, slot, &words[0]);
+		  ring_fold_front();
+		  break;
+	    }
+      }
+
+	// The next window starts after this one. A change later in the
+	// current time step goes in a new time record.
+      ring_start = ring_now;
+      ring_step_open = false;
+      ring_flushed = true;
+      ring_gap = false;
+}
+
+extern "C" void vcd_ring_delete(void)
+{
+      ring_slots.clear();
+      ring_base.clear();
+      ring_data.clear();
+      ring_timed = false;
+      ring_step_open = false;
+      ring_flushed = false;
+      ring_gap = false;
+}
+
 static std::thread work_thread;
 
 static const unsigned WORK_QUEUE_SIZE = 128*1024;
@@ -129,6 +424,8 @@ extern "C" void vcd_work_thread_pop(void)
       struct vcd_work_item_s*cell = work_queue + use_next;
       if (cell->type == WT_EMIT_BITS) {
 	    free(cell->op_.val_char);
+      } else if (cell->type == WT_EMIT_VEC && cell->wid > 32) {
+	    free(cell->op_.val_vecp);
       }
 
       use_next += 1;
@@ -274,6 +571,74 @@ extern "C" void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char* val)
       unlock_item();
 }
 
+extern "C" void vcd_work_emit_time(uint64_t val)
+{
+      work_queue_next_time = val;
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_TIME;
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_text(const char*text, const char*ident)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_TEXT;
+      cell->sym_.vcd = ident;
+      cell->op_.val_text = text;
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_real(const char*ident, double val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_DOUBLE;
+      cell->sym_.vcd = ident;
+      cell->op_.val_double = val;
+      unlock_item();
+}
+
+static void set_item_vec(struct vcd_work_item_s*cell, unsigned wid,
+			 const struct t_vpi_vecval*val)
+{
+      cell->type = WT_EMIT_VEC;
+      cell->wid = wid;
+      if (wid <= 32) {
+	    cell->op_.val_vec = val[0];
+      } else {
+	    size_t cnt = (wid + 31) / 32;
+	    cell->op_.val_vecp = (struct t_vpi_vecval*)
+		  malloc(cnt*sizeof(struct t_vpi_vecval));
+	    memcpy(cell->op_.val_vecp, val, cnt*sizeof(struct t_vpi_vecval));
+      }
+}
+
+extern "C" void vcd_work_emit_vec(const char*ident, unsigned wid,
+				  const struct t_vpi_vecval*val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->sym_.vcd = ident;
+      set_item_vec(cell, wid, val);
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_fst_real(uint32_t handle, double val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_DOUBLE;
+      cell->sym_.fst = handle;
+      cell->op_.val_double = val;
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_fst_vec(uint32_t handle, unsigned wid,
+				      const struct t_vpi_vecval*val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->sym_.fst = handle;
+      set_item_vec(cell, wid, val);
+      unlock_item();
+}
+
 extern "C" void vcd_work_terminate(void)
 {
       struct vcd_work_item_s*cell = grab_item();
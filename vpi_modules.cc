@@ -70,6 +70,8 @@ void        vpi_put_delays(vpiHandle, p_vpi_delay) { }
 
 void        vpi_get_value(vpiHandle, p_vpi_value) { }
 vpiHandle   vpi_put_value(vpiHandle, p_vpi_value, p_vpi_time, PLI_INT32) { return 0; }
+void        vpi_get_value_array(vpiHandle, p_vpi_arrayvalue, PLI_INT32*, PLI_UINT32) { }
+void        vpi_put_value_array(vpiHandle, p_vpi_arrayvalue, PLI_INT32*, PLI_UINT32) { }
 
 // time processing
 
@@ -131,6 +133,10 @@ char*       vpip_format_pretty(vpiHandle) { return strdup("invalid"); }
 void        vpip_make_systf_system_defined(vpiHandle) { }
 void        vpip_mcd_rawwrite(PLI_UINT32, const char*, size_t) { }
 void        vpip_set_return_value(int) { }
+vpiHandle   vpip_make_change_set(PLI_INT32 (*)(p_vpip_change_set_data), PLI_BYTE8*) { return 0; }
+PLI_INT32   vpip_change_set_add(vpiHandle, vpiHandle) { return -1; }
+void        vpip_change_set_enable(vpiHandle, int) { }
+void        vpip_remove_change_set(vpiHandle) { }
 PLI_INT32   vpi_vcontrol(PLI_INT32, va_list) { return 0; }
 
 
@@ -236,6 +242,12 @@ vpip_routines_s vpi_routines = {
     .make_systf_system_defined  = vpip_make_systf_system_defined,
     .mcd_rawwrite               = vpip_mcd_rawwrite,
     .set_return_value           = vpip_set_return_value,
+    .get_value_array            = vpi_get_value_array,
+    .put_value_array            = vpi_put_value_array,
+    .make_change_set            = vpip_make_change_set,
+    .change_set_add             = vpip_change_set_add,
+    .change_set_enable          = vpip_change_set_enable,
+    .remove_change_set          = vpip_remove_change_set,
 };
 
 typedef PLI_UINT32 (*vpip_set_callback_t)(vpip_routines_s*, PLI_UINT32);
@@ -130,7 +130,6 @@ typedef struct t_vpi_value {
       } value;
 } s_vpi_value, *p_vpi_value;
 
-
 /*
 
   Conform the IEEE 1364, We add the
@@ -671,6 +670,34 @@ extern void vpip_mcd_rawwrite(PLI_UINT32 mcd, const char*buf, size_t count);
 extern void vpip_count_drivers(vpiHandle ref, unsigned idx,
                                unsigned counts[4]);
 
+  /* A change set reports the value changes of a group of objects
+     once per time step, instead of with a cbValueChange callback for
+     every change. Make the set with vpip_make_change_set, and add
+     objects to it with vpip_change_set_add, which returns the index
+     of the new member (counting from 0) or -1 if the object cannot
+     be watched. At the end of each time step in which any member
+     changed, the cb_rtn is called once in the ReadOnlySync region
+     with the indices of the changed members, each listed once, in
+     the order of their first change. A set starts out enabled. While
+     it is disabled, changes are not recorded, but changes that were
+     already recorded in this time step are still reported. The
+     vpip_remove_change_set function removes the set and all its
+     members. The set handle has the object type _vpiChangeSet. */
+#define _vpiChangeSet 0x1000005
+typedef struct t_vpip_change_set_data {
+      vpiHandle set;
+      struct t_vpi_time time; /* vpiSimTime of the time step */
+      PLI_UINT32 count;
+      const PLI_UINT32*index;
+      PLI_BYTE8*user_data;
+} s_vpip_change_set_data, *p_vpip_change_set_data;
+
+extern vpiHandle vpip_make_change_set(PLI_INT32 (*cb_rtn)(p_vpip_change_set_data),
+                                      PLI_BYTE8*user_data);
+extern PLI_INT32 vpip_change_set_add(vpiHandle set, vpiHandle obj);
+extern void vpip_change_set_enable(vpiHandle set, int flag);
+extern void vpip_remove_change_set(vpiHandle set);
+
 /*
  * Stopgap fix for br916. We need to reject any attempt to pass a thread
  * variable to $strobe or $monitor. To do this, we use some private VPI
@@ -700,7 +727,10 @@ extern void vpip_count_drivers(vpiHandle ref, unsigned idx,
  */
 
 // Increment the version number any time vpip_routines_s is changed.
-static const PLI_UINT32 vpip_routines_version = 2;
+static const PLI_UINT32 vpip_routines_version = 4;
+
+// The array value routines are declared in sv_vpi_user.h.
+struct t_vpi_arrayvalue;
 
 typedef struct {
     vpiHandle   (*register_cb)(p_cb_data);
@@ -745,6 +775,12 @@ typedef struct {
     void        (*make_systf_system_defined)(vpiHandle);
     void        (*mcd_rawwrite)(PLI_UINT32, const char*, size_t);
     void        (*set_return_value)(int);
+    void        (*get_value_array)(vpiHandle, struct t_vpi_arrayvalue*, PLI_INT32*, PLI_UINT32);
+    void        (*put_value_array)(vpiHandle, struct t_vpi_arrayvalue*, PLI_INT32*, PLI_UINT32);
+    vpiHandle   (*make_change_set)(PLI_INT32 (*)(p_vpip_change_set_data), PLI_BYTE8*);
+    PLI_INT32   (*change_set_add)(vpiHandle, vpiHandle);
+    void        (*change_set_enable)(vpiHandle, int);
+    void        (*remove_change_set)(vpiHandle);
 } vpip_routines_s;
 
 extern DLLEXPORT PLI_UINT32 vpip_set_callback(vpip_routines_s*routines, PLI_UINT32 version);
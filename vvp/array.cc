@@ -32,6 +32,7 @@
 # include  <cstring>
 # include  <climits>
 # include  <iostream>
+# include  <vector>
 # include  "compile.h"
 # include  <cassert>
 # include  "ivl_alloc.h"
@@ -42,13 +43,16 @@ unsigned long count_net_arrays = 0;
 unsigned long count_net_array_words = 0;
 unsigned long count_var_arrays = 0;
 unsigned long count_var_array_words = 0;
+unsigned long count_sparse_arrays = 0;
+
+unsigned long array_sparse_words = 1UL << 20;
 unsigned long count_real_arrays = 0;
 unsigned long count_real_array_words = 0;
 
 static symbol_map_s<struct __vpiArray>* array_table =0;
 
 class vvp_fun_arrayport;
-static void array_attach_port(vvp_array_t, vvp_fun_arrayport*);
+static void array_attach_port(vvp_array_t, vvp_fun_arrayport*, bool);
 
 vvp_array_t array_find(const char*label)
 {
@@ -256,9 +260,7 @@ vpiHandle __vpiArray::get_iter_index(struct __vpiArrayIterator*, int idx)
 
       assert(vals4 || vals);
 
-      if (vals_words == 0) make_vals_words();
-
-      return &(vals_words[idx].as_word);
+      return &(get_vals_word(idx)->as_word);
 }
 
 int __vpiArray::vpi_get(int code)
@@ -324,10 +326,193 @@ vpiHandle __vpiArray::vpi_index(int index)
 	    return nets[index];
       }
 
-      if (vals_words == 0)
-	    make_vals_words();
+      return &(get_vals_word(index)->as_word);
+}
 
-      return &(vals_words[index].as_word);
+/*
+ * Get the canonical address of the first of the num words that an
+ * array value call selects, or return false if the words are not all
+ * in the array.
+ */
+static bool array_value_range(__vpiArray*arr, const char*fun,
+			      const PLI_INT32*index, unsigned num,
+			      unsigned long&base)
+{
+      long first = (long)index[0] - arr->first_addr.get_value();
+      if (first < 0 || (unsigned long)first + num > arr->get_size()) {
+	    fprintf(stderr, "VPI error: %s: words %ld through %ld are not "
+		    "all in array %s.\n", fun, (long)index[0],
+		    (long)index[0] + (long)num - 1,
+		    vpi_get_str(vpiFullName, arr));
+	    return false;
+      }
+
+      base = first;
+      return true;
+}
+
+/*
+ * Get a range of words of the array. The words of a vector4 array
+ * are copied directly out of the vals4 storage, without making a
+ * vvp_vector4_t for each word.
+ */
+void __vpiArray::vpi_get_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+				     unsigned num)
+{
+      unsigned long base;
+      if (! array_value_range(this, "vpi_get_value_array", index, num, base))
+	    return;
+
+      if (vpi_array_is_real(this)) {
+	    if (! vpip_array_value_check(arr, true))
+		  return;
+	    vpip_array_value_alloc(arr, 0, num);
+	    for (unsigned idx = 0 ; idx < num ; idx += 1) {
+		  double val = get_word_r(base + idx);
+		  if (arr->format == vpiRealVal)
+			arr->value.reals[idx] = val;
+		  else
+			arr->value.shortreals[idx] = val;
+	    }
+	    return;
+      }
+
+      if (vpi_array_is_string(this) || dynamic_cast<vvp_darray_object*>(vals)) {
+	    fprintf(stderr, "vpi sorry: vpi_get_value_array is not "
+		    "implemented for string or object arrays.\n");
+	    return;
+      }
+
+      if (! vpip_array_value_check(arr, false))
+	    return;
+
+      unsigned width = get_word_size();
+      vpip_array_value_alloc(arr, width, num);
+
+      const unsigned bpw = 8*sizeof(unsigned long);
+      unsigned cnt = (width + bpw - 1) / bpw;
+      std::vector<unsigned long> bits (2*cnt);
+
+      for (unsigned idx = 0 ; idx < num ; idx += 1) {
+	    if (vals4)
+		  vals4->get_word_bits(base + idx, &bits[0], &bits[cnt]);
+	    else
+		  vpip_vec4_to_bits(get_word(base + idx), &bits[0], &bits[cnt]);
+	    vpip_array_value_get(arr, idx, width, signed_flag,
+				 &bits[0], &bits[cnt]);
+      }
+}
+
+/*
+ * Put a range of words into the array. The words are all stored
+ * before the readers of the array are told, so that the read ports
+ * with a variable address are only checked once for the whole range.
+ * If the vpiPropagateOff flag is set, then the readers are not told
+ * at all. The words of a net array are driven one at a time.
+ */
+void __vpiArray::vpi_put_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+				     unsigned num)
+{
+      unsigned long base;
+      if (! array_value_range(this, "vpi_put_value_array", index, num, base))
+	    return;
+
+      bool one_flag = (arr->flags & vpiOneValue) != 0;
+
+      if (vpi_array_is_real(this)) {
+	    if (! vpip_array_value_check(arr, true))
+		  return;
+	    for (unsigned idx = 0 ; idx < num ; idx += 1) {
+		  unsigned src = one_flag? 0 : idx;
+		  double val = arr->format == vpiRealVal
+			     ? arr->value.reals[src]
+			     : arr->value.shortreals[src];
+		  if (nets) {
+			s_vpi_value tmp;
+			tmp.format = vpiRealVal;
+			tmp.value.real = val;
+			nets[base + idx]->vpi_put_value(&tmp, vpiNoDelay);
+		  } else {
+			vals->set_word(base + idx, val);
+		  }
+	    }
+	    if (nets)
+		  return;
+	    if (! (arr->flags & vpiPropagateOff))
+		  word_change(base, num);
+	    return;
+      }
+
+      if (vpi_array_is_string(this) || dynamic_cast<vvp_darray_object*>(vals)) {
+	    fprintf(stderr, "vpi sorry: vpi_put_value_array is not "
+		    "implemented for string or object arrays.\n");
+	    return;
+      }
+
+      if (! vpip_array_value_check(arr, false))
+	    return;
+
+      unsigned width = get_word_size();
+      const unsigned bpw = 8*sizeof(unsigned long);
+      unsigned cnt = (width + bpw - 1) / bpw;
+      std::vector<unsigned long> bits (2*cnt);
+
+	// The words of a net array are driven through their own
+	// handles, exactly as vpi_put_value on each word would.
+      if (nets) {
+	    std::vector<s_vpi_vecval> vec ((width + 31) / 32);
+	    s_vpi_arrayvalue tmp_arr;
+	    tmp_arr.format = vpiVectorVal;
+	    tmp_arr.flags = 0;
+	    tmp_arr.value.vectors = &vec[0];
+	    for (unsigned idx = 0 ; idx < num ; idx += 1) {
+		  vpip_array_value_put(arr, one_flag? 0 : idx, width,
+				       &bits[0], &bits[cnt]);
+		  vpip_array_value_get(&tmp_arr, 0, width, false,
+				       &bits[0], &bits[cnt]);
+		  s_vpi_value tmp;
+		  tmp.format = vpiVectorVal;
+		  tmp.value.vector = &vec[0];
+		  nets[base + idx]->vpi_put_value(&tmp, vpiNoDelay);
+	    }
+	    return;
+      }
+
+      for (unsigned idx = 0 ; idx < num ; idx += 1) {
+	    vpip_array_value_put(arr, one_flag? 0 : idx, width,
+				 &bits[0], &bits[cnt]);
+	    if (vals4) {
+		  vals4->set_word_bits(base + idx, &bits[0], &bits[cnt]);
+	    } else {
+		  vals->set_word(base + idx,
+				 vpip_bits_to_vec4(width, &bits[0], &bits[cnt]));
+	    }
+      }
+
+      if (! (arr->flags & vpiPropagateOff))
+	    word_change(base, num);
+}
+
+struct __vpiArrayWord*__vpiArray::get_vals_word(unsigned addr)
+{
+      if (word_pages == 0) {
+	    if (vals_words == 0)
+		  make_vals_words();
+	    return vals_words + addr;
+      }
+
+      const unsigned page_bits = vvp_vector4array_sparse::PAGE_BITS;
+      const unsigned page_words = vvp_vector4array_sparse::PAGE_WORDS;
+      struct __vpiArrayWord*&page = word_pages[addr >> page_bits];
+      if (page == 0) {
+	    unsigned long base = addr & ~(page_words-1);
+	    unsigned count = page_words;
+	    if (base + count > get_size())
+		  count = get_size() - base;
+	    page = array_make_words(this, base, count);
+      }
+
+      return page + (addr & (page_words-1));
 }
 
 int __vpiArrayWord::as_word_t::vpi_get(int code)
@@ -822,10 +1007,12 @@ vpiHandle vpip_make_array(const char*label, const char*name,
       obj->vals  = 0;
       obj->vals_width = 0;
       obj->vals_words = 0;
+      obj->word_pages = 0;
 
 	// Initialize (clear) the read-ports list.
       obj->ports_ = 0;
       obj->vpi_callbacks = 0;
+      obj->word_change_depth_ = 0;
 
 	/* Add this symbol to the array_symbols table for later lookup. */
       if (!array_table)
@@ -897,11 +1084,21 @@ void compile_var_array(char*label, char*name, int last, int first,
 
       struct __vpiArray*arr = dynamic_cast<__vpiArray*>(obj);
 
-	/* Make the words. */
+	/* Make the words. Very large memories are stored sparsely, so
+	   that only the parts that are written take up space. */
       arr->vals_width = labs(msb-lsb) + 1;
       if (vpip_peek_current_scope()->is_automatic()) {
             arr->vals4 = new vvp_vector4array_aa(arr->vals_width,
 						 arr->get_size());
+      } else if (array_sparse_words && arr->get_size() >= array_sparse_words) {
+            arr->vals4 = new vvp_vector4array_sparse(arr->vals_width,
+						     arr->get_size());
+	    unsigned npages = (arr->get_size() + vvp_vector4array_sparse::PAGE_WORDS-1)
+		  / vvp_vector4array_sparse::PAGE_WORDS;
+	    arr->word_pages = new struct __vpiArrayWord*[npages];
+	    for (unsigned idx = 0 ; idx < npages ; idx += 1)
+		  arr->word_pages[idx] = 0;
+	    count_sparse_arrays += 1;
       } else {
             arr->vals4 = new vvp_vector4array_sa(arr->vals_width,
 						 arr->get_size());
@@ -1031,27 +1228,37 @@ class vvp_fun_arrayport  : public vvp_net_fun_t {
       ~vvp_fun_arrayport() override;
 
       virtual void check_word_change(unsigned long addr) = 0;
+	// Check for a change to any of count words starting at base.
+      virtual void check_range_change(unsigned long base,
+				      unsigned long count) = 0;
 
     protected:
       vvp_array_t arr_;
       vvp_net_t  *net_;
       unsigned long addr_;
 
-      friend void array_attach_port(vvp_array_t, vvp_fun_arrayport*);
-      friend void __vpiArray::word_change(unsigned long);
+      friend void array_attach_port(vvp_array_t, vvp_fun_arrayport*, bool);
+      friend void __vpiArray::word_change(unsigned long, unsigned long);
+      friend void __vpiArray::word_change_(unsigned long, vvp_fun_arrayport*);
       vvp_fun_arrayport*next_;
+	// The ports of an array are checked in the reverse of the
+	// order that they were attached, and this number keeps that
+	// order across the lists that the ports are kept in.
+      unsigned long serial_;
 };
 
 vvp_fun_arrayport::vvp_fun_arrayport(vvp_array_t mem, vvp_net_t*net)
 : arr_(mem), net_(net), addr_(0)
 {
       next_ = 0;
+      serial_ = 0;
 }
 
 vvp_fun_arrayport::vvp_fun_arrayport(vvp_array_t mem, vvp_net_t*net, long addr)
 : arr_(mem), net_(net), addr_(addr)
 {
       next_ = 0;
+      serial_ = 0;
 }
 
 vvp_fun_arrayport::~vvp_fun_arrayport()
@@ -1066,6 +1273,7 @@ class vvp_fun_arrayport_sa  : public vvp_fun_arrayport {
       ~vvp_fun_arrayport_sa() override;
 
       void check_word_change(unsigned long addr) override;
+      void check_range_change(unsigned long base, unsigned long count) override;
 
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t) override;
@@ -1122,6 +1330,13 @@ void vvp_fun_arrayport_sa::check_word_change(unsigned long addr)
       }
 }
 
+void vvp_fun_arrayport_sa::check_range_change(unsigned long base,
+					      unsigned long count)
+{
+      if (addr_ >= base && addr_ - base < count)
+	    check_word_change(addr_);
+}
+
 class vvp_fun_arrayport_aa  : public vvp_fun_arrayport, public automatic_hooks_s {
 
     public:
@@ -1136,12 +1351,15 @@ class vvp_fun_arrayport_aa  : public vvp_fun_arrayport, public automatic_hooks_s
 #endif
 
       void check_word_change(unsigned long addr) override;
+      void check_range_change(unsigned long base, unsigned long count) override;
 
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t context) override;
 
     private:
       void check_word_change_(unsigned long addr, vvp_context_t context);
+      void check_range_change_(unsigned long base, unsigned long count,
+			       vvp_context_t context);
 
       __vpiScope*context_scope_;
       unsigned context_idx_;
@@ -1254,11 +1472,52 @@ void vvp_fun_arrayport_aa::check_word_change(unsigned long addr)
       }
 }
 
-static void array_attach_port(vvp_array_t array, vvp_fun_arrayport*fun)
+void vvp_fun_arrayport_aa::check_range_change_(unsigned long base,
+					       unsigned long count,
+					       vvp_context_t context)
+{
+      const unsigned long*port_addr = static_cast<unsigned long*>
+            (vvp_get_context_item(context, context_idx_));
+
+      if (*port_addr >= base && *port_addr - base < count)
+	    check_word_change_(*port_addr, context);
+}
+
+void vvp_fun_arrayport_aa::check_range_change(unsigned long base,
+					      unsigned long count)
 {
+      if (arr_->get_scope()->is_automatic()) {
+            assert(vthread_get_wt_context());
+            check_range_change_(base, count, vthread_get_wt_context());
+      } else {
+            vvp_context_t context = context_scope_->live_contexts;
+            while (context) {
+                  check_range_change_(base, count, context);
+                  context = vvp_get_next_context(context);
+            }
+      }
+}
+
+/*
+ * Attach the read port to the array. If the port has a constant
+ * address, then it only needs to be checked when that word changes,
+ * so it goes into the word_ports_ index instead of the ports_ list.
+ */
+static void array_attach_port(vvp_array_t array, vvp_fun_arrayport*fun,
+			      bool const_addr)
+{
+      static unsigned long port_serial = 0;
+
       assert(fun->next_ == 0);
-      fun->next_ = array->ports_;
-      array->ports_ = fun;
+      fun->serial_ = ++port_serial;
+      if (const_addr) {
+	    vvp_fun_arrayport*&head = array->word_ports_[fun->addr_];
+	    fun->next_ = head;
+	    head = fun;
+      } else {
+	    fun->next_ = array->ports_;
+	    array->ports_ = fun;
+      }
       if (!array->get_scope()->is_automatic() &&
           (array->vals4 || array->vals)) {
               /* propagate initial values for variable arrays */
@@ -1279,80 +1538,165 @@ static void array_attach_port(vvp_array_t array, vvp_fun_arrayport*fun)
 class array_word_value_callback : public value_callback {
     public:
       inline explicit array_word_value_callback(p_cb_data data, long addr)
-      : value_callback(data), word_addr(addr)
+      : value_callback(data), word_addr(addr), serial(++callback_serial)
       { }
 
     public:
       long word_addr;
+	// Like the read ports, the callbacks are run in the reverse of
+	// the order that they were added, across both lists.
+      unsigned long serial;
+
+    private:
+      static unsigned long callback_serial;
 };
 
+unsigned long array_word_value_callback::callback_serial = 0;
+
+/*
+ * Run a callback for a change to the word at addr. Return false if
+ * the callback has been removed, and so should be deleted.
+ */
+static bool array_word_callback(__vpiArray*arr, array_word_value_callback*cur,
+				unsigned long addr)
+{
+      if (cur->cb_data.cb_rtn == 0)
+	    return false;
+
+	// For whole array callbacks we need to set the index.
+      if (cur->word_addr == -1) {
+	    cur->cb_data.index = (PLI_INT32) ((int)addr +
+					      arr->first_addr.get_value());
+      }
+
+      if (cur->test_value_callback_ready()) {
+	    if (cur->cb_data.value) {
+		  if (vpi_array_is_real(arr)) {
+			double val = 0.0;
+			if (addr < arr->vals->get_size())
+			      arr->vals->get_word(addr, val);
+			vpip_real_get_value(val, cur->cb_data.value);
+		  } else if (arr->vals4) {
+			vpip_vec4_get_value(arr->vals4->get_word(addr),
+					    arr->vals_width,
+					    arr->signed_flag,
+					    cur->cb_data.value);
+		  } else if (dynamic_cast<vvp_darray_atom<int8_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<int16_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<int32_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<int64_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<uint8_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<uint16_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<uint32_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_atom<uint64_t>*>(arr->vals)
+			  || dynamic_cast<vvp_darray_vec2*>(arr->vals)) {
+			vvp_vector4_t val;
+			if (addr < arr->vals->get_size())
+			      arr->vals->get_word(addr, val);
+			vpip_vec4_get_value(val,
+					    arr->vals_width,
+					    arr->signed_flag,
+					    cur->cb_data.value);
+		  } else {
+			assert(0);
+		  }
+	    }
+
+	    callback_execute(cur);
+      }
+
+      return true;
+}
+
+/*
+ * A word of the array has changed. Only the read ports and callbacks
+ * that watch the word, or that have a variable address or watch the
+ * whole array, need to be looked at. The two sets are merged so that
+ * everything is still done in the reverse of the order it was added.
+ */
 void __vpiArray::word_change(unsigned long addr)
 {
-      for (vvp_fun_arrayport*cur = ports_; cur; cur = cur->next_)
-	    cur->check_word_change(addr);
+      word_change_(addr, ports_);
+}
 
-	// Run callbacks attached to the array itself.
-      struct __vpiCallback *next = vpi_callbacks;
-      struct __vpiCallback *prev = 0;
+/*
+ * A range of words has changed at once, for example by a
+ * vpi_put_value_array. Each read port with a variable address is
+ * checked once for the whole range, and the words are then only
+ * visited if there is something that watches single words or the
+ * whole array.
+ */
+void __vpiArray::word_change(unsigned long base, unsigned long count)
+{
+      for (vvp_fun_arrayport*cur = ports_ ; cur ; cur = cur->next_)
+	    cur->check_range_change(base, count);
 
-      while (next) {
-	    array_word_value_callback*cur = dynamic_cast<array_word_value_callback*>(next);
-	    next = cur->next;
+      if (word_ports_.empty() && word_callbacks_.empty() && vpi_callbacks == 0)
+	    return;
 
-	      // Skip callbacks that are not for me. -1 is for every element.
-	    if (cur->word_addr != (long)addr && cur->word_addr != -1) {
-		  prev = cur;
-		  continue;
-	    }
+      for (unsigned long addr = base ; addr < base+count ; addr += 1)
+	    word_change_(addr, 0);
+}
 
-	      // For whole array callbacks we need to set the index.
-	    if (cur->word_addr == -1) {
-		  cur->cb_data.index = (PLI_INT32) ((int)addr +
-						    first_addr.get_value());
+void __vpiArray::word_change_(unsigned long addr, vvp_fun_arrayport*ports)
+{
+      vvp_fun_arrayport*cur_port = ports;
+      vvp_fun_arrayport*word_port = 0;
+      if (! word_ports_.empty()) {
+	    std::unordered_map<unsigned long,vvp_fun_arrayport*>::const_iterator
+		  pos = word_ports_.find(addr);
+	    if (pos != word_ports_.end())
+		  word_port = pos->second;
+      }
+
+      while (cur_port || word_port) {
+	    if (word_port && (cur_port == 0 || word_port->serial_ > cur_port->serial_)) {
+		  word_port->check_word_change(addr);
+		  word_port = word_port->next_;
+	    } else {
+		  cur_port->check_word_change(addr);
+		  cur_port = cur_port->next_;
 	    }
+      }
 
-	    if (cur->cb_data.cb_rtn != 0) {
-		  if (cur->test_value_callback_ready()) {
-			if (cur->cb_data.value) {
-			      if (vpi_array_is_real(this)) {
-				    double val = 0.0;
-				    if (addr < vals->get_size())
-					  vals->get_word(addr, val);
-				    vpip_real_get_value(val, cur->cb_data.value);
-			      } else if (vals4) {
-				    vpip_vec4_get_value(vals4->get_word(addr),
-							vals_width,
-							signed_flag,
-							cur->cb_data.value);
-			      } else if (dynamic_cast<vvp_darray_atom<int8_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<int16_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<int32_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<int64_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<uint8_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<uint16_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<uint32_t>*>(vals)
-				      || dynamic_cast<vvp_darray_atom<uint64_t>*>(vals)
-				      || dynamic_cast<vvp_darray_vec2*>(vals)) {
-				    vvp_vector4_t val;
-				    if (addr < vals->get_size())
-					  vals->get_word(addr, val);
-				    vpip_vec4_get_value(val,
-							vals_width,
-							signed_flag,
-							cur->cb_data.value);
-			      } else {
-			            assert(0);
-			      }
-			}
-
-			callback_execute(cur);
-		  }
+	// Run callbacks attached to the array itself, and to the word.
+	// The removed callbacks are deleted only by the outermost call,
+	// so a callback that changes this array does not delete the
+	// callbacks under the feet of this loop. The callbacks run may
+	// also add callbacks, and these go to the front of the lists.
+      word_change_depth_ += 1;
+      struct __vpiCallback*whole_next = vpi_callbacks;
+      struct __vpiCallback*whole_prev = 0;
+      struct __vpiCallback*word_dummy = 0;
+      struct __vpiCallback**word_list = &word_dummy;
+      if (! word_callbacks_.empty()) {
+	    std::unordered_map<unsigned long,struct __vpiCallback*>::iterator
+		  pos = word_callbacks_.find(addr);
+	    if (pos != word_callbacks_.end())
+		  word_list = &pos->second;
+      }
+      struct __vpiCallback*word_next = *word_list;
+      struct __vpiCallback*word_prev = 0;
+
+      while (whole_next || word_next) {
+	    bool word_flag = word_next && (whole_next == 0 ||
+		 static_cast<array_word_value_callback*>(word_next)->serial >
+		 static_cast<array_word_value_callback*>(whole_next)->serial);
+	    struct __vpiCallback*&list = word_flag? *word_list : vpi_callbacks;
+	    struct __vpiCallback*&next = word_flag? word_next : whole_next;
+	    struct __vpiCallback*&prev = word_flag? word_prev : whole_prev;
+
+	    array_word_value_callback*cur = static_cast<array_word_value_callback*>(next);
+	    next = cur->next;
 
+	    if (array_word_callback(this, cur, addr) || word_change_depth_ > 1) {
 		  prev = cur;
 
 	    } else if (prev == 0) {
-
-		  vpi_callbacks = next;
+		  struct __vpiCallback**link = &list;
+		  while (*link != cur)
+			link = &(*link)->next;
+		  *link = next;
 		  cur->next = 0;
 		  delete cur;
 
@@ -1363,6 +1707,19 @@ void __vpiArray::word_change(unsigned long addr)
 		  delete cur;
 	    }
       }
+      word_change_depth_ -= 1;
+
+	// The callbacks removed with vpi_remove_cb are deleted here,
+	// so this is where the list of a word may become empty. Drop
+	// the entry then, so that the map only holds the words that
+	// have callbacks. The word is looked up again, as the map may
+	// have changed while the callbacks ran.
+      if (word_change_depth_ == 0 && ! word_callbacks_.empty()) {
+	    std::unordered_map<unsigned long,struct __vpiCallback*>::iterator
+		  pos = word_callbacks_.find(addr);
+	    if (pos != word_callbacks_.end() && pos->second == 0)
+		  word_callbacks_.erase(pos);
+      }
 }
 
 class array_resolv_list_t : public resolv_list_s {
@@ -1435,7 +1792,7 @@ bool array_port_resolv_list_t::resolve(bool mes)
                   fun = new vvp_fun_arrayport_sa(mem, ptr);
       ptr->fun = fun;
 
-      array_attach_port(mem, fun);
+      array_attach_port(mem, fun, use_addr);
 
       return true;
 }
@@ -1513,8 +1870,9 @@ value_callback*vpip_array_word_change(p_cb_data data)
 
       assert(cbh);
       assert(parent);
-      cbh->next = parent->vpi_callbacks;
-      parent->vpi_callbacks = cbh;
+      struct __vpiCallback*&list = parent->word_callbacks_[cbh->word_addr];
+      cbh->next = list;
+      list = cbh;
 
       return cbh;
 }
@@ -1580,9 +1938,11 @@ void compile_array_alias(char*label, char*name, char*src)
       obj->vals  = mem->vals;
       obj->vals_width = mem->vals_width;
       obj->vals_words = mem->vals_words;
+      obj->word_pages = mem->word_pages;
 
       obj->ports_ = 0;
       obj->vpi_callbacks = 0;
+      obj->word_change_depth_ = 0;
 
       assert(array_table);
       assert(!array_find(label));
@@ -1684,7 +2044,15 @@ void compile_array_cleanup(void)
 void memory_delete(vpiHandle item)
 {
       struct __vpiArray*arr = static_cast<struct __vpiArray*>(item);
-      if (arr->vals_words) delete [] (arr->vals_words-1);
+      if (arr->vals_words) array_delete_words(arr->vals_words);
+      if (arr->word_pages) {
+	    unsigned npages = (arr->get_size() + vvp_vector4array_sparse::PAGE_WORDS-1)
+		  / vvp_vector4array_sparse::PAGE_WORDS;
+	    for (unsigned idx = 0 ; idx < npages ; idx += 1)
+		  if (arr->word_pages[idx])
+			array_delete_words(arr->word_pages[idx]);
+	    delete[]arr->word_pages;
+      }
 
 //      if (arr->vals4) {}
 // Delete the individual words?
@@ -1721,6 +2089,15 @@ void memory_delete(vpiHandle item)
 	    delete arr->vpi_callbacks;
 	    arr->vpi_callbacks = tmp;
       }
+      for (std::unordered_map<unsigned long,struct __vpiCallback*>::iterator
+		 cur = arr->word_callbacks_.begin()
+		 ; cur != arr->word_callbacks_.end() ; ++ cur ) {
+	    while (cur->second) {
+		  struct __vpiCallback*tmp = cur->second->next;
+		  delete cur->second;
+		  cur->second = tmp;
+	    }
+      }
 
       delete arr;
 }
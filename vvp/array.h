@@ -31,6 +31,12 @@ class value_callback;
  */
 extern vvp_array_t array_find(const char*label);
 
+/*
+ * Variable arrays with at least this many words are stored sparsely.
+ * If this is 0, all arrays are stored in full.
+ */
+extern unsigned long array_sparse_words;
+
 /* VPI hooks */
 extern value_callback* vpip_array_word_change(p_cb_data data);
 extern value_callback* vpip_array_change(p_cb_data data);
@@ -60,7 +60,9 @@ struct __vpiArrayIndex : public __vpiHandle {
  * the memory) is calculated by subtracting word0 from the ArrayWord
  * pointer.
  *
- * To then get to the parent, use word0[-1].parent.
+ * To then get to the parent, use word0[-1].parent. The index of word0
+ * itself is in word0[-2].base. It is 0 unless the words are made a
+ * page at a time, as they are for sparse memories.
  *
  * The vpiArrayWord is also used as a handle for the index (vpiIndex)
  * for the word. To make that work, return the pointer to the as_index
@@ -86,13 +88,23 @@ struct __vpiArrayWord {
       union {
 	    struct __vpiArrayBase*parent;
 	    struct __vpiArrayWord*word0;
+	    unsigned long base;
       };
 
-      inline unsigned get_index() const { return this - word0; }
+      inline unsigned get_index() const { return (this - word0) + (word0 - 2)->base; }
       inline struct __vpiArrayBase*get_parent() const { return (word0 - 1)->parent; }
 };
 
 struct __vpiArrayWord*array_var_word_from_handle(vpiHandle ref);
+
+/*
+ * Make the word handles for count words of the parent, starting with
+ * the word at index base, and return a pointer to the first. Release
+ * them with array_delete_words().
+ */
+struct __vpiArrayWord*array_make_words(struct __vpiArrayBase*parent,
+				       unsigned long base, unsigned count);
+void array_delete_words(struct __vpiArrayWord*words);
 struct __vpiArrayWord*array_var_index_from_handle(vpiHandle ref);
 
 #endif /* ARRAY_COMMON_H */
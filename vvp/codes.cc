@@ -96,6 +96,55 @@ vvp_code_t codespace_null(void)
       return first_chunk + 0;
 }
 
+void codespace_specialize(void)
+{
+      for (vvp_code_t chunk = first_chunk ;  chunk ;
+	   chunk = chunk[code_chunk_size-1].cptr) {
+
+	    unsigned end = code_chunk_size - 1;
+	    if (chunk == current_chunk)
+		  end = current_within_chunk;
+
+	    for (unsigned idx = 0 ;  idx < end ;  idx += 1)
+		  vvp_code_specialize(chunk + idx);
+      }
+}
+
+void codespace_fuse(void)
+{
+      for (vvp_code_t chunk = first_chunk ;  chunk ;
+	   chunk = chunk[code_chunk_size-1].cptr) {
+
+	      /* Do not look at the CHUNK_LINK instruction, or at the
+		 unallocated tail of the last chunk. A sequence that
+		 crosses a chunk boundary is not fused. */
+	    unsigned end = code_chunk_size - 1;
+	    if (chunk == current_chunk)
+		  end = current_within_chunk;
+
+	    for (unsigned idx = 0 ;  idx < end ;  idx += 1) {
+		  vvp_code_t cp = chunk + idx;
+
+		  for (const struct vvp_fused_code_s*cur = vvp_fused_codes
+			     ; cur->count ;  cur += 1) {
+			if (idx + cur->count > end)
+			      continue;
+
+			unsigned cnt = 0;
+			while (cnt < cur->count
+			       && cp[cnt].opcode == cur->match[cnt])
+			      cnt += 1;
+			if (cnt < cur->count)
+			      continue;
+
+			cp->opcode = cur->opcode;
+			count_opcodes_fused += 1;
+			break;
+		  }
+	    }
+      }
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void codespace_delete(void)
 {
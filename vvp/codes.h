@@ -43,11 +43,15 @@ extern bool of_ASSIGN_ARD(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_ARE(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4D(vthread_t thr, vvp_code_t code);
+extern bool of_ASSIGN_VEC4D_W4(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4E(vthread_t thr, vvp_code_t code);
+extern bool of_ASSIGN_VEC4E_W4(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4_A_D(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4_A_E(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4_OFF_D(vthread_t thr, vvp_code_t code);
+extern bool of_ASSIGN_VEC4_OFF_D_W4(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_VEC4_OFF_E(vthread_t thr, vvp_code_t code);
+extern bool of_ASSIGN_VEC4_OFF_E_W4(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_WR(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_WRD(vthread_t thr, vvp_code_t code);
 extern bool of_ASSIGN_WRE(vthread_t thr, vvp_code_t code);
@@ -156,6 +160,8 @@ extern bool of_LOAD_OBJA(vthread_t thr, vvp_code_t code);
 extern bool of_LOAD_STR(vthread_t thr, vvp_code_t code);
 extern bool of_LOAD_STRA(vthread_t thr, vvp_code_t code);
 extern bool of_LOAD_VEC4(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_VEC4_SIG(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_VEC4_W4(vthread_t thr, vvp_code_t code);
 extern bool of_LOAD_VEC4A(vthread_t thr, vvp_code_t code);
 extern bool of_MAX_WR(vthread_t thr, vvp_code_t code);
 extern bool of_MIN_WR(vthread_t thr, vvp_code_t code);
@@ -315,6 +321,7 @@ extern bool of_STORE_REALA(vthread_t thr, vvp_code_t code);
 extern bool of_STORE_STR(vthread_t thr, vvp_code_t code);
 extern bool of_STORE_STRA(vthread_t thr, vvp_code_t code);
 extern bool of_STORE_VEC4(vthread_t thr, vvp_code_t code);
+extern bool of_STORE_VEC4_W4(vthread_t thr, vvp_code_t code);
 extern bool of_STORE_VEC4A(vthread_t thr, vvp_code_t code);
 extern bool of_SUB(vthread_t thr, vvp_code_t code);
 extern bool of_SUBI(vthread_t thr, vvp_code_t code);
@@ -362,9 +369,31 @@ struct vvp_code_s {
 	    vvp_net_t   *net2;
 	    vvp_code_t   cptr2;
 	    class ufunc_core*ufunc_core_ptr;
+	    class vvp_signal_value*sig;
       };
 };
 
+/*
+ * This table describes the superinstructions. Each entry lists the
+ * opcodes of an instruction sequence (count of them) and the fused
+ * opcode that executes the whole sequence. The table is terminated by
+ * an entry with a zero count.
+ */
+struct vvp_fused_code_s {
+      unsigned count;
+      vvp_code_fun match[3];
+      vvp_code_fun opcode;
+};
+
+extern const struct vvp_fused_code_s vvp_fused_codes[];
+
+/*
+ * Replace the opcode of the instruction with a variant that is
+ * specialized for the kind of signal it operates on, if there is
+ * one. This is implemented with the opcodes in vthread.cc.
+ */
+extern void vvp_code_specialize(vvp_code_t code);
+
 /*
  * This function clears the code space, ready for initialization. This
  * needs to be done exactly once before any instructions are created.
@@ -383,4 +412,17 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * Specialize all the instructions in the code space that operate on
+ * signals of a known kind. See vvp_code_specialize().
+ */
+extern void codespace_specialize(void);
+
+/*
+ * Replace the first instruction of common instruction sequences in
+ * the code space with the matching superinstruction. This is done
+ * once, after all the code has been compiled and linked.
+ */
+extern void codespace_fuse(void);
+
 #endif /* IVL_codes_H */
@@ -896,6 +896,20 @@ void compile_cleanup(void)
       compile_island_cleanup();
       compile_array_cleanup();
 
+	/* All the code is in place and the operands are resolved, so
+	   now is the time to specialize the instructions for the
+	   signals they use and to install the superinstructions. */
+      codespace_specialize();
+      codespace_fuse();
+
+	/* The netlist is also complete, so the gate engine can take
+	   its gates, and then the fan-out of the net outputs is
+	   flattened into arrays for faster propagation. The fan-out
+	   arrays refer to the functors, so the gate engine must
+	   replace its functors first. */
+      compile_gate_engine();
+      vvp_net_t::compile_fanout();
+
       if (verbose_flag) {
 	    fprintf(stderr, " ... Compiletf functions\n");
 	    fflush(stderr);
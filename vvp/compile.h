@@ -104,6 +104,12 @@ extern void compile_functor(char*label, char*type, unsigned width,
 			    unsigned ostr0, unsigned ostr1,
 			    unsigned argc, struct symb_s*argv);
 
+/*
+ * After compile, the gates that were passed to the gate engine are
+ * grouped into levelized clusters. See gate_engine.cc.
+ */
+extern void compile_gate_engine(void);
+
 
 /*
  * This is called by the parser to make a resolver. This is a special
@@ -20,6 +20,7 @@
 #include "delay.h"
 #include "schedule.h"
 #include "vpi_priv.h"
+#include "statistics.h"
 #include "config.h"
 #ifdef CHECK_WITH_VALGRIND
 #include "vvp_cleanup.h"
@@ -33,6 +34,9 @@
 
 using namespace std;
 
+bool inertial_delay_flag = false;
+unsigned long count_delay_pulses_rejected = 0;
+
 void vvp_delay_t::calculate_min_delay_()
 {
       min_delay_ = rise_;
@@ -154,6 +158,7 @@ vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
 : net_(n), delay_(d)
 {
       cur_real_ = 0.0;
+      pend_real_ = 0.0;
       if (width > 0) {
             cur_vec4_ = vvp_vector4_t(width, BIT4_X);
             cur_vec8_ = vvp_vector8_t(cur_vec4_, 6, 6);
@@ -239,6 +244,7 @@ void vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay)
 	    else
 		  list_->next = cur->next;
 	    delete cur;
+	    count_delay_pulses_rejected += 1;
       } while (list_);
 }
 
@@ -276,6 +282,12 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 	    return;
       }
 
+	/* In the inertial mode there is no event list, so a pending
+	   event that is due now goes out before the new value is
+	   considered. */
+      if (inertial_delay_flag)
+	    inertial_flush_();
+
       vvp_time64_t use_delay;
 	/* This is an initial value so it needs to be compared to all the
 	   bits (the order the bits are changed is not deterministic). */
@@ -313,6 +325,11 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 	    }
       }
 
+      if (inertial_delay_flag) {
+	    inertial_vec4_(use_delay, bit);
+	    return;
+      }
+
       /* what *should* happen here is we check to see if there is a
          transaction in the queue. This would be a pulse that needs to be
          eliminated. */
@@ -345,6 +362,9 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
 {
       assert(port.port() == 0);
 
+      if (inertial_delay_flag)
+	    inertial_flush_();
+
       vvp_time64_t use_delay;
 	/* This is an initial value so it needs to be compared to all the
 	   bits (the order the bits are changed is not deterministic). */
@@ -384,6 +404,11 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
 	    }
       }
 
+      if (inertial_delay_flag) {
+	    inertial_vec8_(use_delay, bit);
+	    return;
+      }
+
       /* what *should* happen here is we check to see if there is a
          transaction in the queue. This would be a pulse that needs to be
          eliminated. */
@@ -442,6 +467,9 @@ void vvp_fun_delay::recv_real(vvp_net_ptr_t port, double bit,
 	    return;
       }
 
+      if (inertial_delay_flag)
+	    inertial_flush_();
+
       if (initial_) {
 	    type_ = REAL_DELAY;
             cur_vec4_ = vvp_vector4_t(0, BIT4_X);
@@ -451,6 +479,11 @@ void vvp_fun_delay::recv_real(vvp_net_ptr_t port, double bit,
       vvp_time64_t use_delay;
       use_delay = delay_.get_min_delay();
 
+      if (inertial_delay_flag) {
+	    inertial_real_(use_delay, bit);
+	    return;
+      }
+
       /* Eliminate glitches. */
       if (clean_pulse_events_(use_delay, bit)) return;
 
@@ -477,6 +510,17 @@ void vvp_fun_delay::recv_real(vvp_net_ptr_t port, double bit,
 void vvp_fun_delay::run_run()
 {
       vvp_time64_t sim_time = schedule_simtime();
+      if (inertial_delay_flag) {
+	    slot_.woke(sim_time);
+	    if (slot_.pending && slot_.due > sim_time) {
+		  if (slot_.need_wakeup())
+			schedule_generic(this, slot_.due - sim_time, false);
+		  return;
+	    }
+	    inertial_flush_();
+	    return;
+      }
+
       if (list_ == 0 || list_->next->sim_time > sim_time)
 	    return;
 
@@ -507,6 +551,117 @@ void vvp_fun_delay::run_run_real_(const struct vvp_fun_delay::event_*cur)
       net_->send_real(cur_real_, 0);
 }
 
+/*
+ * Send the pending value of the inertial mode if it is due.
+ */
+void vvp_fun_delay::inertial_flush_()
+{
+      if (!slot_.pending || slot_.due > schedule_simtime())
+	    return;
+
+      slot_.pending = false;
+      initial_ = false;
+      switch (type_) {
+	  case VEC4_DELAY:
+	    cur_vec4_ = pend_vec4_;
+	    net_->send_vec4(cur_vec4_, 0);
+	    break;
+	  case VEC8_DELAY:
+	    cur_vec8_ = pend_vec8_;
+	    net_->send_vec8(cur_vec8_);
+	    break;
+	  case REAL_DELAY:
+	    cur_real_ = pend_real_;
+	    net_->send_real(cur_real_, 0);
+	    break;
+	  default:
+	    assert(0);
+	    break;
+      }
+}
+
+void vvp_fun_delay::inertial_arm_(vvp_time64_t use_delay)
+{
+      slot_.pending = true;
+      slot_.due = schedule_simtime() + use_delay;
+      if (slot_.need_wakeup())
+	    schedule_generic(this, use_delay, false);
+}
+
+/*
+ * A new value that matches the pending event leaves that event alone.
+ * Any other value rejects the pending pulse, and then either goes
+ * back to the current output (nothing more to do) or becomes the new
+ * pending event.
+ */
+void vvp_fun_delay::inertial_vec4_(vvp_time64_t use_delay,
+				   const vvp_vector4_t&bit)
+{
+      if (slot_.pending) {
+	    if (pend_vec4_.eeq(bit))
+		  return;
+	    slot_.pending = false;
+	    count_delay_pulses_rejected += 1;
+      }
+      if (!initial_ && cur_vec4_.eeq(bit))
+	    return;
+
+      if (use_delay == 0) {
+	    cur_vec4_ = bit;
+	    initial_ = false;
+	    net_->send_vec4(cur_vec4_, 0);
+	    return;
+      }
+
+      pend_vec4_ = bit;
+      inertial_arm_(use_delay);
+}
+
+void vvp_fun_delay::inertial_vec8_(vvp_time64_t use_delay,
+				   const vvp_vector8_t&bit)
+{
+      if (slot_.pending) {
+	    if (pend_vec8_.eeq(bit))
+		  return;
+	    slot_.pending = false;
+	    count_delay_pulses_rejected += 1;
+      }
+      if (!initial_ && cur_vec8_.eeq(bit))
+	    return;
+
+      if (use_delay == 0) {
+	    cur_vec8_ = bit;
+	    initial_ = false;
+	    net_->send_vec8(cur_vec8_);
+	    return;
+      }
+
+      pend_vec8_ = bit;
+      inertial_arm_(use_delay);
+}
+
+void vvp_fun_delay::inertial_real_(vvp_time64_t use_delay, double bit)
+{
+      if (slot_.pending) {
+	    if (pend_real_ == bit)
+		  return;
+	    slot_.pending = false;
+	    count_delay_pulses_rejected += 1;
+      }
+      if (cur_real_ == bit)
+	    return;
+
+      if (use_delay == 0) {
+	    cur_real_ = bit;
+	    initial_ = false;
+	    net_->send_real(cur_real_, 0);
+	    return;
+      }
+
+      pend_real_ = bit;
+      inertial_arm_(use_delay);
+}
+
 vvp_fun_modpath::vvp_fun_modpath(vvp_net_t*net, unsigned width)
 : net_(net), src_list_(0), ifnone_list_(0)
 {
@@ -562,8 +717,18 @@ void vvp_fun_modpath::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
       if (port.port() > 0)
 	    return;
 
-      if (cur_vec4_.eeq(bit))
+      if (inertial_delay_flag) {
+	    vvp_time64_t now = schedule_simtime();
+	    if (slot_.pending && slot_.due <= now) {
+		  slot_.pending = false;
+		  cur_vec4_ = pend_vec4_;
+		  net_->send_vec4(cur_vec4_, 0);
+	    }
+	    if ((slot_.pending? pend_vec4_ : cur_vec4_).eeq(bit))
+		  return;
+      } else if (cur_vec4_.eeq(bit)) {
 	    return;
+      }
 
 	/* Select a time delay source that applies. Notice that there
 	   may be multiple delay sources that apply, so collect all
@@ -611,6 +776,10 @@ void vvp_fun_modpath::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 	   conditional delays is incomplete, leaving some cases
 	   uncovered. In that case, just pass the data without delay */
       if (candidate_list.empty()) {
+	    if (inertial_delay_flag) {
+		  inertial_vec4_(0, bit);
+		  return;
+	    }
 	    cur_vec4_ = bit;
 	    schedule_generic(this, 0, false);
 	    return;
@@ -672,12 +841,51 @@ void vvp_fun_modpath::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
             }
       }
 
+      if (inertial_delay_flag) {
+	    inertial_vec4_(use_delay, bit);
+	    return;
+      }
+
       cur_vec4_ = bit;
       schedule_generic(this, use_delay, false);
 }
 
+/*
+ * In the inertial mode a new value rejects any pending pulse, and
+ * replaces it unless it returns to the current output.
+ */
+void vvp_fun_modpath::inertial_vec4_(vvp_time64_t use_delay,
+				     const vvp_vector4_t&bit)
+{
+      if (slot_.pending) {
+	    slot_.pending = false;
+	    count_delay_pulses_rejected += 1;
+      }
+      if (cur_vec4_.eeq(bit))
+	    return;
+
+      pend_vec4_ = bit;
+      slot_.pending = true;
+      slot_.due = schedule_simtime() + use_delay;
+      if (slot_.need_wakeup())
+	    schedule_generic(this, use_delay, false);
+}
+
 void vvp_fun_modpath::run_run()
 {
+      if (inertial_delay_flag) {
+	    vvp_time64_t now = schedule_simtime();
+	    slot_.woke(now);
+	    if (! slot_.pending)
+		  return;
+	    if (slot_.due > now) {
+		  if (slot_.need_wakeup())
+			schedule_generic(this, slot_.due - now, false);
+		  return;
+	    }
+	    slot_.pending = false;
+	    cur_vec4_ = pend_vec4_;
+      }
       net_->send_vec4(cur_vec4_, 0);
 }
 
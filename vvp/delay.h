@@ -59,6 +59,46 @@ class vvp_delay_t {
       void calculate_min_delay_();
 };
 
+/*
+ * When this flag is set, the delay and module path functors use the
+ * inertial delay mode: each functor keeps at most one pending output
+ * event, and a new input change updates that event in place instead
+ * of queuing another one.
+ */
+extern bool inertial_delay_flag;
+
+/*
+ * This tracks the single pending output event of a functor in the
+ * inertial delay mode. The owner keeps the pending value. The slot
+ * remembers when the value is due and the earliest wakeup that is
+ * already scheduled, so that moving the pending event later reuses
+ * that wakeup rather than scheduling another one.
+ */
+struct vvp_inertial_slot_s {
+      vvp_inertial_slot_s() : pending(false), armed(false), due(0), wake(0) { }
+
+	// Return true if a wakeup must be scheduled for the due time.
+      bool need_wakeup()
+      {
+	    if (armed && wake <= due)
+		  return false;
+	    armed = true;
+	    wake = due;
+	    return true;
+      }
+	// Called when a wakeup runs.
+      void woke(vvp_time64_t now)
+      {
+	    if (armed && wake <= now)
+		  armed = false;
+      }
+
+      bool pending;
+      bool armed;
+      vvp_time64_t due;
+      vvp_time64_t wake;
+};
+
 /* vvp_fun_delay
  * This is a lighter weight version of vvp_fun_drive, that only
  * carries delays. The output that it propagates is vvp_vector4_t so
@@ -111,6 +151,14 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
       void run_run_vec8_(const struct vvp_fun_delay::event_*cur);
       void run_run_real_(const struct vvp_fun_delay::event_*cur);
 
+	// The inertial delay mode replaces the event_ list with the
+	// slot_ and a pending value of the delay type.
+      void inertial_flush_();
+      void inertial_arm_(vvp_time64_t use_delay);
+      void inertial_vec4_(vvp_time64_t use_delay, const vvp_vector4_t&bit);
+      void inertial_vec8_(vvp_time64_t use_delay, const vvp_vector8_t&bit);
+      void inertial_real_(vvp_time64_t use_delay, double bit);
+
     private:
       vvp_net_t*net_;
       vvp_delay_t delay_;
@@ -122,6 +170,11 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
       double cur_real_;
       vvp_time64_t round_, scale_; // Needed to scale variable time values.
 
+      vvp_inertial_slot_s slot_;
+      vvp_vector4_t pend_vec4_;
+      vvp_vector8_t pend_vec8_;
+      double pend_real_;
+
       struct event_ *list_;
       void enqueue_(struct event_*cur)
       {
@@ -176,11 +229,16 @@ class vvp_fun_modpath  : public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       virtual void run_run() override;
+      void inertial_vec4_(vvp_time64_t use_delay, const vvp_vector4_t&bit);
 
     private:
       vvp_net_t*net_;
 
+	// In the inertial delay mode cur_vec4_ is the value last
+	// sent, and pend_vec4_ is the value of the pending event.
       vvp_vector4_t cur_vec4_;
+      vvp_inertial_slot_s slot_;
+      vvp_vector4_t pend_vec4_;
 
       vvp_fun_modpath_src*src_list_;
       vvp_fun_modpath_src*ifnone_list_;
@@ -0,0 +1,720 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "logic.h"
+# include  "compile.h"
+# include  "schedule.h"
+# include  "statistics.h"
+# include  <vector>
+# include  <queue>
+# include  <functional>
+# include  <algorithm>
+# include  <unordered_map>
+# include  <climits>
+# include  <cassert>
+
+using namespace std;
+
+/*
+ * The compiled gate engine takes over the connected clusters of
+ * scalar, zero delay, strong output AND/OR/XOR/BUF gates (and their
+ * inverted forms) of a gate level netlist. The gates of a cluster are
+ * levelized, and the outputs of the gates are kept as packed abits
+ * and bbits words, with the gates of a level in consecutive bits of a
+ * word. A gate reads its inputs from the outputs of the gates that
+ * drive it within the cluster, or from a leaf bit that holds the
+ * value last received from outside the cluster.
+ *
+ * Each gate keeps its vvp_net_t, but its functor is replaced with a
+ * vvp_fun_gate_cell that passes received values into the cluster. A
+ * change marks the consumer gates dirty and schedules the cluster,
+ * and when the cluster runs it evaluates the dirty gates a word at a
+ * time in level order, so all the dirty gates of a word are computed
+ * with a handful of word operations. Only outputs that have a filter
+ * (a .net) or fan-out outside the cluster are sent through the
+ * vvp_net_t. The cluster is therefore a single event however many of
+ * its gates change.
+ *
+ * Because a cluster settles in a single event, zero delay glitches
+ * inside it are not seen, which is why the engine is only used when
+ * asked for. Gates that are part of a combinational loop are left to
+ * the regular functors.
+ */
+
+bool gate_engine_flag = false;
+
+unsigned long count_gate_clusters = 0;
+unsigned long count_gate_cluster_gates = 0;
+unsigned long count_gate_cluster_runs = 0;
+
+static const unsigned GATE_WORD_BITS = 8 * sizeof(unsigned long);
+
+static inline unsigned gate_ctz_(unsigned long val)
+{
+#if defined(__GNUC__)
+      return __builtin_ctzl(val);
+#else
+      unsigned res = 0;
+      while ((val & 1) == 0) {
+	    val >>= 1;
+	    res += 1;
+      }
+      return res;
+#endif
+}
+
+class vvp_gate_cluster : private vvp_gen_event_s {
+
+    public:
+	// A word of gates. The first is the index of the gate in bit 0
+	// of the word, and the masks select the gates of each kind and
+	// the gates whose output net has a filter.
+      struct word_s {
+	    unsigned first;
+	    unsigned long kind[GATE_INVERT];
+	    unsigned long invert;
+	    unsigned long filtered;
+      };
+
+      vvp_gate_cluster(vector<word_s>&words, vector<unsigned>&pins,
+		       vector<vvp_net_t*>&nets, unsigned leaves);
+      ~vvp_gate_cluster() override;
+
+	// Set the input signal to the value, and schedule the cluster
+	// if that changes anything.
+      void set_input(unsigned sig, vvp_bit4_t val);
+
+    private:
+      void run_run() override;
+
+      unsigned node_(unsigned sig) const;
+      void mark_(unsigned sig);
+      void eval_word_(unsigned word, unsigned long mask);
+
+    private:
+      vector<word_s> words_;
+	// Four input signals for each gate.
+      vector<unsigned> pins_;
+	// The net to send the output of each gate through, or nil if
+	// nothing outside the cluster looks at it.
+      vector<vvp_net_t*> nets_;
+	// The gates that read each gate output and each leaf.
+      vector<unsigned> cons_first_;
+      vector<unsigned> cons_;
+
+	// The values of the gate outputs, followed by the leaves. These
+	// are the values that the gate inputs see.
+      vector<unsigned long> abits_;
+      vector<unsigned long> bbits_;
+	// The values that the gates drive. These are different from the
+	// values that are seen if the filter of the net changes them,
+	// for example while the net is forced.
+      vector<unsigned long> drv_abits_;
+      vector<unsigned long> drv_bbits_;
+      vector<unsigned long> dirty_;
+      priority_queue<unsigned, vector<unsigned>, greater<unsigned> > queue_;
+      bool scheduled_;
+      bool running_;
+};
+
+/*
+ * This is the functor that replaces each gate of a cluster.
+ */
+class vvp_fun_gate_cell : public vvp_net_fun_t {
+
+    public:
+      vvp_fun_gate_cell(vvp_gate_cluster*cluster, const unsigned*pins,
+			unsigned npins);
+      ~vvp_fun_gate_cell() override;
+
+      void recv_vec4(vvp_net_ptr_t p, const vvp_vector4_t&bit,
+                     vvp_context_t) override;
+      void recv_vec4_pv(vvp_net_ptr_t p, const vvp_vector4_t&bit,
+			unsigned base, unsigned vwid, vvp_context_t) override;
+      void recv_real(vvp_net_ptr_t p, double real,
+                     vvp_context_t ctx) override;
+
+    private:
+      vvp_gate_cluster*cluster_;
+      unsigned pins_[4];
+      unsigned npins_;
+};
+
+vvp_gate_cluster::vvp_gate_cluster(vector<word_s>&words, vector<unsigned>&pins,
+				   vector<vvp_net_t*>&nets, unsigned leaves)
+{
+      words_.swap(words);
+      pins_.swap(pins);
+      nets_.swap(nets);
+      scheduled_ = false;
+      running_ = false;
+
+      unsigned ngates = nets_.size();
+      unsigned nwords = words_.size()
+	    + (leaves + GATE_WORD_BITS - 1) / GATE_WORD_BITS;
+
+	// Everything starts out Z, as the inputs of the gates do.
+      abits_.assign(nwords, 0UL);
+      bbits_.assign(nwords, ~0UL);
+      drv_abits_.assign(words_.size(), 0UL);
+      drv_bbits_.assign(words_.size(), ~0UL);
+      dirty_.assign(words_.size(), 0UL);
+
+	// Make the consumer lists. The gate signals are numbered by
+	// word and bit, so find the gate number of each word bit.
+      cons_first_.assign(ngates + leaves + 1, 0);
+      for (unsigned idx = 0 ; idx < 4*ngates ; idx += 1)
+	    cons_first_[node_(pins_[idx]) + 1] += 1;
+      for (unsigned idx = 0 ; idx < ngates + leaves ; idx += 1)
+	    cons_first_[idx + 1] += cons_first_[idx];
+
+      vector<unsigned> fill (cons_first_.begin(), cons_first_.end() - 1);
+      cons_.resize(4*ngates);
+      for (unsigned wdx = 0 ; wdx < words_.size() ; wdx += 1) {
+	    unsigned end = (wdx+1 < words_.size())? words_[wdx+1].first : ngates;
+	    for (unsigned gate = words_[wdx].first ; gate < end ; gate += 1) {
+		  unsigned sig = wdx*GATE_WORD_BITS + gate - words_[wdx].first;
+		  for (unsigned pdx = 0 ; pdx < 4 ; pdx += 1)
+			cons_[fill[node_(pins_[4*gate + pdx])]++] = sig;
+	    }
+      }
+}
+
+vvp_gate_cluster::~vvp_gate_cluster()
+{
+}
+
+/*
+ * Signals are numbered by word and bit. The gate outputs come first,
+ * and the leaves follow in the words after the last gate word. The
+ * node number is the gate number, or the number of gates plus the
+ * leaf number.
+ */
+inline unsigned vvp_gate_cluster::node_(unsigned sig) const
+{
+      unsigned word = sig / GATE_WORD_BITS;
+      unsigned bit = sig % GATE_WORD_BITS;
+      if (word < words_.size())
+	    return words_[word].first + bit;
+
+      return nets_.size() + sig - words_.size()*GATE_WORD_BITS;
+}
+
+inline void vvp_gate_cluster::mark_(unsigned sig)
+{
+      unsigned word = sig / GATE_WORD_BITS;
+      if (dirty_[word] == 0)
+	    queue_.push(word);
+      dirty_[word] |= 1UL << (sig % GATE_WORD_BITS);
+}
+
+void vvp_gate_cluster::set_input(unsigned sig, vvp_bit4_t val)
+{
+      unsigned word = sig / GATE_WORD_BITS;
+      unsigned long mask = 1UL << (sig % GATE_WORD_BITS);
+      unsigned long abit = (val & 1)? mask : 0UL;
+      unsigned long bbit = (val & 2)? mask : 0UL;
+
+      if ((((abits_[word] ^ abit) | (bbits_[word] ^ bbit)) & mask) == 0)
+	    return;
+
+      abits_[word] = (abits_[word] & ~mask) | abit;
+      bbits_[word] = (bbits_[word] & ~mask) | bbit;
+
+      unsigned node = node_(sig);
+      for (unsigned idx = cons_first_[node] ; idx < cons_first_[node+1] ; idx += 1)
+	    mark_(cons_[idx]);
+
+      if (! (running_ || scheduled_)) {
+	    scheduled_ = true;
+	    schedule_functor(this);
+      }
+}
+
+void vvp_gate_cluster::run_run()
+{
+      scheduled_ = false;
+      running_ = true;
+      count_gate_cluster_runs += 1;
+
+	// Sending an output may mark more gates dirty, either later in
+	// this cluster or, through functors that pass values on at
+	// once, earlier. Keep going until there is nothing left.
+      while (! queue_.empty()) {
+	    unsigned word = queue_.top();
+	    queue_.pop();
+	    unsigned long mask = dirty_[word];
+	    dirty_[word] = 0;
+	    if (mask)
+		  eval_word_(word, mask);
+      }
+
+      running_ = false;
+}
+
+/*
+ * Evaluate the gates of the word that are selected by the mask. The
+ * inputs are gathered into a word for each pin, then the results for
+ * all the kinds of gates in the word are calculated with the same
+ * truth tables as the vvp_vector4_t operators and merged.
+ */
+void vvp_gate_cluster::eval_word_(unsigned word, unsigned long mask)
+{
+      const word_s&cur = words_[word];
+      unsigned long a[4] = { 0, 0, 0, 0 };
+      unsigned long b[4] = { 0, 0, 0, 0 };
+
+      for (unsigned long tmp = mask ; tmp ; tmp &= tmp - 1) {
+	    unsigned bit = gate_ctz_(tmp);
+	    const unsigned*pin = &pins_[4 * (cur.first + bit)];
+	    for (unsigned pdx = 0 ; pdx < 4 ; pdx += 1) {
+		  unsigned sw = pin[pdx] / GATE_WORD_BITS;
+		  unsigned sb = pin[pdx] % GATE_WORD_BITS;
+		  a[pdx] |= ((abits_[sw] >> sb) & 1UL) << bit;
+		  b[pdx] |= ((bbits_[sw] >> sb) & 1UL) << bit;
+	    }
+      }
+
+      unsigned long res_a = 0, res_b = 0;
+
+      if (unsigned long kind = cur.kind[GATE_AND] & mask) {
+	    unsigned long ra = a[0];
+	    unsigned long rb = b[0];
+	    for (unsigned pdx = 1 ; pdx < 4 ; pdx += 1) {
+		  unsigned long tmp1 = ra | rb;
+		  unsigned long tmp2 = a[pdx] | b[pdx];
+		  ra = tmp1 & tmp2;
+		  rb = (tmp1 & b[pdx]) | (tmp2 & rb);
+	    }
+	    res_a |= ra & kind;
+	    res_b |= rb & kind;
+      }
+
+      if (unsigned long kind = cur.kind[GATE_OR] & mask) {
+	    unsigned long ra = a[0];
+	    unsigned long rb = b[0];
+	    for (unsigned pdx = 1 ; pdx < 4 ; pdx += 1) {
+		  unsigned long tmp = ra | rb | a[pdx] | b[pdx];
+		  rb = ((~ra | rb) & b[pdx]) | ((~a[pdx] | b[pdx]) & rb);
+		  ra = tmp;
+	    }
+	    res_a |= ra & kind;
+	    res_b |= rb & kind;
+      }
+
+      if (unsigned long kind = cur.kind[GATE_XOR] & mask) {
+	    unsigned long ra = a[0];
+	    unsigned long rb = b[0];
+	    for (unsigned pdx = 1 ; pdx < 4 ; pdx += 1) {
+		  rb |= b[pdx];
+		  ra = (ra ^ a[pdx]) | rb;
+	    }
+	    res_a |= ra & kind;
+	    res_b |= rb & kind;
+      }
+
+      if (unsigned long kind = cur.kind[GATE_BUF] & mask) {
+	    res_a |= (a[0] | b[0]) & kind;
+	    res_b |= b[0] & kind;
+      }
+
+      if (unsigned long inv = cur.invert & mask)
+	    res_a = (res_a & ~inv) | ((~res_a | res_b) & inv);
+
+      unsigned long changed = ((res_a ^ drv_abits_[word])
+			       | (res_b ^ drv_bbits_[word])) & mask;
+      if (changed == 0)
+	    return;
+
+      drv_abits_[word] = (drv_abits_[word] & ~changed) | (res_a & changed);
+      drv_bbits_[word] = (drv_bbits_[word] & ~changed) | (res_b & changed);
+
+	// If the output net has a filter, what the consumers see is
+	// what the filter passes on, and that comes back through the
+	// functors of the consumers. Otherwise it is the driven value.
+      unsigned long direct = changed & ~cur.filtered;
+      abits_[word] = (abits_[word] & ~direct) | (res_a & direct);
+      bbits_[word] = (bbits_[word] & ~direct) | (res_b & direct);
+
+      for (unsigned long tmp = changed ; tmp ; tmp &= tmp - 1) {
+	    unsigned bit = gate_ctz_(tmp);
+	    unsigned gate = cur.first + bit;
+	    if (direct & (1UL << bit)) {
+		  for (unsigned idx = cons_first_[gate] ; idx < cons_first_[gate+1] ; idx += 1)
+			mark_(cons_[idx]);
+	    }
+
+	    if (vvp_net_t*net = nets_[gate]) {
+		  unsigned val = ((res_a >> bit) & 1UL) | (((res_b >> bit) & 1UL) << 1);
+		  net->send_vec4(vvp_vector4_t(1, (vvp_bit4_t)val), 0);
+	    }
+      }
+}
+
+vvp_fun_gate_cell::vvp_fun_gate_cell(vvp_gate_cluster*cluster,
+				     const unsigned*pins, unsigned npins)
+: cluster_(cluster), npins_(npins)
+{
+      for (unsigned idx = 0 ; idx < 4 ; idx += 1)
+	    pins_[idx] = pins[idx];
+}
+
+vvp_fun_gate_cell::~vvp_fun_gate_cell()
+{
+}
+
+void vvp_fun_gate_cell::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
+				  vvp_context_t)
+{
+      unsigned port = ptr.port();
+      if (port >= npins_ || bit.size() == 0)
+	    return;
+
+      cluster_->set_input(pins_[port], bit.value(0));
+}
+
+void vvp_fun_gate_cell::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
+				     unsigned base, unsigned vwid, vvp_context_t)
+{
+      assert(base + bit.size() <= vwid);
+      if (base != 0)
+	    return;
+
+      recv_vec4(ptr, bit, 0);
+}
+
+void vvp_fun_gate_cell::recv_real(vvp_net_ptr_t ptr, double real,
+				  vvp_context_t ctx)
+{
+      recv_vec4(ptr, double_to_vector4_LSB(real), ctx);
+}
+
+struct gate_candidate_s {
+      vvp_net_t*net;
+      unsigned kind;
+};
+
+struct gate_edge_s {
+      unsigned from, to, port;
+};
+
+static vector<gate_candidate_s> gate_candidates;
+static vector<vvp_gate_cluster*> gate_clusters;
+
+void gate_engine_add(vvp_net_t*net, unsigned kind)
+{
+      gate_candidate_s cur;
+      cur.net = net;
+      cur.kind = kind;
+      gate_candidates.push_back(cur);
+}
+
+static inline unsigned gate_npins(unsigned kind)
+{
+      return (kind & ~GATE_INVERT) == GATE_BUF? 1 : 4;
+}
+
+/*
+ * Give each gate that is not excluded its level, the length of the
+ * longest chain of gates that leads to it. The gates that are left
+ * without a level are on or after a loop.
+ */
+static void gate_levelize(const vector<gate_edge_s>&edges,
+			  const vector<unsigned>&succ_first,
+			  const vector<unsigned>&succ,
+			  const vector<bool>&exclude,
+			  vector<unsigned>&level)
+{
+      unsigned ngates = gate_candidates.size();
+      vector<unsigned> indeg (ngates, 0);
+      for (size_t idx = 0 ; idx < edges.size() ; idx += 1) {
+	    if (! exclude[edges[idx].from])
+		  indeg[edges[idx].to] += 1;
+      }
+
+      level.assign(ngates, UINT_MAX);
+      vector<unsigned> work;
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1) {
+	    if (indeg[idx] == 0 && ! exclude[idx]) {
+		  level[idx] = 0;
+		  work.push_back(idx);
+	    }
+      }
+
+      for (size_t pos = 0 ; pos < work.size() ; pos += 1) {
+	    unsigned gate = work[pos];
+	    for (unsigned idx = succ_first[gate] ; idx < succ_first[gate+1] ; idx += 1) {
+		  const gate_edge_s&edge = edges[succ[idx]];
+		  if (exclude[edge.to])
+			continue;
+		  unsigned lev = level[gate] + 1;
+		  if (level[edge.to] == UINT_MAX || level[edge.to] < lev)
+			level[edge.to] = lev;
+		  indeg[edge.to] -= 1;
+		  if (indeg[edge.to] == 0)
+			work.push_back(edge.to);
+	    }
+      }
+
+	// Gates that still have inputs from unvisited gates are not
+	// done yet, even if they picked up a level on the way.
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1) {
+	    if (indeg[idx] != 0)
+		  level[idx] = UINT_MAX;
+      }
+}
+
+static unsigned gate_find(vector<unsigned>&parent, unsigned idx)
+{
+      while (parent[idx] != idx) {
+	    parent[idx] = parent[parent[idx]];
+	    idx = parent[idx];
+      }
+      return idx;
+}
+
+void compile_gate_engine(void)
+{
+      unsigned ngates = gate_candidates.size();
+      if (ngates == 0)
+	    return;
+
+      unordered_map<vvp_net_t*,unsigned> gate_map;
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1)
+	    gate_map[gate_candidates[idx].net] = idx;
+
+	// Find the connections from gate outputs to gate inputs. Any
+	// other fan-out is outside the engine.
+      vector<gate_edge_s> edges;
+      vector<bool> outside (ngates, false);
+      vector<unsigned> succ_first (ngates+1, 0);
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1) {
+	    vvp_net_t*net = gate_candidates[idx].net;
+	    for (vvp_net_ptr_t cur = net->out_ ; cur.ptr()
+		       ; cur = cur.ptr()->port[cur.port()]) {
+		  if (cur.ptr()->fun == 0)
+			continue;
+		  unordered_map<vvp_net_t*,unsigned>::const_iterator to
+			= gate_map.find(cur.ptr());
+		  if (to == gate_map.end()
+		      || cur.port() >= gate_npins(gate_candidates[to->second].kind)) {
+			outside[idx] = true;
+			continue;
+		  }
+		  gate_edge_s edge;
+		  edge.from = idx;
+		  edge.to = to->second;
+		  edge.port = cur.port();
+		  edges.push_back(edge);
+		  succ_first[idx+1] += 1;
+	    }
+      }
+      gate_map.clear();
+
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1)
+	    succ_first[idx+1] += succ_first[idx];
+      vector<unsigned> succ (edges.size());
+      for (size_t idx = 0 ; idx < edges.size() ; idx += 1)
+	    succ[idx] = idx;
+
+	// Levelize, then take away the gates that have no level and
+	// only lead to other gates without a level. What is left are
+	// the gates on loops, and the engine leaves them out.
+      vector<bool> exclude (ngates, false);
+      vector<unsigned> level;
+      gate_levelize(edges, succ_first, succ, exclude, level);
+
+      vector<unsigned> outdeg (ngates, 0);
+      for (size_t idx = 0 ; idx < edges.size() ; idx += 1) {
+	    if (level[edges[idx].from] == UINT_MAX && level[edges[idx].to] == UINT_MAX)
+		  outdeg[edges[idx].from] += 1;
+      }
+      vector<unsigned> pred_first (ngates+1, 0);
+      for (size_t idx = 0 ; idx < edges.size() ; idx += 1)
+	    pred_first[edges[idx].to + 1] += 1;
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1)
+	    pred_first[idx+1] += pred_first[idx];
+      vector<unsigned> pred (edges.size());
+      {
+	    vector<unsigned> fill (pred_first.begin(), pred_first.end() - 1);
+	    for (size_t idx = 0 ; idx < edges.size() ; idx += 1)
+		  pred[fill[edges[idx].to]++] = idx;
+      }
+
+      vector<unsigned> work;
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1) {
+	    if (level[idx] == UINT_MAX) {
+		  exclude[idx] = true;
+		  if (outdeg[idx] == 0)
+			work.push_back(idx);
+	    }
+      }
+      for (size_t pos = 0 ; pos < work.size() ; pos += 1) {
+	    unsigned gate = work[pos];
+	    exclude[gate] = false;
+	    for (unsigned idx = pred_first[gate] ; idx < pred_first[gate+1] ; idx += 1) {
+		  unsigned from = edges[pred[idx]].from;
+		  if (level[from] != UINT_MAX)
+			continue;
+		  outdeg[from] -= 1;
+		  if (outdeg[from] == 0)
+			work.push_back(from);
+	    }
+      }
+      vector<unsigned>().swap(outdeg);
+      vector<unsigned>().swap(pred);
+      vector<unsigned>().swap(pred_first);
+      vector<unsigned>().swap(work);
+
+      gate_levelize(edges, succ_first, succ, exclude, level);
+
+	// The connected groups of gates are the clusters.
+      vector<unsigned> parent (ngates);
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1)
+	    parent[idx] = idx;
+      for (size_t idx = 0 ; idx < edges.size() ; idx += 1) {
+	    if (exclude[edges[idx].from] || exclude[edges[idx].to])
+		  continue;
+	    unsigned from = gate_find(parent, edges[idx].from);
+	    unsigned to = gate_find(parent, edges[idx].to);
+	    if (from != to)
+		  parent[from] = to;
+      }
+
+      vector<unsigned> order;
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1) {
+	    if (! exclude[idx])
+		  order.push_back(idx);
+      }
+      vector<unsigned> root (ngates);
+      for (unsigned idx = 0 ; idx < ngates ; idx += 1)
+	    root[idx] = gate_find(parent, idx);
+      vector<unsigned>().swap(parent);
+
+      sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+	    if (root[a] != root[b]) return root[a] < root[b];
+	    if (level[a] != level[b]) return level[a] < level[b];
+	    return a < b;
+      });
+
+	// The signal that each gate drives, or UINT_MAX if the gate is
+	// not taken by the engine.
+      vector<unsigned> signal (ngates, UINT_MAX);
+
+      for (size_t start = 0 ; start < order.size() ; ) {
+	    size_t end = start + 1;
+	    while (end < order.size() && root[order[end]] == root[order[start]])
+		  end += 1;
+
+	      // A gate on its own is better left as it is.
+	    if (end - start < 2) {
+		  start = end;
+		  continue;
+	    }
+
+	    vector<vvp_gate_cluster::word_s> words;
+	    vector<vvp_net_t*> nets;
+	    for (size_t idx = start ; idx < end ; idx += 1) {
+		  unsigned gate = order[idx];
+		  if (words.empty() || level[gate] != level[order[idx-1]]
+		      || idx - start - words.back().first == GATE_WORD_BITS) {
+			vvp_gate_cluster::word_s tmp;
+			tmp.first = idx - start;
+			for (unsigned kdx = 0 ; kdx < GATE_INVERT ; kdx += 1)
+			      tmp.kind[kdx] = 0;
+			tmp.invert = 0;
+			tmp.filtered = 0;
+			words.push_back(tmp);
+		  }
+
+		  vvp_gate_cluster::word_s&cur = words.back();
+		  unsigned bit = idx - start - cur.first;
+		  unsigned kind = gate_candidates[gate].kind;
+		  cur.kind[kind & ~GATE_INVERT] |= 1UL << bit;
+		  if (kind & GATE_INVERT)
+			cur.invert |= 1UL << bit;
+
+		  signal[gate] = (words.size()-1) * GATE_WORD_BITS + bit;
+
+		  vvp_net_t*net = gate_candidates[gate].net;
+		  if (net->fil)
+			cur.filtered |= 1UL << bit;
+		  nets.push_back((net->fil || outside[gate])? net : 0);
+	    }
+
+	    unsigned count = end - start;
+	    vector<unsigned> pins (4*count, UINT_MAX);
+	    for (size_t idx = start ; idx < end ; idx += 1) {
+		  unsigned gate = order[idx];
+		  for (unsigned edx = succ_first[gate] ; edx < succ_first[gate+1] ; edx += 1) {
+			const gate_edge_s&edge = edges[succ[edx]];
+			if (signal[edge.to] == UINT_MAX)
+			      continue;
+			  // The gates are numbered in order, so the
+			  // position of the consumer is found from its
+			  // signal.
+			unsigned word = signal[edge.to] / GATE_WORD_BITS;
+			unsigned pos = words[word].first + signal[edge.to] % GATE_WORD_BITS;
+			pins[4*pos + edge.port] = signal[gate];
+		  }
+	    }
+
+	      // Everything else that can reach an input of a gate gets
+	      // a leaf of its own. The unused pins of the BUF and NOT
+	      // gates just repeat the first pin.
+	    unsigned leaves = 0;
+	    unsigned leaf_base = words.size() * GATE_WORD_BITS;
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  unsigned npins = gate_npins(gate_candidates[order[start+idx]].kind);
+		  for (unsigned pdx = 0 ; pdx < npins ; pdx += 1) {
+			if (pins[4*idx + pdx] == UINT_MAX)
+			      pins[4*idx + pdx] = leaf_base + leaves++;
+		  }
+		  for (unsigned pdx = npins ; pdx < 4 ; pdx += 1)
+			pins[4*idx + pdx] = pins[4*idx];
+	    }
+
+	    vector<unsigned> cell_pins (pins);
+	    vvp_gate_cluster*cluster = new vvp_gate_cluster(words, pins, nets, leaves);
+	    gate_clusters.push_back(cluster);
+
+	      // The old functors are in the permanent heap, so they are
+	      // simply abandoned.
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  gate_candidate_s&cur = gate_candidates[order[start+idx]];
+		  cur.net->fun = new vvp_fun_gate_cell(cluster, &cell_pins[4*idx],
+						       gate_npins(cur.kind));
+	    }
+
+	    count_gate_clusters += 1;
+	    count_gate_cluster_gates += count;
+	    start = end;
+      }
+
+      vector<gate_candidate_s>().swap(gate_candidates);
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void gate_engine_delete(void)
+{
+      for (size_t idx = 0 ; idx < gate_clusters.size() ; idx += 1)
+	    delete gate_clusters[idx];
+      gate_clusters.clear();
+}
+#endif
@@ -22,17 +22,30 @@
 # include  "symbols.h"
 # include  "schedule.h"
 # include  <list>
+# include  <vector>
+# include  <algorithm>
 
 # include  <iostream>
 
 using namespace std;
 
+struct vvp_island_branch_tran;
+
 class vvp_island_tran : public vvp_island {
 
     public:
       void run_island() override;
       void count_drivers(vvp_island_port*port, unsigned bit_idx,
                          unsigned counts[3]) override;
+
+    private:
+	// The work lists of run_island(). They are kept with the
+	// island and cleared for each run so that their storage is
+	// not allocated again every time the island runs.
+      vector<vvp_island_port*> changed_;
+      vector<vvp_island_port*> seeds_;
+      vector<vvp_island_branch_tran*> work_branches_;
+      vector<vvp_island_port*> work_ports_;
 };
 
 enum tran_state_t {
@@ -52,9 +65,12 @@ struct vvp_island_branch_tran : public vvp_island_branch {
       void run_output();
 
       vvp_net_t*en;
+      vvp_island_port*en_port;
       unsigned width, part, offset;
       bool active_high, resistive;
       tran_state_t state;
+	// True if the branch is in the list of branches to run.
+      bool active;
 };
 
 vvp_island_branch_tran::vvp_island_branch_tran(vvp_net_t*en__,
@@ -63,58 +79,134 @@ vvp_island_branch_tran::vvp_island_branch_tran(vvp_net_t*en__,
                                                unsigned part__,
                                                unsigned offset__,
                                                bool resistive__)
-: en(en__), width(width__), part(part__), offset(offset__),
-  active_high(active_high__), resistive(resistive__)
+: en(en__), en_port(en__? island_port(en__) : 0),
+  width(width__), part(part__), offset(offset__),
+  active_high(active_high__), resistive(resistive__), active(false)
 {
       state = en__ ? tran_disabled : tran_enabled;
 }
 
+/*
+ * A tran island only ever has tran branches in it, so there is no
+ * need to check the type of the branch.
+ */
 static inline vvp_island_branch_tran* BRANCH_TRAN(vvp_island_branch*tmp)
 {
-      vvp_island_branch_tran*res = dynamic_cast<vvp_island_branch_tran*>(tmp);
-      assert(res);
-      return res;
+      return static_cast<vvp_island_branch_tran*>(tmp);
+}
+
+/*
+ * Collect into work_branches and work_ports the parts of the mesh
+ * that are reachable from the seed ports through branches that are
+ * not disabled. These are the only ports whose resolved values can
+ * be affected by the changes to the seed ports. The branches are
+ * sorted into the order of the branches_ list, so that the branches
+ * are resolved and their values sent in the same order as they would
+ * be if the entire island were run.
+ */
+static void collect_work(vector<vvp_island_port*>&seeds,
+			 vector<vvp_island_branch_tran*>&work_branches,
+			 vector<vvp_island_port*>&work_ports)
+{
+      work_branches.clear();
+      work_ports.clear();
+
+      while (! seeds.empty()) {
+	    vvp_island_port*port = seeds.back();
+	    seeds.pop_back();
+	    if (port->active || port->node.nil())
+		  continue;
+
+	    port->active = true;
+	    work_ports.push_back(port);
+
+	    vvp_branch_ptr_t cur = port->node;
+	    vvp_branch_ptr_t idx = cur;
+	    do {
+		  vvp_island_branch_tran*tmp = BRANCH_TRAN(idx.ptr());
+		  if (! tmp->active) {
+			tmp->active = true;
+			work_branches.push_back(tmp);
+		  }
+		  if (tmp->state != tran_disabled) {
+			vvp_island_port*other = tmp->ports[idx.port()^1];
+			if (! other->active)
+			      seeds.push_back(other);
+		  }
+	    } while ((idx = next(idx)) != cur);
+      }
+
+      sort(work_branches.begin(), work_branches.end(),
+	   [](const vvp_island_branch_tran*l, const vvp_island_branch_tran*r)
+	   { return l->order > r->order; });
 }
 
 /*
  * The run_island() method is called by the scheduler to run the
- * entire island. We run the island by calling run_resolution() for
- * all the branches in the island.
+ * island. We run the island by calling run_resolution() for all the
+ * branches in the parts of the mesh that the changed ports reach.
+ * The rest of the island cannot have changed, so there is no need to
+ * resolve it again.
 */
 void vvp_island_tran::run_island()
 {
-	// Test to see if any of the branches are enabled. This loop
-	// tests the enabled inputs for all the branches and caches
-	// the results in the state for each branch.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_test_enabled();
+      changed_.clear();
+      changed_.swap(changed_ports_);
+
+	// Test to see if any of the branches controlled by the changed
+	// ports are enabled. The states are cached in the branches. A
+	// branch that changes state may join or split parts of the
+	// mesh, so both of its ends need to be resolved again.
+      for (size_t idx = 0 ; idx < changed_.size() ; idx += 1) {
+	    vvp_island_port*port = changed_[idx];
+	    port->changed = false;
+	    seeds_.push_back(port);
+	    for (size_t cdx = 0 ; cdx < port->controls.size() ; cdx += 1) {
+		  vvp_island_branch_tran*tmp = BRANCH_TRAN(port->controls[cdx]);
+		  tran_state_t old_state = tmp->state;
+		  tmp->run_test_enabled();
+		  if (tmp->state != old_state) {
+			seeds_.push_back(tmp->ports[0]);
+			seeds_.push_back(tmp->ports[1]);
+		  }
+	    }
       }
 
 rerun:
-	// Now resolve all the branches in the island.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_resolution();
-      }
+      collect_work(seeds_, work_branches_, work_ports_);
+
+	// Now resolve the branches.
+      for (size_t idx = 0 ; idx < work_branches_.size() ; idx += 1)
+	    work_branches_[idx]->run_resolution();
 
 	// Now output the resolved values.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_output();
+      for (size_t idx = 0 ; idx < work_branches_.size() ; idx += 1) {
+	    work_branches_[idx]->run_output();
+	    work_branches_[idx]->active = false;
       }
 
-	// Now check if the enable inputs have been affected by the resolution.
-      bool enable_changed = false;
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    enable_changed |= tmp->rerun_test_enabled();
+	// Now check if the enable inputs have been affected by the
+	// resolution. Only the ports that were resolved can have
+	// new output values.
+      for (size_t idx = 0 ; idx < work_ports_.size() ; idx += 1) {
+	    vvp_island_port*port = work_ports_[idx];
+	    port->active = false;
+	    for (size_t cdx = 0 ; cdx < port->controls.size() ; cdx += 1) {
+		  vvp_island_branch_tran*tmp = BRANCH_TRAN(port->controls[cdx]);
+		  if (tmp->rerun_test_enabled()) {
+			seeds_.push_back(tmp->ports[0]);
+			seeds_.push_back(tmp->ports[1]);
+		  }
+	    }
+      }
+      if (! seeds_.empty()) {
+	      // Ports that changed while the values were being sent
+	      // are picked up by the rerun as well. They stay on the
+	      // changed list so that the next run tests the branches
+	      // that they control.
+	    seeds_.insert(seeds_.end(), changed_ports_.begin(), changed_ports_.end());
+	    goto rerun;
       }
-      if (enable_changed) goto rerun;
 }
 
 static void count_drivers_(vvp_branch_ptr_t cur, bool other_side_visited,
@@ -172,31 +264,16 @@ static void count_drivers_(vvp_branch_ptr_t cur, bool other_side_visited,
 void vvp_island_tran::count_drivers(vvp_island_port*port, unsigned bit_idx,
                                     unsigned counts[3])
 {
-        // First we need to find a branch that is attached to the specified
-        // port. Unfortunately there's no quick way to do this.
-      vvp_island_branch*branch = branches_;
-      unsigned side = 0;
-      while (branch) {
-            if (branch->a->fun == port) {
-                  side = 0;
-                  break;
-            }
-            if (branch->b->fun == port) {
-                  side = 1;
-                  break;
-            }
-            branch = branch->next_branch;
-      }
-      assert(branch);
+        // The port keeps a branch endpoint that is attached to it.
+      assert(! port->node.nil());
 
         // Now count the drivers, pushing through the network as necessary.
-      vvp_branch_ptr_t endpoint(branch, side);
-      count_drivers_(endpoint, false, bit_idx, counts);
+      count_drivers_(port->node, false, bit_idx, counts);
 }
 
 void vvp_island_branch_tran::run_test_enabled()
 {
-      const vvp_island_port*ep = en? dynamic_cast<vvp_island_port*> (en->fun) : NULL;
+      const vvp_island_port*ep = en_port;
 
 	// If there is no ep port (no "enabled" input) then this is a
 	// tran branch. Assume it is always enabled.
@@ -243,7 +320,7 @@ void vvp_island_branch_tran::run_test_enabled()
 
 bool vvp_island_branch_tran::rerun_test_enabled()
 {
-      const vvp_island_port*ep = en? dynamic_cast<vvp_island_port*> (en->fun) : NULL;
+      const vvp_island_port*ep = en_port;
 
       if (ep == 0)
 	    return false;
@@ -322,7 +399,7 @@ static void push_value_through_branch(const vvp_vector8_t&val,
       unsigned dst_ab = src_ab^1;
 
       vvp_net_t*dst_net = dst_ab? branch->b : branch->a;
-      vvp_island_port*dst_port = dynamic_cast<vvp_island_port*>(dst_net->fun);
+      vvp_island_port*dst_port = branch->ports[dst_ab];
 
       vvp_vector8_t old_val = dst_port->value;
 
@@ -388,8 +465,10 @@ void vvp_island_branch_tran::run_resolution()
 
 	// If the A side port hasn't already been visited, then push
         // its input value through all the branches connected to it.
-      port = dynamic_cast<vvp_island_port*>(a->fun);
-      if (port->value.size() == 0) {
+        // Skip the port if it is not in the part of the mesh that
+        // the island is working on.
+      port = ports[0];
+      if (port->active && port->value.size() == 0) {
 	    vvp_branch_ptr_t a_side(this, 0);
 	    island_collect_node(connections, a_side);
 
@@ -403,8 +482,8 @@ void vvp_island_branch_tran::run_resolution()
 	// Do the same for the B side port. Note that if the branch
         // is enabled, the B side port will have already been visited
         // when we resolved the A side port.
-      port = dynamic_cast<vvp_island_port*>(b->fun);
-      if (port->value.size() == 0) {
+      port = ports[1];
+      if (port->active && port->value.size() == 0) {
 	    vvp_branch_ptr_t b_side(this, 1);
 	    island_collect_node(connections, b_side);
 
@@ -422,14 +501,14 @@ void vvp_island_branch_tran::run_output()
 
 	// If the A side port hasn't already been updated, send the
         // resolved value to the output.
-      port = dynamic_cast<vvp_island_port*>(a->fun);
+      port = ports[0];
       if (port->value.size() != 0) {
 	    island_send_value(a, port->value);
 	    port->value = vvp_vector8_t::nil;
       }
 
 	// Do the same for the B side port.
-      port = dynamic_cast<vvp_island_port*>(b->fun);
+      port = ports[1];
       if (port->value.size() != 0) {
 	    island_send_value(b, port->value);
 	    port->value = vvp_vector8_t::nil;
@@ -461,6 +540,8 @@ void compile_island_tranif(int sense, char*island, char*pa, char*pb, char*pe,
                                                              sense ? true :
                                                                      false,
                                                              0, 0, 0, resistive);
+      if (en)
+	    island_port(en)->controls.push_back(br);
 
       use_island->add_branch(br, pa, pb);
 
@@ -22,7 +22,10 @@ const char COPYRIGHT[] =
 # include  "compile.h"
 # include  "schedule.h"
 # include  "vpi_priv.h"
+# include  "array.h"
+# include  "logic.h"
 # include  "statistics.h"
+# include  "profile.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
 # include  <cstdio>
@@ -53,6 +56,7 @@ extern "C" const char*optarg;
 #endif
 
 bool verbose_flag = false;
+static const char*stats_path = 0;
 static int vvp_return_value = 0;
 static int vvp_used = 0;
 
@@ -75,6 +79,26 @@ void vvp_set_verbose_flag(bool flag)
       verbose_flag = flag;
 }
 
+void vvp_set_stats_file(const char*path)
+{
+      stats_path = path;
+}
+
+void vvp_set_sparse_memory_words(unsigned long words)
+{
+      array_sparse_words = words;
+}
+
+void vvp_set_gate_engine(bool flag)
+{
+      gate_engine_flag = flag;
+}
+
+void vvp_set_inertial_delay(bool flag)
+{
+      inertial_delay_flag = flag;
+}
+
 void vpip_set_return_value(int value)
 {
       vvp_return_value = value;
@@ -111,9 +135,9 @@ static void my_getrusage(struct rusage *a)
 #     endif
 }
 
-static void print_rusage(struct rusage *a, struct rusage *b)
+static double rusage_seconds(struct rusage *a, struct rusage *b)
 {
-      double delta = a->ru_utime.tv_sec
+      return a->ru_utime.tv_sec
 	    +        a->ru_utime.tv_usec/1E6
 	    +        a->ru_stime.tv_sec
 	    +        a->ru_stime.tv_usec/1E6
@@ -122,6 +146,11 @@ static void print_rusage(struct rusage *a, struct rusage *b)
 	    -        b->ru_stime.tv_sec
 	    -        b->ru_stime.tv_usec/1E6
 	    ;
+}
+
+static void print_rusage(struct rusage *a, struct rusage *b)
+{
+      double delta = rusage_seconds(a, b);
 
       vpi_mcd_printf(1,
 	      " ... %G seconds,"
@@ -137,6 +166,7 @@ static void print_rusage(struct rusage *a, struct rusage *b)
 // Provide dummies
 struct rusage { int x; };
 inline static void my_getrusage(struct rusage *) { }
+inline static double rusage_seconds(struct rusage *, struct rusage *) { return 0.0; }
 inline static void print_rusage(struct rusage *, struct rusage *){};
 
 #endif // ! defined(HAVE_SYS_RESOURCE_H)
@@ -232,6 +262,7 @@ static void final_cleanup()
       codespace_delete();
       root_table_delete();
       def_table_delete();
+      gate_engine_delete();
       vpi_mcd_delete();
       dec_str_delete();
       modpath_delete();
@@ -242,6 +273,8 @@ static void final_cleanup()
       signal_pool_delete();
       vvp_net_pool_delete();
       ufunc_pool_delete();
+      vthread_pool_delete();
+      profile_delete();
 #endif
 	/*
 	 * Unload the VPI modules. This is essential for MinGW, to ensure
@@ -344,6 +377,9 @@ int vvp_run(const char *design_path)
       }
       ++vvp_used;
 
+      count_events_flag = verbose_flag || stats_path;
+
+      my_getrusage(cycles+0);
       ret_cd = compile_design(design_path);
       destroy_lexor();
       print_vpi_call_errors();
@@ -379,38 +415,76 @@ int vvp_run(const char *design_path)
 			   count_filters, vvp_net_fil_t::heap_total());
 	    vpi_mcd_printf(1, " ... %8lu opcodes (%zu bytes)\n",
 	                   count_opcodes, size_opcodes);
+	    vpi_mcd_printf(1, "           %8lu signal access (specialized)\n",
+			   count_opcodes_sig_special);
+	    vpi_mcd_printf(1, "           %8lu signal access (generic)\n",
+			   count_opcodes_sig_generic);
+	    vpi_mcd_printf(1, "           %8lu fused sequences\n",
+			   count_opcodes_fused);
 	    vpi_mcd_printf(1, " ... %8lu nets\n",     count_vpi_nets);
 	    vpi_mcd_printf(1, " ... %8lu vvp_nets (%zu bytes)\n",
 			   count_vvp_nets, size_vvp_nets);
+	    vpi_mcd_printf(1, "           %8lu fan-out arrays (%zu bytes)\n",
+			   count_fanout_arrays, size_fanout_arrays);
+	    vpi_mcd_printf(1, "           %8lu gate clusters (%lu gates)\n",
+			   count_gate_clusters, count_gate_cluster_gates);
 	    vpi_mcd_printf(1, " ... %8lu arrays (%lu words)\n",
 			   count_net_arrays, count_net_array_words);
 	    vpi_mcd_printf(1, " ... %8lu memories\n",
 			   count_var_arrays+count_real_arrays);
 	    vpi_mcd_printf(1, "           %8lu logic (%lu words)\n",
 			   count_var_arrays, count_var_array_words);
+	    vpi_mcd_printf(1, "           %8lu sparse logic\n",
+			   count_sparse_arrays);
 	    vpi_mcd_printf(1, "           %8lu real (%lu words)\n",
 			   count_real_arrays, count_real_array_words);
 	    vpi_mcd_printf(1, " ... %8lu scopes\n",   count_vpi_scopes);
       }
 
+      my_getrusage(cycles+1);
       if (verbose_flag) {
-	    my_getrusage(cycles+1);
 	    print_rusage(cycles+1, cycles+0);
 	    vpi_mcd_printf(1, "Running ...\n");
       }
 
 
       schedule_simulate();
+      profile_report();
+
+      my_getrusage(cycles+2);
+      if (stats_path)
+	    write_statistics_json(stats_path, design_path,
+				  rusage_seconds(cycles+1, cycles+0),
+				  rusage_seconds(cycles+2, cycles+1));
 
       if (verbose_flag) {
-	    my_getrusage(cycles+2);
 	    print_rusage(cycles+2, cycles+1);
 
 	    vpi_mcd_printf(1, "Event counts:\n");
 	    vpi_mcd_printf(1, "    %8lu time steps (pool=%lu)\n",
 			   count_time_events, count_time_pool());
+	    vpi_mcd_printf(1, "             ...overflow time steps=%lu\n",
+			   count_time_overflow);
+	    vpi_mcd_printf(1, "             ...time advanced %lu times\n",
+			   count_time_advances);
+	    vpi_mcd_printf(1, "    %8lu events run (peak queued=%lu)\n",
+			   count_events_run, count_events_peak);
+	    vpi_mcd_printf(1, "             ...start=%lu active=%lu inactive=%lu\n",
+			   count_region_start, count_region_active,
+			   count_region_inactive);
+	    vpi_mcd_printf(1, "             ...nbassign=%lu rwsync=%lu rosync=%lu\n",
+			   count_region_nbassign, count_region_rwsync,
+			   count_region_rosync);
+	    vpi_mcd_printf(1, "    %8lu gate cluster runs\n",
+			   count_gate_cluster_runs);
+	    vpi_mcd_printf(1, "    %8lu delay pulses rejected\n",
+			   count_delay_pulses_rejected);
 	    vpi_mcd_printf(1, "    %8lu thread schedule events\n",
 		    count_thread_events);
+	    vpi_mcd_printf(1, "    %8lu threads created (pool hits=%lu)\n",
+			   count_thread_forks, count_thread_pool_hits);
+	    vpi_mcd_printf(1, "    %8lu threads reaped (pool=%lu)\n",
+			   count_thread_reaps, count_thread_pool());
 	    vpi_mcd_printf(1, "    %8lu assign events\n",
 		    count_assign_events);
 	    vpi_mcd_printf(1, "             ...assign(vec4) pool=%lu\n",
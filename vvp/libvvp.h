@@ -35,6 +35,57 @@ extern void vvp_set_quiet_flag(bool flag);
 
 extern void vvp_set_verbose_flag(bool flag);
 
+/* vvp_set_profile_file(path) is equivalent to vvp's "-p" option. It
+ * turns on the run time profiler, which writes its results to the
+ * file when the simulation ends.
+ *
+ * This function must be called before vvp_run().
+ */
+
+extern void vvp_set_profile_file(const char*path);
+
+/* vvp_set_stats_file(path) is equivalent to vvp's "--stats" option. The
+ * run time statistics (event counts for each scheduling region, time
+ * steps, queue depth and rates) are written to the file as JSON at
+ * the end of the simulation.
+ *
+ * This function must be called before vvp_run().
+ */
+
+extern void vvp_set_stats_file(const char*path);
+
+/* vvp_set_sparse_memory_words(words) is equivalent to vvp's
+ * "--sparse-memory" option. Memories with at least this many words
+ * are stored sparsely, so that only the pages of the memory that are
+ * written take up space. If words is 0, all memories are stored in
+ * full.
+ *
+ * This function must be called before vvp_run().
+ */
+
+extern void vvp_set_sparse_memory_words(unsigned long words);
+
+/* vvp_set_gate_engine(true) is equivalent to vvp's "--gate-engine"
+ * option. The connected groups of scalar, zero delay gates are
+ * levelized and evaluated as packed words, and only the values that
+ * leave a group are scheduled as events. Zero delay glitches within a
+ * group are not seen.
+ *
+ * This function must be called before vvp_run().
+ */
+
+extern void vvp_set_gate_engine(bool flag);
+
+/* vvp_set_inertial_delay(true) is equivalent to vvp's "--inertial-delay"
+ * option. Delay and module path functors keep at most one pending
+ * output event, and a new input change replaces that event in place
+ * rather than scheduling another one.
+ *
+ * This function must be called before vvp_run().
+ */
+
+extern void vvp_set_inertial_delay(bool flag);
+
 /* vvp_no_signals() may be called at any time before vvp_run() to prevent
  * libvvp from handling signals generated by a terminal. It is recommended.
  */
@@ -572,15 +572,20 @@ void compile_functor(char*label, char*type, unsigned width,
 {
       vvp_net_fun_t* obj = 0;
       bool strength_aware = false;
+	// The kind of gate for the gate engine, if it is one of those.
+      int gate_kind = -1;
 
       if (strcmp(type, "OR") == 0) {
 	    obj = new vvp_fun_or(width, false);
+	    gate_kind = GATE_OR;
 
       } else if (strcmp(type, "AND") == 0) {
 	    obj = new vvp_fun_and(width, false);
+	    gate_kind = GATE_AND;
 
       } else if (strcmp(type, "BUF") == 0) {
 	    obj = new vvp_fun_buf(width);
+	    gate_kind = GATE_BUF;
 
       } else if (strcmp(type, "BUFIF0") == 0) {
 	    obj = new vvp_fun_bufif(true,false, ostr0, ostr1);
@@ -598,9 +603,11 @@ void compile_functor(char*label, char*type, unsigned width,
 
       } else if (strcmp(type, "NAND") == 0) {
 	    obj = new vvp_fun_and(width, true);
+	    gate_kind = GATE_AND|GATE_INVERT;
 
       } else if (strcmp(type, "NOR") == 0) {
 	    obj = new vvp_fun_or(width, true);
+	    gate_kind = GATE_OR|GATE_INVERT;
 
       } else if (strcmp(type, "NOTIF0") == 0) {
 	    obj = new vvp_fun_bufif(true,true, ostr0, ostr1);
@@ -642,12 +649,15 @@ void compile_functor(char*label, char*type, unsigned width,
 
       } else if (strcmp(type, "NOT") == 0) {
 	    obj = new vvp_fun_not(width);
+	    gate_kind = GATE_BUF|GATE_INVERT;
 
       } else if (strcmp(type, "XNOR") == 0) {
 	    obj = new vvp_fun_xor(width, true);
+	    gate_kind = GATE_XOR|GATE_INVERT;
 
       } else if (strcmp(type, "XOR") == 0) {
 	    obj = new vvp_fun_xor(width, false);
+	    gate_kind = GATE_XOR;
 
       } else {
 	    yyerror("invalid functor type.");
@@ -666,6 +676,10 @@ void compile_functor(char*label, char*type, unsigned width,
       inputs_connect(net, argc, argv);
       free(argv);
 
+      if (gate_engine_flag && gate_kind >= 0 && width == 1
+	  && ostr0 == 6 && ostr1 == 6)
+	    gate_engine_add(net, gate_kind);
+
 	/* If both the strengths are the default strong drive, then
 	   there is no need for a specialized driver. Attach the label
 	   to this node and we are finished. */
@@ -232,4 +232,17 @@ class vvp_fun_xor  : public vvp_fun_boolean_ {
       bool invert_;
 };
 
+/*
+ * The compiled gate engine (gate_engine.cc) can take over the scalar,
+ * zero delay, strong output gates. When gate_engine_flag is set,
+ * compile_functor passes each such gate to gate_engine_add with its
+ * kind, which is one of the GATE_AND/OR/XOR/BUF values, with
+ * GATE_INVERT added for the NAND, NOR, XNOR and NOT gates.
+ */
+enum { GATE_AND = 0, GATE_OR = 1, GATE_XOR = 2, GATE_BUF = 3,
+       GATE_INVERT = 4 };
+
+extern bool gate_engine_flag;
+extern void gate_engine_add(vvp_net_t*net, unsigned kind);
+
 #endif /* IVL_logic_H */
@@ -23,6 +23,7 @@ const char COPYRIGHT[] =
 # include  "compile.h"
 # include  <cstdio>
 # include  <cstdlib>
+# include  <cstring>
 
 #if defined(HAVE_GETOPT_H)
 # include  <getopt.h>
@@ -52,22 +53,86 @@ int main(int argc, char*argv[])
       int opt;
       unsigned flag_errors = 0;
       const char *logfile_name = 0x0;
+      const char *stats_path = 0x0;
+      const char *sparse_words = 0x0;
+
+	/* The --stats, --sparse-memory, --gate-engine and
+	   --inertial-delay flags are pulled out by hand because getopt
+	   does not do long options everywhere. Like getopt, this stops
+	   at the first argument that is not an option, so the arguments
+	   that follow the input file are left for the design. */
+      for (int idx = 1 ;  idx < argc ;  idx += 1) {
+	    if (argv[idx][0] != '-' || argv[idx][1] == 0)
+		  break;
+	    if (strcmp(argv[idx], "--") == 0)
+		  break;
+	    if (strcmp(argv[idx], "--gate-engine") == 0) {
+		  vvp_set_gate_engine(true);
+		  for (int tmp = idx+1 ;  tmp <= argc ;  tmp += 1)
+			argv[tmp-1] = argv[tmp];
+		  argc -= 1;
+		  idx -= 1;
+		  continue;
+	    }
+	    if (strcmp(argv[idx], "--inertial-delay") == 0) {
+		  vvp_set_inertial_delay(true);
+		  for (int tmp = idx+1 ;  tmp <= argc ;  tmp += 1)
+			argv[tmp-1] = argv[tmp];
+		  argc -= 1;
+		  idx -= 1;
+		  continue;
+	    }
+	    const char**flag_value;
+	    if (strcmp(argv[idx], "--stats") == 0) {
+		  flag_value = &stats_path;
+	    } else if (strcmp(argv[idx], "--sparse-memory") == 0) {
+		  flag_value = &sparse_words;
+	    } else {
+		    /* Step over the value of an option that takes
+		       one, if the value is the next argument. */
+		  for (const char*cp = argv[idx]+1 ;  *cp ;  cp += 1) {
+			if (strchr("lMmp", *cp)) {
+			      if (cp[1] == 0)
+				    idx += 1;
+			      break;
+			}
+		  }
+		  continue;
+	    }
+	    if (idx+1 >= argc) {
+		  fprintf(stderr, "%s: %s requires an argument.\n",
+			  argv[0], argv[idx]);
+		  return -1;
+	    }
+	    *flag_value = argv[idx+1];
+	    for (int tmp = idx+2 ;  tmp <= argc ;  tmp += 1)
+		  argv[tmp-2] = argv[tmp];
+	    argc -= 2;
+	    idx -= 1;
+      }
 
-      while ((opt = getopt(argc, argv, "+hil:M:m:nNqsvV")) != EOF) switch (opt) {
+      while ((opt = getopt(argc, argv, "+hil:M:m:nNp:qsvV")) != EOF) switch (opt) {
          case 'h':
            fprintf(stderr,
                    "Usage: vvp [options] input-file [+plusargs...]\n"
                    "Options:\n"
+                   " --gate-engine  Evaluate gate clusters as packed words.\n"
                    " -h             Print this help message.\n"
                    " -i             Interactive mode (unbuffered stdio).\n"
+                   " --inertial-delay\n"
+                   "                Keep one pending event per delay.\n"
                    " -l file        Logfile, '-' for <stderr>\n"
                    " -M path        VPI module directory\n"
 		   " -M -           Clear VPI module path\n"
                    " -m module      Load vpi module.\n"
 		   " -n             Non-interactive ($stop = $finish).\n"
                    " -N             Same as -n, but exit code is 1 instead of 0\n"
+                   " -p file        Write a run time profile to the file.\n"
+                   " --stats file   Write run time statistics to the file.\n"
 		   " -q             Quiet mode (suppress output on MCD bit 0).\n"
 		   " -s             $stop right away.\n"
+                   " --sparse-memory words\n"
+                   "                Store memories of at least this many words sparsely.\n"
                    " -v             Verbose progress messages.\n"
                    " -V             Print the version information.\n" );
            exit(0);
@@ -93,6 +158,9 @@ int main(int argc, char*argv[])
           case 'N':
             vvp_set_stop_is_finish(true, 1);
             break;
+	  case 'p':
+	    vvp_set_profile_file(optarg);
+	    break;
 	  case 'q':
 	    vvp_set_quiet_flag(true);
 	    break;
@@ -139,6 +207,20 @@ int main(int argc, char*argv[])
 	    return -1;
       }
 
+      if (stats_path)
+	    vvp_set_stats_file(stats_path);
+
+      if (sparse_words) {
+	    char*end;
+	    unsigned long words = strtoul(sparse_words, &end, 0);
+	    if (*sparse_words == 0 || *end != 0) {
+		  fprintf(stderr, "%s: --sparse-memory requires a word count.\n",
+			  argv[0]);
+		  return -1;
+	    }
+	    vvp_set_sparse_memory_words(words);
+      }
+
       vvp_init(logfile_name, argc - optind, argv + optind);
 
       for (unsigned idx = 0 ;  idx < module_cnt ;  idx += 1)
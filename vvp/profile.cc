@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "profile.h"
+# include  "libvvp.h"
+# include  "compile.h"
+# include  "schedule.h"
+# include  "vpi_priv.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <cerrno>
+# include  <string>
+# include  <vector>
+# include  <map>
+# include  <unordered_map>
+# include  <algorithm>
+# include  <typeinfo>
+# include  <typeindex>
+# include  <chrono>
+#if defined(__GNUC__)
+# include  <cxxabi.h>
+#endif
+
+using namespace std;
+
+bool profile_flag = false;
+
+static const char*profile_path = 0;
+
+typedef chrono::steady_clock profile_clock;
+
+static profile_clock::time_point profile_start;
+static profile_clock::time_point profile_last;
+static profile_count_s*profile_current = 0;
+
+static map<vvp_code_t,profile_proc_s*> profile_procs;
+static map<vpiHandle,profile_line_s*> profile_lines;
+static unordered_map<type_index,uint64_t> profile_functors;
+/*
+ * A superinstruction executes the whole instruction sequence that it
+ * replaced, so it counts as that many instructions.
+ */
+static unordered_map<vvp_code_fun,unsigned> profile_fused;
+
+void vvp_set_profile_file(const char*path)
+{
+      profile_path = path;
+      profile_flag = path != 0;
+      profile_start = profile_clock::now();
+      profile_last = profile_start;
+
+      for (const vvp_fused_code_s*cur = vvp_fused_codes ; cur->count ; cur += 1)
+	    profile_fused[cur->opcode] = cur->count;
+}
+
+profile_proc_s*profile_process(vvp_code_t start, __vpiScope*scope)
+{
+      profile_proc_s*&rec = profile_procs[start];
+      if (rec == 0) {
+	    rec = new profile_proc_s;
+	    rec->instructions = 0;
+	    rec->nanoseconds = 0;
+	    rec->runs = 0;
+	    rec->start = start;
+	    rec->scope = scope;
+      }
+      return rec;
+}
+
+profile_line_s*profile_line(vpiHandle file_line)
+{
+      profile_line_s*&rec = profile_lines[file_line];
+      if (rec == 0) {
+	    rec = new profile_line_s;
+	    rec->file_line = file_line;
+	    rec->instructions = 0;
+      }
+      return rec;
+}
+
+profile_count_s*profile_enter(profile_count_s*rec)
+{
+      profile_clock::time_point now = profile_clock::now();
+      if (profile_current)
+	    profile_current->nanoseconds +=
+		  chrono::duration_cast<chrono::nanoseconds>(now - profile_last).count();
+      profile_last = now;
+
+      profile_count_s*prev = profile_current;
+      profile_current = rec;
+      return prev;
+}
+
+void profile_count_sends(vvp_net_ptr_t ptr)
+{
+      while (vvp_net_t*cur = ptr.ptr()) {
+	    if (cur->fun)
+		  profile_functors[type_index(typeid(*cur->fun))] += 1;
+	    ptr = cur->port[ptr.port()];
+      }
+}
+
+void profile_count_sends(const vvp_fanout_s*fan)
+{
+      for ( ; fan->fun ; fan += 1)
+	    profile_functors[type_index(typeid(*fan->fun))] += 1;
+}
+
+unsigned profile_opcode_length(vvp_code_fun opcode)
+{
+      unordered_map<vvp_code_fun,unsigned>::const_iterator cur = profile_fused.find(opcode);
+      return cur == profile_fused.end()? 1 : cur->second;
+}
+
+/*
+ * The profile is written as JSON, so strings (which may come from
+ * escaped Verilog identifiers) need the JSON escapes.
+ */
+static void json_string(FILE*fd, const char*text)
+{
+      fputc('"', fd);
+      for (const char*cp = text ; *cp ; cp += 1) {
+	    unsigned char ch = *cp;
+	    if (ch == '"' || ch == '\\')
+		  fprintf(fd, "\\%c", ch);
+	    else if (ch < 0x20)
+		  fprintf(fd, "\\u%04x", ch);
+	    else
+		  fputc(ch, fd);
+      }
+      fputc('"', fd);
+}
+
+static string class_name(const type_index&type)
+{
+      string res = type.name();
+#if defined(__GNUC__)
+      int status = 0;
+      char*name = abi::__cxa_demangle(type.name(), 0, 0, &status);
+      if (status == 0 && name)
+	    res = name;
+      free(name);
+#endif
+      return res;
+}
+
+struct profile_location_s {
+      string file;
+      unsigned line;
+};
+
+static profile_location_s scope_location(__vpiScope*scope)
+{
+      profile_location_s res;
+      res.file = vpi_get_str(vpiFile, scope);
+      res.line = vpi_get(vpiLineNo, scope);
+      return res;
+}
+
+static profile_location_s file_line_location(vpiHandle file_line)
+{
+      profile_location_s res;
+      res.file = vpi_get_str(vpiFile, file_line);
+      res.line = vpi_get(vpiLineNo, file_line);
+      return res;
+}
+
+/*
+ * The location of a process is the first %file_line of its code if
+ * the code is instrumented, otherwise the location of its scope.
+ */
+static profile_location_s process_location(const profile_proc_s*proc)
+{
+      vvp_code_t cp = proc->start;
+      for (unsigned idx = 0 ; idx < 8 ; idx += 1) {
+	    if (cp->opcode == &of_FILE_LINE)
+		  return file_line_location(cp->handle);
+	    if (cp->opcode == &of_CHUNK_LINK)
+		  cp = cp->cptr;
+	    else
+		  cp += 1;
+      }
+      return scope_location(proc->scope);
+}
+
+static bool by_time(const profile_proc_s*a, const profile_proc_s*b)
+{
+      if (a->nanoseconds != b->nanoseconds)
+	    return a->nanoseconds > b->nanoseconds;
+      return a->instructions > b->instructions;
+}
+
+static void print_counts(FILE*fd, const profile_count_s&rec)
+{
+      fprintf(fd, "\"instructions\": %llu, \"time_ns\": %llu, \"runs\": %llu",
+	      (unsigned long long)rec.instructions,
+	      (unsigned long long)rec.nanoseconds,
+	      (unsigned long long)rec.runs);
+}
+
+static void print_location(FILE*fd, const profile_location_s&loc)
+{
+      fprintf(fd, "\"file\": ");
+      json_string(fd, loc.file.c_str());
+      fprintf(fd, ", \"line\": %u", loc.line);
+}
+
+void profile_report(void)
+{
+      if (! profile_flag)
+	    return;
+
+      profile_enter(0);
+      uint64_t wall = chrono::duration_cast<chrono::nanoseconds>
+	    (profile_clock::now() - profile_start).count();
+
+      FILE*fd = fopen(profile_path, "w");
+      if (fd == 0) {
+	    fprintf(stderr, "%s: Unable to write profile: %s\n",
+		    profile_path, strerror(errno));
+	    return;
+      }
+
+      vector<profile_proc_s*> procs;
+      profile_count_s total;
+      total.instructions = 0;
+      total.nanoseconds = 0;
+      total.runs = 0;
+      for (map<vvp_code_t,profile_proc_s*>::const_iterator cur = profile_procs.begin()
+		 ; cur != profile_procs.end() ; ++ cur ) {
+	    if (cur->second->runs == 0)
+		  continue;
+	    procs.push_back(cur->second);
+	    total.instructions += cur->second->instructions;
+	    total.nanoseconds += cur->second->nanoseconds;
+	    total.runs += cur->second->runs;
+      }
+      sort(procs.begin(), procs.end(), by_time);
+
+	// The scope totals are the sums of the processes in the scope.
+      map<__vpiScope*,profile_count_s> scope_map;
+      for (size_t idx = 0 ; idx < procs.size() ; idx += 1) {
+	    profile_count_s&rec = scope_map[procs[idx]->scope];
+	    rec.instructions += procs[idx]->instructions;
+	    rec.nanoseconds += procs[idx]->nanoseconds;
+	    rec.runs += procs[idx]->runs;
+      }
+      vector<pair<uint64_t,__vpiScope*> > scopes;
+      for (map<__vpiScope*,profile_count_s>::const_iterator cur = scope_map.begin()
+		 ; cur != scope_map.end() ; ++ cur )
+	    scopes.push_back(make_pair(cur->second.nanoseconds, cur->first));
+      sort(scopes.rbegin(), scopes.rend());
+
+      fprintf(fd, "{\n");
+      fprintf(fd, "  \"wall_time_ns\": %llu,\n", (unsigned long long)wall);
+      fprintf(fd, "  \"simulation_time\": %llu,\n",
+	      (unsigned long long)schedule_simtime());
+      fprintf(fd, "  \"threads\": { ");
+      print_counts(fd, total);
+      fprintf(fd, " },\n");
+
+      fprintf(fd, "  \"hot_spots\": [");
+      for (size_t idx = 0 ; idx < procs.size() && idx < 10 ; idx += 1) {
+	    profile_location_s loc = process_location(procs[idx]);
+	    fprintf(fd, "%s\n    { \"location\": ", idx? "," : "");
+	    char line_text[32];
+	    snprintf(line_text, sizeof line_text, ":%u", loc.line);
+	    json_string(fd, (loc.file + line_text).c_str());
+	    fprintf(fd, ", \"scope\": ");
+	    json_string(fd, vpi_get_str(vpiFullName, procs[idx]->scope));
+	    fprintf(fd, ", \"time_ns\": %llu, \"instructions\": %llu }",
+		    (unsigned long long)procs[idx]->nanoseconds,
+		    (unsigned long long)procs[idx]->instructions);
+      }
+      fprintf(fd, "\n  ],\n");
+
+      fprintf(fd, "  \"scopes\": [");
+      for (size_t idx = 0 ; idx < scopes.size() ; idx += 1) {
+	    __vpiScope*scope = scopes[idx].second;
+	    fprintf(fd, "%s\n    { \"scope\": ", idx? "," : "");
+	    json_string(fd, vpi_get_str(vpiFullName, scope));
+	    fprintf(fd, ", \"type\": ");
+	    json_string(fd, vpi_get_str(vpiType, scope));
+	    fprintf(fd, ", ");
+	    print_location(fd, scope_location(scope));
+	    fprintf(fd, ", ");
+	    print_counts(fd, scope_map[scope]);
+	    fprintf(fd, " }");
+      }
+      fprintf(fd, "\n  ],\n");
+
+      fprintf(fd, "  \"processes\": [");
+      for (size_t idx = 0 ; idx < procs.size() ; idx += 1) {
+	    fprintf(fd, "%s\n    { \"scope\": ", idx? "," : "");
+	    json_string(fd, vpi_get_str(vpiFullName, procs[idx]->scope));
+	    fprintf(fd, ", ");
+	    print_location(fd, process_location(procs[idx]));
+	    fprintf(fd, ", ");
+	    print_counts(fd, *procs[idx]);
+	    fprintf(fd, " }");
+      }
+      fprintf(fd, "\n  ],\n");
+
+      vector<pair<uint64_t,profile_line_s*> > lines;
+      for (map<vpiHandle,profile_line_s*>::const_iterator cur = profile_lines.begin()
+		 ; cur != profile_lines.end() ; ++ cur )
+	    lines.push_back(make_pair(cur->second->instructions, cur->second));
+      sort(lines.rbegin(), lines.rend());
+
+      fprintf(fd, "  \"lines\": [");
+      for (size_t idx = 0 ; idx < lines.size() ; idx += 1) {
+	    fprintf(fd, "%s\n    { ", idx? "," : "");
+	    print_location(fd, file_line_location(lines[idx].second->file_line));
+	    fprintf(fd, ", \"instructions\": %llu }",
+		    (unsigned long long)lines[idx].first);
+      }
+      fprintf(fd, "\n  ],\n");
+
+      vector<pair<uint64_t,string> > functors;
+      for (unordered_map<type_index,uint64_t>::const_iterator cur = profile_functors.begin()
+		 ; cur != profile_functors.end() ; ++ cur )
+	    functors.push_back(make_pair(cur->second, class_name(cur->first)));
+      sort(functors.rbegin(), functors.rend());
+
+      fprintf(fd, "  \"functors\": [");
+      for (size_t idx = 0 ; idx < functors.size() ; idx += 1) {
+	    fprintf(fd, "%s\n    { \"class\": ", idx? "," : "");
+	    json_string(fd, functors[idx].second.c_str());
+	    fprintf(fd, ", \"received\": %llu }",
+		    (unsigned long long)functors[idx].first);
+      }
+      fprintf(fd, "\n  ]\n");
+      fprintf(fd, "}\n");
+
+      fclose(fd);
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void profile_delete(void)
+{
+      for (map<vvp_code_t,profile_proc_s*>::iterator cur = profile_procs.begin()
+		 ; cur != profile_procs.end() ; ++ cur )
+	    delete cur->second;
+      profile_procs.clear();
+      for (map<vpiHandle,profile_line_s*>::iterator cur = profile_lines.begin()
+		 ; cur != profile_lines.end() ; ++ cur )
+	    delete cur->second;
+      profile_lines.clear();
+      profile_functors.clear();
+      profile_fused.clear();
+}
+#endif
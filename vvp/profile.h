@@ -0,0 +1,85 @@
+#ifndef IVL_profile_H
+#define IVL_profile_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vvp_net.h"
+# include  "codes.h"
+# include  <stdint.h>
+
+class __vpiScope;
+
+/*
+ * The run time profiler is turned on by the "-p <file>" flag. It
+ * attributes executed instructions and wall clock time to the process
+ * (the code address where a thread starts) and through that to the
+ * scope that contains it, counts the instructions executed for each
+ * %file_line if the code is instrumented, and counts the values that
+ * each functor class receives. The results are written to the file as
+ * JSON when the simulation ends.
+ *
+ * Everything is gated by the profile_flag. The profiling version of
+ * the thread loop is separate, and the send functions test the flag
+ * once for each value sent, so the profiler costs little when it is
+ * not turned on.
+ */
+extern bool profile_flag;
+
+struct profile_count_s {
+      uint64_t instructions;
+      uint64_t nanoseconds;
+      uint64_t runs;
+};
+
+struct profile_proc_s : public profile_count_s {
+      vvp_code_t start;
+      __vpiScope*scope;
+};
+
+struct profile_line_s {
+      vpiHandle file_line;
+      uint64_t instructions;
+};
+
+/*
+ * Get the record for the process that starts at the given code
+ * address, or for the given %file_line handle.
+ */
+extern profile_proc_s*profile_process(vvp_code_t start, __vpiScope*scope);
+extern profile_line_s*profile_line(vpiHandle file_line);
+
+/*
+ * Get the number of instructions that the opcode executes. This is 1
+ * except for the superinstructions.
+ */
+extern unsigned profile_opcode_length(vvp_code_fun opcode);
+
+/*
+ * Charge the wall time since the last switch to the current record,
+ * then make the rec (which may be nil) current. Return the record
+ * that was current.
+ */
+extern profile_count_s*profile_enter(profile_count_s*rec);
+
+/*
+ * Write the profile file. This is called when the simulation ends.
+ */
+extern void profile_report(void);
+
+#endif /* IVL_profile_H */
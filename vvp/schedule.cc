@@ -26,6 +26,8 @@
 # include  "compile.h"
 # include  <new>
 # include  <typeinfo>
+# include  <vector>
+# include  <algorithm>
 # include  <csignal>
 # include  <cstdlib>
 # include  <cassert>
@@ -42,6 +44,45 @@ unsigned long count_gen_events = 0;
 unsigned long count_thread_events = 0;
   // Count the time events (A time cell created)
 unsigned long count_time_events = 0;
+  // Count the times the simulation time advanced
+unsigned long count_time_advances = 0;
+
+  // The event counts below cost a little on every event, so they are
+  // only kept when they are to be reported (-v or --stats).
+bool count_events_flag = false;
+
+  // Count the events run from each region, and all the events run.
+unsigned long count_region_start = 0;
+unsigned long count_region_active = 0;
+unsigned long count_region_inactive = 0;
+unsigned long count_region_nbassign = 0;
+unsigned long count_region_rwsync = 0;
+unsigned long count_region_rosync = 0;
+unsigned long count_events_run = 0;
+
+  // The number of events waiting in the queues, and the most
+  // there have ever been.
+static unsigned long events_pending = 0;
+unsigned long count_events_peak = 0;
+
+static inline void event_queued_(void)
+{
+      if (! count_events_flag)
+	    return;
+      events_pending += 1;
+      if (events_pending > count_events_peak)
+	    count_events_peak = events_pending;
+}
+
+static inline void event_run_(unsigned long*region)
+{
+      if (! count_events_flag)
+	    return;
+      events_pending -= 1;
+      count_events_run += 1;
+      if (region)
+	    *region += 1;
+}
 
 
 
@@ -51,6 +92,8 @@ unsigned long count_time_events = 0;
  *
  * The event_time_s objects are one per time step. Each time step in
  * turn contains a list of event_s objects that are the actual events.
+ * The time steps themselves are kept in a timing wheel (see below)
+ * and are tagged with the absolute simulation time they represent.
  *
  * The event_s objects are base classes for the more specific sort of
  * event.
@@ -76,7 +119,8 @@ void event_s::single_step_display(void)
 struct event_time_s {
       event_time_s() {
 	    count_time_events += 1;
-	    delay = 0;
+	    time = 0;
+	    seq = 0;
 	    start = 0;
 	    active = 0;
 	    inactive = 0;
@@ -84,9 +128,11 @@ struct event_time_s {
 	    rwsync = 0;
 	    rosync = 0;
 	    del_thr = 0;
-	    next = NULL;
       }
-      vvp_time64_t delay;
+	// The absolute time of this time step.
+      vvp_time64_t time;
+	// Creation order, used to keep overflow time steps stable.
+      unsigned long seq;
 
       struct event_s*start;
       struct event_s*active;
@@ -96,8 +142,6 @@ struct event_time_s {
       struct event_s*rosync;
       struct event_s*del_thr;
 
-      struct event_time_s*next;
-
       static void* operator new (size_t);
       static void operator delete(void*obj, size_t s);
 };
@@ -559,12 +603,244 @@ inline void event_time_s::operator delete(void*ptr, size_t)
 unsigned long count_time_pool(void) { return event_time_heap.pool; }
 
 /*
- * This is the head of the list of pending events. This includes all
- * the events that have not been executed yet, and reaches into the
- * future.
+ * The pending time steps are kept in a timing wheel. The wheel covers
+ * the SCHED_WHEEL_SIZE time units starting at the current simulation
+ * time, and a time step in that window lives in the bucket indexed by
+ * the low bits of its absolute time. Finding (or creating) the time
+ * step for a near-future event is therefore a single array lookup. A
+ * bitmap, with a summary word for every 64 bitmap words, marks the
+ * occupied buckets so that the next pending time step can be found
+ * without walking the empty buckets.
+ *
+ * Time steps that are too far in the future for the wheel are kept
+ * in an overflow heap ordered by time (and by creation order for
+ * equal times). When the simulation time advances, the overflow time
+ * steps that now fit in the window are moved into the wheel. Because
+ * the bucket index only depends on the absolute time, advancing the
+ * window never moves time steps that are already in the wheel.
+ *
+ * The sched_list is the earliest pending time step, or nil if there
+ * are no more events.
  */
+static const unsigned SCHED_WHEEL_BITS = 14;
+static const size_t SCHED_WHEEL_SIZE = (size_t)1 << SCHED_WHEEL_BITS;
+static const size_t SCHED_WHEEL_MASK = SCHED_WHEEL_SIZE - 1;
+static const size_t SCHED_MAP_WORDS = SCHED_WHEEL_SIZE / 64;
+static const size_t SCHED_SUM_WORDS = (SCHED_MAP_WORDS + 63) / 64;
+
+static struct event_time_s* sched_wheel[SCHED_WHEEL_SIZE];
+static uint64_t sched_wheel_map[SCHED_MAP_WORDS];
+static uint64_t sched_wheel_sum[SCHED_SUM_WORDS];
+
+struct sched_overflow_later_s {
+      bool operator() (const event_time_s*a, const event_time_s*b) const
+      {
+	    if (a->time != b->time)
+		  return a->time > b->time;
+	    return a->seq > b->seq;
+      }
+};
+
+static vector<struct event_time_s*> sched_overflow;
+static struct event_time_s* sched_overflow_last = 0;
+static unsigned long sched_overflow_seq = 0;
+unsigned long count_time_overflow = 0;
+
 static struct event_time_s* sched_list = 0;
 
+static vvp_time64_t schedule_time;
+
+static inline unsigned sched_ctz_(uint64_t val)
+{
+#if defined(__GNUC__)
+      return __builtin_ctzll(val);
+#else
+      unsigned res = 0;
+      while ((val & 1) == 0) {
+	    val >>= 1;
+	    res += 1;
+      }
+      return res;
+#endif
+}
+
+static inline void sched_wheel_mark_(size_t idx)
+{
+      size_t word = idx / 64;
+      sched_wheel_map[word] |= (uint64_t)1 << (idx % 64);
+      sched_wheel_sum[word / 64] |= (uint64_t)1 << (word % 64);
+}
+
+static inline void sched_wheel_clear_(size_t idx)
+{
+      size_t word = idx / 64;
+      sched_wheel_map[word] &= ~((uint64_t)1 << (idx % 64));
+      if (sched_wheel_map[word] == 0)
+	    sched_wheel_sum[word / 64] &= ~((uint64_t)1 << (word % 64));
+}
+
+/*
+ * Return the index of the first occupied bucket at or after idx,
+ * without wrapping around. Return SCHED_WHEEL_SIZE if there is none.
+ */
+static size_t sched_wheel_scan_(size_t idx)
+{
+      size_t word = idx / 64;
+      uint64_t bits = sched_wheel_map[word] & (~(uint64_t)0 << (idx % 64));
+      if (bits)
+	    return word*64 + sched_ctz_(bits);
+
+      word += 1;
+      if (word >= SCHED_MAP_WORDS)
+	    return SCHED_WHEEL_SIZE;
+
+      size_t sum = word / 64;
+      bits = sched_wheel_sum[sum] & (~(uint64_t)0 << (word % 64));
+      while (bits == 0) {
+	    sum += 1;
+	    if (sum >= SCHED_SUM_WORDS)
+		  return SCHED_WHEEL_SIZE;
+	    bits = sched_wheel_sum[sum];
+      }
+
+      word = sum*64 + sched_ctz_(bits);
+      return word*64 + sched_ctz_(sched_wheel_map[word]);
+}
+
+/*
+ * Append the src event list to the end of the dst event list.
+ */
+static void sched_append_queue_(struct event_s*&dst, struct event_s*src)
+{
+      if (src == 0)
+	    return;
+      if (dst) {
+	    struct event_s*head = dst->next;
+	    dst->next = src->next;
+	    src->next = head;
+      }
+      dst = src;
+}
+
+/*
+ * Move an overflow time step into its wheel bucket. If the bucket
+ * already holds a time step (an earlier overflow time step for the
+ * same time) then the events are appended to that one, keeping the
+ * order in which they were scheduled.
+ */
+static void sched_wheel_insert_(struct event_time_s*ctim)
+{
+      size_t idx = ctim->time & SCHED_WHEEL_MASK;
+      struct event_time_s*cur = sched_wheel[idx];
+      if (cur == 0) {
+	    sched_wheel[idx] = ctim;
+	    sched_wheel_mark_(idx);
+	    return;
+      }
+
+      assert(cur->time == ctim->time);
+      sched_append_queue_(cur->start,    ctim->start);
+      sched_append_queue_(cur->active,   ctim->active);
+      sched_append_queue_(cur->inactive, ctim->inactive);
+      sched_append_queue_(cur->nbassign, ctim->nbassign);
+      sched_append_queue_(cur->rwsync,   ctim->rwsync);
+      sched_append_queue_(cur->rosync,   ctim->rosync);
+      sched_append_queue_(cur->del_thr,  ctim->del_thr);
+      if (sched_list == ctim)
+	    sched_list = cur;
+      delete ctim;
+}
+
+static void sched_wheel_remove_(struct event_time_s*ctim)
+{
+      size_t idx = ctim->time & SCHED_WHEEL_MASK;
+      assert(sched_wheel[idx] == ctim);
+      sched_wheel[idx] = 0;
+      sched_wheel_clear_(idx);
+}
+
+/*
+ * The simulation time has just advanced, so the window of the wheel
+ * has moved. Pull into the wheel the overflow time steps that now fit.
+ */
+static void sched_wheel_advance_(void)
+{
+      while (! sched_overflow.empty()) {
+	    struct event_time_s*ctim = sched_overflow.front();
+	    if (ctim->time - schedule_time >= SCHED_WHEEL_SIZE)
+		  break;
+
+	    pop_heap(sched_overflow.begin(), sched_overflow.end(),
+		     sched_overflow_later_s());
+	    sched_overflow.pop_back();
+	    if (ctim == sched_overflow_last)
+		  sched_overflow_last = 0;
+
+	    sched_wheel_insert_(ctim);
+      }
+}
+
+/*
+ * Locate the earliest pending time step. All the time steps in the
+ * wheel are at or after the current time and less than a full turn
+ * of the wheel away, so a circular scan starting at the bucket of the
+ * current time finds them in time order. Anything in the overflow
+ * heap is later than everything in the wheel.
+ */
+static struct event_time_s* sched_next_time_(void)
+{
+      size_t idx = sched_wheel_scan_(schedule_time & SCHED_WHEEL_MASK);
+      if (idx == SCHED_WHEEL_SIZE)
+	    idx = sched_wheel_scan_(0);
+      if (idx != SCHED_WHEEL_SIZE)
+	    return sched_wheel[idx];
+
+      if (sched_overflow.empty())
+	    return 0;
+
+      return sched_overflow.front();
+}
+
+/*
+ * Get the time step that is delay units after the current time,
+ * creating it if necessary.
+ */
+static struct event_time_s* sched_time_step_(vvp_time64_t delay)
+{
+      vvp_time64_t time = schedule_time + delay;
+      struct event_time_s*ctim;
+
+      if (delay < SCHED_WHEEL_SIZE) {
+	    size_t idx = time & SCHED_WHEEL_MASK;
+	    ctim = sched_wheel[idx];
+	    if (ctim == 0) {
+		  ctim = new struct event_time_s;
+		  ctim->time = time;
+		  sched_wheel[idx] = ctim;
+		  sched_wheel_mark_(idx);
+	    }
+	    assert(ctim->time == time);
+
+      } else if (sched_overflow_last && (sched_overflow_last->time == time)) {
+	    ctim = sched_overflow_last;
+
+      } else {
+	    count_time_overflow += 1;
+	    ctim = new struct event_time_s;
+	    ctim->time = time;
+	    ctim->seq = sched_overflow_seq++;
+	    sched_overflow.push_back(ctim);
+	    push_heap(sched_overflow.begin(), sched_overflow.end(),
+		      sched_overflow_later_s());
+	    sched_overflow_last = ctim;
+      }
+
+      if ((sched_list == 0) || (time < sched_list->time))
+	    sched_list = ctim;
+
+      return ctim;
+}
+
 /*
  * This is a list of initialization events. The setup puts
  * initializations in this list so that they happen before the
@@ -700,57 +976,7 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 			    event_queue_t select_queue)
 {
       cur->next = cur;
-      struct event_time_s*ctim = sched_list;
-
-      if (sched_list == 0) {
-	      /* Is the event_time list completely empty? Create the
-		 first event_time object. */
-	    ctim = new struct event_time_s;
-	    ctim->delay = delay;
-	    ctim->next  = 0;
-	    sched_list = ctim;
-
-      } else if (sched_list->delay > delay) {
-
-	      /* Am I looking for an event before the first event_time?
-		 If so, create a new event_time to go in front. */
-	    struct event_time_s*tmp = new struct event_time_s;
-	    tmp->delay = delay;
-	    tmp->next = ctim;
-	    ctim->delay -= delay;
-	    ctim = tmp;
-	    sched_list = ctim;
-
-      } else {
-	    struct event_time_s*prev = 0;
-
-	    while (ctim->next && (ctim->delay < delay)) {
-		  delay -= ctim->delay;
-		  prev = ctim;
-		  ctim = ctim->next;
-	    }
-
-	    if (ctim->delay > delay) {
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay;
-		  tmp->next  = prev->next;
-		  prev->next = tmp;
-
-		  tmp->next->delay -= delay;
-		  ctim = tmp;
-
-	    } else if (ctim->delay == delay) {
-
-	    } else {
-		  assert(ctim->next == 0);
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay - ctim->delay;
-		  tmp->next = 0;
-		  ctim->next = tmp;
-
-		  ctim = tmp;
-	    }
-      }
+      struct event_time_s*ctim = sched_time_step_(delay);
 
 	/* By this point, ctim is the event_time structure that is to
 	   receive the event at hand. Put the event in to the
@@ -796,17 +1022,19 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 		  (*q)->next = cur;
 	    }
 	    *q = cur;
+	    event_queued_();
       }
 }
 
 static void schedule_event_push_(struct event_s*cur)
 {
-      if ((sched_list == 0) || (sched_list->delay > 0)) {
+      if ((sched_list == 0) || (sched_list->time > schedule_time)) {
 	    schedule_event_(cur, 0, SEQ_ACTIVE);
 	    return;
       }
 
       struct event_time_s*ctim = sched_list;
+      event_queued_();
 
       if (ctim->active == 0) {
 	    cur->next = cur;
@@ -1074,7 +1302,6 @@ void schedule_at_end_of_simtime(vvp_gen_event_t obj, vvp_time64_t delay)
       schedule_event_(cur, delay, SEQ_RWSYNC);
 }
 
-static vvp_time64_t schedule_time;
 vvp_time64_t schedule_simtime(void)
 { return schedule_time; }
 
@@ -1082,6 +1309,26 @@ static bool sim_at_rosync = false;
 bool schedule_at_rosync(void)
 { return sim_at_rosync; }
 
+/*
+ * The region counts are the events run from each region. The
+ * inactive, nbassign and rwsync queues are run by moving them to the
+ * active queue, so they are counted when they are moved, and the
+ * events pulled from the active queue after that are not counted
+ * again as active events.
+ */
+static unsigned long queue_length_(const struct event_s*q)
+{
+      unsigned long res = 0;
+      if (q) {
+	    const struct event_s*cur = q;
+	    do {
+		  res += 1;
+		  cur = cur->next;
+	    } while (cur != q);
+      }
+      return res;
+}
+
 /*
  * The scheduler uses this function to drain the rosync events of the
  * current time. The ctim object is still in the event queue, because
@@ -1103,6 +1350,7 @@ static void run_rosync(struct event_time_s*ctim)
 		  ctim->rosync->next = cur->next;
 	    }
 
+	    event_run_(&count_region_rosync);
 	    cur->run_run();
 	    delete cur;
       }
@@ -1116,6 +1364,7 @@ static void run_rosync(struct event_time_s*ctim)
 		  ctim->del_thr->next = cur->next;
 	    }
 
+	    event_run_(&count_region_rosync);
 	    cur->run_run();
 	    delete cur;
       }
@@ -1129,6 +1378,9 @@ static void run_rosync(struct event_time_s*ctim)
 void schedule_simulate(void)
 {
       bool run_finals;
+	// The events moved to the active queue from a later region
+	// that have not yet been run. See queue_length_.
+      unsigned long moved_events = 0;
       sim_started = false;
 
       schedule_time = 0;
@@ -1190,17 +1442,18 @@ void schedule_simulate(void)
 
 	      /* If the time is advancing, then first run the
 		 postponed sync events. Run them all. */
-	    if (ctim->delay > 0) {
+	    if (ctim->time > schedule_time) {
 
 		  if (!schedule_runnable) break;
-		  schedule_time += ctim->delay;
+		  schedule_time = ctim->time;
+		  count_time_advances += 1;
+		  sched_wheel_advance_();
 		    /* When the design is being traced (we are emitting
 		     * file/line information) also print any time changes. */
 		  if (show_file_line) {
 			cerr << "Advancing to simulation time: "
 			     << schedule_time << endl;
 		  }
-		  ctim->delay = 0;
 
 		  vpiNextSimTime();
 		    // Process the cbAtStartOfSimTime callbacks.
@@ -1211,6 +1464,7 @@ void schedule_simulate(void)
 			} else {
 			      ctim->start->next = cur->next;
 			}
+			event_run_(&count_region_start);
 			cur->run_run();
 			delete (cur);
 		  }
@@ -1223,21 +1477,34 @@ void schedule_simulate(void)
 	    if (ctim->active == 0) {
 		  ctim->active = ctim->inactive;
 		  ctim->inactive = 0;
+		  if (count_events_flag) {
+			moved_events = queue_length_(ctim->active);
+			count_region_inactive += moved_events;
+		  }
 
 		  if (ctim->active == 0) {
 			ctim->active = ctim->nbassign;
 			ctim->nbassign = 0;
+			if (count_events_flag) {
+			      moved_events = queue_length_(ctim->active);
+			      count_region_nbassign += moved_events;
+			}
 
 			if (ctim->active == 0) {
 			      ctim->active = ctim->rwsync;
 			      ctim->rwsync = 0;
+			      if (count_events_flag) {
+				    moved_events = queue_length_(ctim->active);
+				    count_region_rwsync += moved_events;
+			      }
 
 				/* If out of rw events, then run the rosync
 				   events and delete this time step. This also
 				   deletes threads as needed. */
 			      if (ctim->active == 0) {
 				    run_rosync(ctim);
-				    sched_list = ctim->next;
+				    sched_wheel_remove_(ctim);
+				    sched_list = sched_next_time_();
 				    delete ctim;
 				    continue;
 			      }
@@ -1254,6 +1521,12 @@ void schedule_simulate(void)
 	    } else {
 		  ctim->active->next = cur->next;
 	    }
+	    if (moved_events > 0) {
+		  moved_events -= 1;
+		  event_run_(0);
+	    } else {
+		  event_run_(&count_region_active);
+	    }
 
 	    if (schedule_single_step_flag) {
 		  cur->single_step_display();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2002-2007 Stephen Williams (steve@icarus.com)
+ * Copyright (c) 2002-2026 Stephen Williams (steve@icarus.com)
  *
  *    This source code is free software; you can redistribute it
  *    and/or modify it in source code form under the terms of the GNU
@@ -18,11 +18,20 @@
  */
 
 # include  "statistics.h"
+# include  "version_base.h"
+# include  "version_tag.h"
+# include  "schedule.h"
+# include  <cstdio>
+# include  <cstring>
+# include  <cerrno>
 
 /*
  * This is a count of the instruction opcodes that were created.
  */
 unsigned long count_opcodes = 0;
+unsigned long count_opcodes_fused = 0;
+unsigned long count_opcodes_sig_special = 0;
+unsigned long count_opcodes_sig_generic = 0;
 
 unsigned long count_functors = 0;
 unsigned long count_functors_logic = 0;
@@ -37,3 +46,107 @@ unsigned long count_vpi_scopes = 0;
 
 size_t size_opcodes = 0;
 
+/*
+ * Write the run time statistics as a JSON object. This is meant for
+ * scripts that track the performance of a design from one run (or
+ * one version of vvp) to the next, so the counts are all given along
+ * with the rates that can be derived from them.
+ */
+bool write_statistics_json(const char*path, const char*design,
+			   double compile_seconds, double run_seconds)
+{
+      FILE*fd = fopen(path, "w");
+      if (fd == 0) {
+	    fprintf(stderr, "%s: Unable to write statistics: %s\n",
+		    path, strerror(errno));
+	    return false;
+      }
+
+      unsigned long long sim_time = schedule_simtime();
+
+      fprintf(fd, "{\n");
+      fprintf(fd, "  \"version\": \"%s (%s)\",\n", VERSION, VERSION_TAG);
+      fprintf(fd, "  \"design\": \"");
+      for (const char*cp = design ; *cp ; cp += 1) {
+	    unsigned char ch = *cp;
+	    if (ch == '"' || ch == '\\')
+		  fprintf(fd, "\\%c", ch);
+	    else if (ch < 0x20)
+		  fprintf(fd, "\\u%04x", ch);
+	    else
+		  fputc(ch, fd);
+      }
+      fprintf(fd, "\",\n");
+      fprintf(fd, "  \"compile_seconds\": %.6f,\n", compile_seconds);
+      fprintf(fd, "  \"run_seconds\": %.6f,\n", run_seconds);
+      fprintf(fd, "  \"simulation_time\": %llu,\n", sim_time);
+
+      fprintf(fd, "  \"netlist\": {\n");
+      fprintf(fd, "    \"functors\": %lu,\n", count_functors);
+      fprintf(fd, "    \"filters\": %lu,\n", count_filters);
+      fprintf(fd, "    \"vvp_nets\": %lu,\n", count_vvp_nets);
+      fprintf(fd, "    \"fanout_arrays\": %lu,\n", count_fanout_arrays);
+      fprintf(fd, "    \"gate_clusters\": %lu,\n", count_gate_clusters);
+      fprintf(fd, "    \"gate_cluster_gates\": %lu,\n", count_gate_cluster_gates);
+      fprintf(fd, "    \"sparse_memories\": %lu,\n", count_sparse_arrays);
+      fprintf(fd, "    \"sparse_pages\": %lu,\n", count_sparse_pages);
+      fprintf(fd, "    \"opcodes\": %lu,\n", count_opcodes);
+      fprintf(fd, "    \"scopes\": %lu\n", count_vpi_scopes);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"time_steps\": {\n");
+      fprintf(fd, "    \"created\": %lu,\n", count_time_events);
+      fprintf(fd, "    \"advanced\": %lu,\n", count_time_advances);
+      fprintf(fd, "    \"overflow\": %lu\n", count_time_overflow);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"events\": {\n");
+      fprintf(fd, "    \"executed\": %lu,\n", count_events_run);
+      fprintf(fd, "    \"peak_queue_depth\": %lu,\n", count_events_peak);
+      fprintf(fd, "    \"gate_cluster_runs\": %lu,\n", count_gate_cluster_runs);
+      fprintf(fd, "    \"delay_pulses_rejected\": %lu,\n",
+	      count_delay_pulses_rejected);
+      fprintf(fd, "    \"per_time_unit\": %.6g,\n",
+	      sim_time? (double)count_events_run / sim_time : 0.0);
+      fprintf(fd, "    \"per_time_step\": %.6g,\n",
+	      count_time_advances? (double)count_events_run / count_time_advances : 0.0);
+      fprintf(fd, "    \"per_second\": %.6g,\n",
+	      run_seconds > 0.0? count_events_run / run_seconds : 0.0);
+      fprintf(fd, "    \"regions\": {\n");
+      fprintf(fd, "      \"start\": %lu,\n", count_region_start);
+      fprintf(fd, "      \"active\": %lu,\n", count_region_active);
+      fprintf(fd, "      \"inactive\": %lu,\n", count_region_inactive);
+      fprintf(fd, "      \"nbassign\": %lu,\n", count_region_nbassign);
+      fprintf(fd, "      \"rwsync\": %lu,\n", count_region_rwsync);
+      fprintf(fd, "      \"rosync\": %lu\n", count_region_rosync);
+      fprintf(fd, "    },\n");
+      fprintf(fd, "    \"kinds\": {\n");
+      fprintf(fd, "      \"thread\": %lu,\n", count_thread_events);
+      fprintf(fd, "      \"assign\": %lu,\n", count_assign_events);
+      fprintf(fd, "      \"other\": %lu\n", count_gen_events);
+      fprintf(fd, "    }\n");
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"threads\": {\n");
+      fprintf(fd, "    \"created\": %lu,\n", count_thread_forks);
+      fprintf(fd, "    \"reaped\": %lu,\n", count_thread_reaps);
+      fprintf(fd, "    \"pool_hits\": %lu\n", count_thread_pool_hits);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"pools\": {\n");
+      fprintf(fd, "    \"time\": %lu,\n", count_time_pool());
+      fprintf(fd, "    \"threads\": %lu,\n", count_thread_pool());
+      fprintf(fd, "    \"assign_vec4\": %lu,\n", count_assign4_pool());
+      fprintf(fd, "    \"assign_vec8\": %lu,\n", count_assign8_pool());
+      fprintf(fd, "    \"assign_real\": %lu,\n", count_assign_real_pool());
+      fprintf(fd, "    \"assign_word\": %lu,\n", count_assign_aword_pool());
+      fprintf(fd, "    \"assign_word_real\": %lu,\n", count_assign_arword_pool());
+      fprintf(fd, "    \"generic\": %lu\n", count_gen_pool());
+      fprintf(fd, "  }\n");
+      fprintf(fd, "}\n");
+
+      bool ok = ferror(fd) == 0;
+      if (fclose(fd) != 0)
+	    ok = false;
+      return ok;
+}
@@ -27,6 +27,9 @@
 #endif
 
 extern unsigned long count_opcodes;
+extern unsigned long count_opcodes_fused;
+extern unsigned long count_opcodes_sig_special;
+extern unsigned long count_opcodes_sig_generic;
 extern unsigned long count_functors;
 extern unsigned long count_functors_logic;
 extern unsigned long count_functors_bufif;
@@ -34,6 +37,9 @@ extern unsigned long count_functors_resolv;
 extern unsigned long count_functors_sig;
 extern unsigned long count_filters;
 extern unsigned long count_vvp_nets;
+extern unsigned long count_fanout_arrays;
+extern unsigned long count_gate_clusters;
+extern unsigned long count_gate_cluster_gates;
 extern unsigned long count_vpi_nets;
 extern unsigned long count_vpi_scopes;
 
@@ -41,13 +47,32 @@ extern unsigned long count_net_arrays;
 extern unsigned long count_net_array_words;
 extern unsigned long count_var_arrays;
 extern unsigned long count_var_array_words;
+extern unsigned long count_sparse_arrays;
+extern unsigned long count_sparse_pages;
 extern unsigned long count_real_arrays;
 extern unsigned long count_real_array_words;
 
 
 extern unsigned long count_time_events;
+extern unsigned long count_time_advances;
+extern unsigned long count_time_overflow;
 extern unsigned long count_time_pool(void);
 
+extern bool count_events_flag;
+extern unsigned long count_region_start;
+extern unsigned long count_region_active;
+extern unsigned long count_region_inactive;
+extern unsigned long count_region_nbassign;
+extern unsigned long count_region_rwsync;
+extern unsigned long count_region_rosync;
+extern unsigned long count_events_run;
+extern unsigned long count_events_peak;
+
+extern unsigned long count_thread_forks;
+extern unsigned long count_thread_reaps;
+extern unsigned long count_thread_pool_hits;
+extern unsigned long count_thread_pool(void);
+
 extern unsigned long count_assign_events;
 extern unsigned long count_assign4_pool(void);
 extern unsigned long count_assign8_pool(void);
@@ -56,10 +81,20 @@ extern unsigned long count_assign_aword_pool(void);
 extern unsigned long count_assign_arword_pool(void);
 
 extern unsigned long count_gen_events;
+extern unsigned long count_gate_cluster_runs;
+extern unsigned long count_delay_pulses_rejected;
 extern unsigned long count_gen_pool(void);
 
+/*
+ * Write all the statistics to the path as a JSON object. The seconds
+ * are the CPU time taken to compile and to run the design.
+ */
+extern bool write_statistics_json(const char*path, const char*design,
+				  double compile_seconds, double run_seconds);
+
 extern size_t size_opcodes;
 extern size_t size_vvp_nets;
+extern size_t size_fanout_arrays;
 extern size_t size_vvp_net_funs;
 
 #endif /* IVL_statistics_H */
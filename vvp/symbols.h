@@ -70,13 +70,15 @@ class symbol_table_s {
       symbol_value_t sym_get_value(const char*key);
 
     private:
-      struct tree_node_*root;
+      struct symbol_slot_*slots_;
+      unsigned long mask_;
+      unsigned long count_;
       struct key_strings*str_chunk;
       unsigned str_used;
 
-      symbol_value_t find_value_(struct tree_node_*cur,
-				 const char*key, symbol_value_t val,
+      symbol_value_t find_value_(const char*key, symbol_value_t val,
 				 bool force_flag);
+      void grow_(void);
       char*key_strdup_(const char*str);
 };
 
@@ -76,6 +76,55 @@ struct vvp_udp_s *udp_find(const char *label)
       return (struct vvp_udp_s *)v.ptr;
 }
 
+/*
+ * The dense lookup tables are indexed by the input vector packed in
+ * base 3, 0, 1 and x for each position. They are only built when
+ * they stay small, which covers combinational primitives up to 11
+ * inputs and sequential primitives up to 8 inputs.
+ */
+static const unsigned long udp_lut_limit = 1UL << 19;
+
+static const unsigned long udp_pow3[] = {
+      1UL, 3UL, 9UL, 27UL, 81UL, 243UL, 729UL, 2187UL, 6561UL,
+      19683UL, 59049UL, 177147UL, 531441UL
+};
+static const unsigned udp_pow3_count = sizeof udp_pow3 / sizeof udp_pow3[0];
+
+static inline unsigned udp_lut_code(vvp_bit4_t val)
+{
+      switch (val) {
+	  case BIT4_0:
+	    return 0;
+	  case BIT4_1:
+	    return 1;
+	  default:
+	    return 2;
+      }
+}
+
+static void udp_unpack_state(udp_levels_table&cur, unsigned long state,
+			     unsigned count)
+{
+      cur.mask0 = 0;
+      cur.mask1 = 0;
+      cur.maskx = 0;
+      for (unsigned pp = 0 ;  pp < count ;  pp += 1) {
+	    unsigned long mask_bit = 1UL << pp;
+	    switch (state % 3) {
+		case 0:
+		  cur.mask0 |= mask_bit;
+		  break;
+		case 1:
+		  cur.mask1 |= mask_bit;
+		  break;
+		default:
+		  cur.maskx |= mask_bit;
+		  break;
+	    }
+	    state /= 3;
+      }
+}
+
 ostream& operator <<(ostream&o, const struct udp_levels_table&table)
 {
       o << "[" << hex << table.mask0
@@ -86,7 +135,7 @@ ostream& operator <<(ostream&o, const struct udp_levels_table&table)
 
 vvp_udp_s::vvp_udp_s(const char*label, char*name__, unsigned ports,
                      vvp_bit4_t init, bool type)
-: name_(name__), ports_(ports), init_(init), seq_(type)
+: lut_(0), name_(name__), ports_(ports), init_(init), seq_(type)
 {
       if (!udp_table)
 	    udp_table = new_symbol_table();
@@ -107,6 +156,7 @@ vvp_udp_s::vvp_udp_s(const char*label, char*name__, unsigned ports,
 
 vvp_udp_s::~vvp_udp_s()
 {
+      delete[] lut_;
       delete[] name_;
 }
 
@@ -193,6 +243,32 @@ vvp_bit4_t vvp_udp_comb_s::calculate_output(const udp_levels_table&cur,
       return test_levels(cur);
 }
 
+vvp_bit4_t vvp_udp_comb_s::lookup_output(unsigned long state, unsigned,
+					 unsigned, vvp_bit4_t)
+{
+      return (vvp_bit4_t)lut_[state];
+}
+
+/*
+ * Evaluate the rows once for every possible input vector. The table
+ * is attached to the definition, so all the instances share it.
+ */
+void vvp_udp_comb_s::compile_lut_()
+{
+      if (port_count() >= udp_pow3_count)
+	    return;
+      unsigned long states = udp_pow3[port_count()];
+      if (states > udp_lut_limit)
+	    return;
+
+      lut_ = new unsigned char[states];
+      for (unsigned long idx = 0 ;  idx < states ;  idx += 1) {
+	    udp_levels_table cur;
+	    udp_unpack_state(cur, idx, port_count());
+	    lut_[idx] = test_levels(cur);
+      }
+}
+
 static void or_based_on_char(udp_levels_table&cur, char flag,
 			     unsigned long mask_bit)
 {
@@ -292,6 +368,8 @@ void vvp_udp_comb_s::compile_table(char**tab)
 
       assert(nrows0 == nlevels0_);
       assert(nrows1 == nlevels1_);
+
+      compile_lut_();
 }
 
 vvp_udp_seq_s::vvp_udp_seq_s(const char*label, char*name__,
@@ -315,6 +393,8 @@ vvp_udp_seq_s::vvp_udp_seq_s(const char*label, char*name__,
       nedges0_ = 0;
       nedges1_ = 0;
       nedgesL_ = 0;
+
+      lut_states_ = 0;
 }
 
 vvp_udp_seq_s::~vvp_udp_seq_s()
@@ -672,6 +752,7 @@ void vvp_udp_seq_s::compile_table(char**tab)
       assert(idx_edg1 == nedges1_);
       assert(idx_edgL == nedgesL_);
 
+      compile_lut_();
 }
 
 bool operator == (const udp_levels_table&a, const udp_levels_table&b)
@@ -715,6 +796,64 @@ vvp_bit4_t vvp_udp_seq_s::calculate_output(const udp_levels_table&cur,
       return lev;
 }
 
+vvp_bit4_t vvp_udp_seq_s::lookup_output(unsigned long state, unsigned port,
+					unsigned prev, vvp_bit4_t cur_out)
+{
+      unsigned long idx = state
+			+ udp_lut_code(cur_out) * udp_pow3[port_count()];
+      return (vvp_bit4_t)lut_[(port*3 + prev) * lut_states_ + idx];
+}
+
+/*
+ * Fold calculate_output into a table. The entries where the changed
+ * input did not really change hold the current output, the entries
+ * where a level row matches hold that level result, and only the
+ * rest need the edge rows.
+ */
+void vvp_udp_seq_s::compile_lut_()
+{
+      if (port_count() + 1 >= udp_pow3_count)
+	    return;
+      lut_states_ = udp_pow3[port_count() + 1];
+      if (lut_states_ * 3 * port_count() > udp_lut_limit)
+	    return;
+
+      unsigned char*levels = new unsigned char[lut_states_];
+      for (unsigned long idx = 0 ;  idx < lut_states_ ;  idx += 1) {
+	    udp_levels_table cur;
+	    udp_unpack_state(cur, idx, port_count() + 1);
+	    levels[idx] = test_levels_(cur);
+      }
+
+      static const vvp_bit4_t code_bits[3] = { BIT4_0, BIT4_1, BIT4_X };
+      unsigned long out_weight = udp_pow3[port_count()];
+
+      lut_ = new unsigned char[lut_states_ * 3 * port_count()];
+      for (unsigned pp = 0 ;  pp < port_count() ;  pp += 1) {
+	    unsigned long weight = udp_pow3[pp];
+	    for (unsigned prev = 0 ;  prev < 3 ;  prev += 1) {
+		  unsigned char*blk = lut_ + (pp*3 + prev) * lut_states_;
+		  for (unsigned long idx = 0 ;  idx < lut_states_ ;  idx += 1) {
+			unsigned digit = (idx / weight) % 3;
+			if (digit == prev) {
+			      blk[idx] = code_bits[idx / out_weight];
+			      continue;
+			}
+			if (levels[idx] != BIT4_Z) {
+			      blk[idx] = levels[idx];
+			      continue;
+			}
+			udp_levels_table cur, old;
+			udp_unpack_state(cur, idx, port_count() + 1);
+			udp_unpack_state(old, idx - digit*weight + prev*weight,
+					 port_count());
+			blk[idx] = test_edges_(cur, old);
+		  }
+	    }
+      }
+      delete[] levels;
+}
+
 /*
  * This function tests the levels of the input with the additional
  * check match for the current output. It uses this to calculate a
@@ -908,6 +1047,7 @@ vvp_udp_fun_core::vvp_udp_fun_core(vvp_net_t*net, vvp_udp_s*def)
       current_.mask0 = 0;
       current_.mask1 = 0;
       current_.maskx = ~ ((-1UL) << port_count());
+      state_ = def_->has_lut()? udp_pow3[port_count()] - 1 : 0;
 
         // If the initial value is 0 or 1, schedule the initial assignment
         // normally, so that any sensitive always processes can be started
@@ -961,7 +1101,19 @@ void vvp_udp_fun_core::recv_vec4_from_inputs(unsigned port)
 	    break;
       }
 
-      vvp_bit4_t out_bit = def_->calculate_output(current_, prev, cur_out_);
+      vvp_bit4_t out_bit;
+      if (def_->has_lut()) {
+	      /* Move the packed state by the change of this digit. */
+	    unsigned prev_code = (prev.mask0 & mask)? 0
+			       : (prev.mask1 & mask)? 1 : 2;
+	    unsigned cur_code = (current_.mask0 & mask)? 0
+			      : (current_.mask1 & mask)? 1 : 2;
+	    state_ -= prev_code * udp_pow3[port];
+	    state_ += cur_code * udp_pow3[port];
+	    out_bit = def_->lookup_output(state_, port, prev_code, cur_out_);
+      } else {
+	    out_bit = def_->calculate_output(current_, prev, cur_out_);
+      }
 
       if (out_bit == cur_out_)
 	    return;
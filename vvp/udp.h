@@ -48,6 +48,19 @@ struct vvp_udp_s {
 					  const udp_levels_table&prev,
 					  vvp_bit4_t cur_out) =0;
 
+	// Primitives with few enough inputs have a dense lookup
+	// table that replaces the row scans of calculate_output. The
+	// state is the input vector packed in base 3 (0, 1, x for
+	// each input, first input least significant) and port/prev
+	// identify the input that changed and its previous value.
+      bool has_lut() const { return lut_ != 0; }
+      virtual vvp_bit4_t lookup_output(unsigned long state, unsigned port,
+				       unsigned prev, vvp_bit4_t cur_out) =0;
+
+    protected:
+	// The lookup table, shared by all instances of the primitive.
+      unsigned char*lut_;
+
     private:
       char *name_;
       unsigned ports_;
@@ -125,8 +138,12 @@ class vvp_udp_comb_s : public vvp_udp_s {
       vvp_bit4_t calculate_output(const udp_levels_table&cur,
 				  const udp_levels_table&prev,
 				  vvp_bit4_t cur_out) override;
+      vvp_bit4_t lookup_output(unsigned long state, unsigned port,
+			       unsigned prev, vvp_bit4_t cur_out) override;
 
     private:
+      void compile_lut_();
+
 	// Level sensitive rows of the device.
       struct udp_levels_table*levels0_;
       struct udp_levels_table*levels1_;
@@ -188,10 +205,19 @@ class vvp_udp_seq_s : public vvp_udp_s {
       vvp_bit4_t calculate_output(const udp_levels_table&cur,
 				  const udp_levels_table&prev,
 				  vvp_bit4_t cur_out) override;
+      vvp_bit4_t lookup_output(unsigned long state, unsigned port,
+			       unsigned prev, vvp_bit4_t cur_out) override;
 
     private:
       vvp_bit4_t test_levels_(const udp_levels_table&cur);
 
+	// The lookup table has a block of lut_states_ entries for
+	// each (port, prev) pair, indexed by the packed inputs with
+	// the current output as the most significant digit. Each
+	// entry is the final next output, edges already resolved.
+      void compile_lut_();
+      unsigned long lut_states_;
+
 	// Level sensitive rows of the device.
       struct udp_levels_table*levels0_;
       struct udp_levels_table*levels1_;
@@ -236,6 +262,8 @@ class vvp_udp_fun_core  : public vvp_wide_fun_core, private vvp_gen_event_s {
       vvp_udp_s*def_;
       vvp_bit4_t cur_out_;
       udp_levels_table current_;
+	// The current inputs packed for the lookup table.
+      unsigned long state_;
 };
 
 #endif /* IVL_udp_H */
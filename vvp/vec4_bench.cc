@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is a micro-benchmark for the vec4 kernels. It runs every
+ * kernel set that the CPU supports over vectors of a range of widths,
+ * checks that each set gets the same results as the generic kernels,
+ * and prints the time per call. Build it with "make vec4_bench".
+ *
+ *    vec4_bench [<iterations>]
+ */
+
+# include  "config.h"
+# include  "vec4_kernels.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <chrono>
+# include  <vector>
+
+using namespace std;
+
+static const unsigned widths[] = { 512, 1024, 2048, 4096, 8192 };
+
+static unsigned long random_word(unsigned long&seed)
+{
+      unsigned long res = 0;
+      for (unsigned idx = 0 ; idx < sizeof(unsigned long) ; idx += 2) {
+	    seed = seed * 1103515245UL + 12345UL;
+	    res = (res << 16) | ((seed >> 16) & 0xffff);
+      }
+      return res;
+}
+
+struct bench_vectors_s {
+      vector<unsigned long> abits, bbits, that_a, that_b;
+};
+
+static void make_vectors(bench_vectors_s&vec, unsigned words)
+{
+      unsigned long seed = words;
+      vec.abits.resize(words);
+      vec.bbits.resize(words);
+      vec.that_a.resize(words);
+      vec.that_b.resize(words);
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    vec.abits[idx] = random_word(seed);
+	    vec.that_a[idx] = random_word(seed);
+	      // Keep the XZ bits sparse, as they are in real designs.
+	    vec.bbits[idx] = random_word(seed) & random_word(seed) & random_word(seed);
+	    vec.that_b[idx] = random_word(seed) & random_word(seed) & random_word(seed);
+      }
+}
+
+  /* Fold the results of a pass into a checksum that is compared
+     against the generic kernels. */
+static unsigned long run_pass(const vec4_kernels_s*set, bench_vectors_s&vec,
+			      bench_vectors_s&tmp, unsigned words)
+{
+      unsigned long sum = 0;
+      tmp = vec;
+      sum += set->eeq(&vec.abits[0], &vec.that_a[0], words);
+      sum += set->eeq(&vec.abits[0], &tmp.abits[0], words) << 1;
+      sum += set->any(&vec.bbits[0], words) << 2;
+      sum += set->scan(&vec.abits[0], &vec.bbits[0], words) << 3;
+      sum ^= set->fold_xor(&vec.abits[0], words);
+      set->and4(&tmp.abits[0], &tmp.bbits[0], &vec.that_a[0], &vec.that_b[0], words);
+      set->or4(&tmp.abits[0], &tmp.bbits[0], &vec.abits[0], &vec.bbits[0], words);
+      set->xor4(&tmp.abits[0], &tmp.bbits[0], &vec.that_a[0], &vec.that_b[0], words);
+      set->invert4(&tmp.abits[0], &tmp.bbits[0], words);
+      sum += set->copy_diff(&tmp.that_a[0], &tmp.abits[0], words) << 6;
+      sum ^= set->fold_xor(&tmp.that_a[0], words);
+      sum ^= set->fold_xor(&tmp.bbits[0], words) >> 1;
+      return sum;
+}
+
+typedef chrono::steady_clock bench_clock;
+
+  /* The results of the timed calls go here so that the compiler
+     cannot drop the calls. */
+static volatile unsigned long bench_sink;
+
+static double elapsed_ns(bench_clock::time_point start, unsigned iterations)
+{
+      chrono::duration<double,nano> dt = bench_clock::now() - start;
+      return dt.count() / iterations;
+}
+
+static void bench_set(const vec4_kernels_s*set, bench_vectors_s&vec,
+		      unsigned words, unsigned iterations)
+{
+      bench_vectors_s tmp = vec;
+      unsigned long*abits = &tmp.abits[0];
+      unsigned long*bbits = &tmp.bbits[0];
+      const unsigned long*that_a = &vec.that_a[0];
+      const unsigned long*that_b = &vec.that_b[0];
+	// The any and eeq kernels are timed at their worst case, where
+	// they have to look at every word.
+      vector<unsigned long> zero (words, 0);
+      unsigned long sink = 0;
+      bench_clock::time_point start;
+
+      printf("  %-8s", set->name);
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    sink += set->eeq(abits, abits, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    sink += set->any(&zero[0], words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    sink += set->scan(abits, bbits, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    sink += set->fold_xor(abits, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    set->and4(abits, bbits, that_a, that_b, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    set->or4(abits, bbits, that_a, that_b, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    set->xor4(abits, bbits, that_a, that_b, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    set->invert4(abits, bbits, words);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      start = bench_clock::now();
+      for (unsigned idx = 0 ; idx < iterations ; idx += 1)
+	    sink += set->copy_diff(abits, that_a + (idx&1), words-1);
+      printf(" %8.1f", elapsed_ns(start, iterations));
+
+      printf("\n");
+      bench_sink = sink;
+}
+
+int main(int argc, char*argv[])
+{
+      unsigned iterations = 200000;
+      if (argc > 1)
+	    iterations = strtoul(argv[1], 0, 0);
+      if (iterations == 0) {
+	    fprintf(stderr, "usage: %s [<iterations>]\n", argv[0]);
+	    return 1;
+      }
+
+      printf("vec4 kernels selected: %s\n", vec4_kernels->name);
+      printf("times are ns per call\n");
+
+      int rc = 0;
+      for (unsigned wdx = 0 ; wdx < sizeof widths / sizeof widths[0] ; wdx += 1) {
+	    unsigned words = widths[wdx] / (8*sizeof(unsigned long));
+	    bench_vectors_s vec, tmp;
+	    make_vectors(vec, words);
+
+	    printf("\n%u bits:\n", widths[wdx]);
+	    printf("  %-8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "kernels",
+		   "eeq", "any", "scan", "fold_xor", "and4", "or4",
+		   "xor4", "invert4", "copy");
+
+	    unsigned long expect = run_pass(vec4_kernels_list[0], vec, tmp, words);
+	    bench_vectors_s expect_tmp = tmp;
+
+	    for (unsigned idx = 0 ; vec4_kernels_list[idx] ; idx += 1) {
+		  const vec4_kernels_s*set = vec4_kernels_list[idx];
+		  if (! vec4_kernels_supported(set)) {
+			printf("  %-8s (not supported by this CPU)\n", set->name);
+			continue;
+		  }
+
+		  unsigned long sum = run_pass(set, vec, tmp, words);
+		  if (sum != expect || tmp.abits != expect_tmp.abits
+		      || tmp.bbits != expect_tmp.bbits) {
+			printf("  %-8s MISMATCH against generic kernels\n", set->name);
+			rc = 1;
+			continue;
+		  }
+
+		  bench_set(set, vec, words, iterations);
+	    }
+      }
+
+      return rc;
+}
@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "vec4_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define VEC4_KERNELS_X86 1
+# include  <immintrin.h>
+#endif
+
+/*
+ * The generic kernels are plain word loops. They are also the tails
+ * of the SIMD kernels, for the words left over after the last full
+ * SIMD register.
+ */
+static bool generic_eeq(const unsigned long*a, const unsigned long*b, unsigned words)
+{
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    if (a[idx] != b[idx])
+		  return false;
+      }
+      return true;
+}
+
+static bool generic_any(const unsigned long*a, unsigned words)
+{
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    if (a[idx])
+		  return true;
+      }
+      return false;
+}
+
+static unsigned generic_scan(const unsigned long*abits, const unsigned long*bbits,
+			     unsigned words)
+{
+      unsigned long one = 0, xz = 0, zero = 0;
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    one |= abits[idx] & ~bbits[idx];
+	    xz |= bbits[idx];
+	    zero |= ~(abits[idx] | bbits[idx]);
+      }
+
+      unsigned res = 0;
+      if (one) res |= VEC4_SCAN_ONE;
+      if (xz) res |= VEC4_SCAN_XZ;
+      if (zero) res |= VEC4_SCAN_ZERO;
+      return res;
+}
+
+static unsigned long generic_fold_xor(const unsigned long*a, unsigned words)
+{
+      unsigned long res = 0;
+      for (unsigned idx = 0 ; idx < words ; idx += 1)
+	    res ^= a[idx];
+      return res;
+}
+
+static void generic_and4(unsigned long*abits, unsigned long*bbits,
+			 const unsigned long*that_a, const unsigned long*that_b,
+			 unsigned words)
+{
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    unsigned long tmp1 = abits[idx] | bbits[idx];
+	    unsigned long tmp2 = that_a[idx] | that_b[idx];
+	    abits[idx] = tmp1 & tmp2;
+	    bbits[idx] = (tmp1 & that_b[idx]) | (tmp2 & bbits[idx]);
+      }
+}
+
+static void generic_or4(unsigned long*abits, unsigned long*bbits,
+			const unsigned long*that_a, const unsigned long*that_b,
+			unsigned words)
+{
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    unsigned long tmp = abits[idx] | bbits[idx] | that_a[idx] | that_b[idx];
+	    bbits[idx] = ((~abits[idx] | bbits[idx]) & that_b[idx])
+		  | ((~that_a[idx] | that_b[idx]) & bbits[idx]);
+	    abits[idx] = tmp;
+      }
+}
+
+static void generic_xor4(unsigned long*abits, unsigned long*bbits,
+			 const unsigned long*that_a, const unsigned long*that_b,
+			 unsigned words)
+{
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    unsigned long bval = bbits[idx] | that_b[idx];
+	    bbits[idx] = bval;
+	    abits[idx] = (abits[idx] ^ that_a[idx]) | bval;
+      }
+}
+
+static void generic_invert4(unsigned long*abits, const unsigned long*bbits,
+			    unsigned words)
+{
+      for (unsigned idx = 0 ; idx < words ; idx += 1)
+	    abits[idx] = ~abits[idx] | bbits[idx];
+}
+
+static bool generic_copy_diff(unsigned long*dst, const unsigned long*src,
+			      unsigned words)
+{
+      unsigned long diff = 0;
+      for (unsigned idx = 0 ; idx < words ; idx += 1) {
+	    diff |= dst[idx] ^ src[idx];
+	    dst[idx] = src[idx];
+      }
+      return diff != 0;
+}
+
+static const vec4_kernels_s generic_kernels = {
+      "generic",
+      generic_eeq,
+      generic_any,
+      generic_scan,
+      generic_fold_xor,
+      generic_and4,
+      generic_or4,
+      generic_xor4,
+      generic_invert4,
+      generic_copy_diff
+};
+
+#ifdef VEC4_KERNELS_X86
+
+/*
+ * The SSE4.2 kernels. Only SSE2 and the SSE4.1 PTEST are really
+ * used, but SSE4.2 is the feature level that is checked for.
+ */
+# define SSE_KERNEL __attribute__((target("sse4.2")))
+static const unsigned SSE_WORDS = sizeof(__m128i) / sizeof(unsigned long);
+
+static inline SSE_KERNEL __m128i sse_load(const unsigned long*ptr)
+{
+      return _mm_loadu_si128((const __m128i*)ptr);
+}
+
+static inline SSE_KERNEL void sse_store(unsigned long*ptr, __m128i val)
+{
+      _mm_storeu_si128((__m128i*)ptr, val);
+}
+
+static SSE_KERNEL bool sse_eeq(const unsigned long*a, const unsigned long*b,
+			       unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i diff = _mm_xor_si128(sse_load(a+idx), sse_load(b+idx));
+	    if (! _mm_testz_si128(diff, diff))
+		  return false;
+      }
+      return generic_eeq(a+idx, b+idx, words-idx);
+}
+
+static SSE_KERNEL bool sse_any(const unsigned long*a, unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i val = sse_load(a+idx);
+	    if (! _mm_testz_si128(val, val))
+		  return true;
+      }
+      return generic_any(a+idx, words-idx);
+}
+
+static SSE_KERNEL unsigned sse_scan(const unsigned long*abits,
+				    const unsigned long*bbits, unsigned words)
+{
+      __m128i one = _mm_setzero_si128();
+      __m128i xz = _mm_setzero_si128();
+      __m128i ab = _mm_set1_epi32(-1);
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i aval = sse_load(abits+idx);
+	    __m128i bval = sse_load(bbits+idx);
+	    one = _mm_or_si128(one, _mm_andnot_si128(bval, aval));
+	    xz = _mm_or_si128(xz, bval);
+	    ab = _mm_and_si128(ab, _mm_or_si128(aval, bval));
+      }
+
+      unsigned res = generic_scan(abits+idx, bbits+idx, words-idx);
+      if (! _mm_testz_si128(one, one)) res |= VEC4_SCAN_ONE;
+      if (! _mm_testz_si128(xz, xz)) res |= VEC4_SCAN_XZ;
+      if (! _mm_test_all_ones(ab)) res |= VEC4_SCAN_ZERO;
+      return res;
+}
+
+static SSE_KERNEL unsigned long sse_fold_xor(const unsigned long*a, unsigned words)
+{
+      __m128i acc = _mm_setzero_si128();
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS)
+	    acc = _mm_xor_si128(acc, sse_load(a+idx));
+
+      unsigned long tmp[SSE_WORDS];
+      sse_store(tmp, acc);
+      return generic_fold_xor(tmp, SSE_WORDS) ^ generic_fold_xor(a+idx, words-idx);
+}
+
+static SSE_KERNEL void sse_and4(unsigned long*abits, unsigned long*bbits,
+				const unsigned long*that_a, const unsigned long*that_b,
+				unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i aval = sse_load(abits+idx);
+	    __m128i bval = sse_load(bbits+idx);
+	    __m128i that_bval = sse_load(that_b+idx);
+	    __m128i tmp1 = _mm_or_si128(aval, bval);
+	    __m128i tmp2 = _mm_or_si128(sse_load(that_a+idx), that_bval);
+	    sse_store(abits+idx, _mm_and_si128(tmp1, tmp2));
+	    sse_store(bbits+idx, _mm_or_si128(_mm_and_si128(tmp1, that_bval),
+					      _mm_and_si128(tmp2, bval)));
+      }
+      generic_and4(abits+idx, bbits+idx, that_a+idx, that_b+idx, words-idx);
+}
+
+static SSE_KERNEL void sse_or4(unsigned long*abits, unsigned long*bbits,
+			       const unsigned long*that_a, const unsigned long*that_b,
+			       unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i aval = sse_load(abits+idx);
+	    __m128i bval = sse_load(bbits+idx);
+	    __m128i that_aval = sse_load(that_a+idx);
+	    __m128i that_bval = sse_load(that_b+idx);
+	    __m128i tmp = _mm_or_si128(_mm_or_si128(aval, bval),
+				       _mm_or_si128(that_aval, that_bval));
+	      // (~a | b) & that_b is that_b & ~(a & ~b)
+	    __m128i lhs = _mm_andnot_si128(_mm_andnot_si128(bval, aval), that_bval);
+	    __m128i rhs = _mm_andnot_si128(_mm_andnot_si128(that_bval, that_aval), bval);
+	    sse_store(bbits+idx, _mm_or_si128(lhs, rhs));
+	    sse_store(abits+idx, tmp);
+      }
+      generic_or4(abits+idx, bbits+idx, that_a+idx, that_b+idx, words-idx);
+}
+
+static SSE_KERNEL void sse_xor4(unsigned long*abits, unsigned long*bbits,
+				const unsigned long*that_a, const unsigned long*that_b,
+				unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i bval = _mm_or_si128(sse_load(bbits+idx), sse_load(that_b+idx));
+	    __m128i aval = _mm_xor_si128(sse_load(abits+idx), sse_load(that_a+idx));
+	    sse_store(bbits+idx, bval);
+	    sse_store(abits+idx, _mm_or_si128(aval, bval));
+      }
+      generic_xor4(abits+idx, bbits+idx, that_a+idx, that_b+idx, words-idx);
+}
+
+static SSE_KERNEL void sse_invert4(unsigned long*abits, const unsigned long*bbits,
+				   unsigned words)
+{
+      __m128i ones = _mm_set1_epi32(-1);
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i aval = _mm_xor_si128(sse_load(abits+idx), ones);
+	    sse_store(abits+idx, _mm_or_si128(aval, sse_load(bbits+idx)));
+      }
+      generic_invert4(abits+idx, bbits+idx, words-idx);
+}
+
+static SSE_KERNEL bool sse_copy_diff(unsigned long*dst, const unsigned long*src,
+				     unsigned words)
+{
+      __m128i diff = _mm_setzero_si128();
+      unsigned idx = 0;
+      for ( ; idx + SSE_WORDS <= words ; idx += SSE_WORDS) {
+	    __m128i val = sse_load(src+idx);
+	    diff = _mm_or_si128(diff, _mm_xor_si128(sse_load(dst+idx), val));
+	    sse_store(dst+idx, val);
+      }
+      bool res = generic_copy_diff(dst+idx, src+idx, words-idx);
+      return res || ! _mm_testz_si128(diff, diff);
+}
+
+static const vec4_kernels_s sse_kernels = {
+      "sse4.2",
+      sse_eeq,
+      sse_any,
+      sse_scan,
+      sse_fold_xor,
+      sse_and4,
+      sse_or4,
+      sse_xor4,
+      sse_invert4,
+      sse_copy_diff
+};
+
+/*
+ * The AVX2 kernels are the SSE kernels with twice the width.
+ */
+# define AVX_KERNEL __attribute__((target("avx2")))
+static const unsigned AVX_WORDS = sizeof(__m256i) / sizeof(unsigned long);
+
+static inline AVX_KERNEL __m256i avx_load(const unsigned long*ptr)
+{
+      return _mm256_loadu_si256((const __m256i*)ptr);
+}
+
+static inline AVX_KERNEL void avx_store(unsigned long*ptr, __m256i val)
+{
+      _mm256_storeu_si256((__m256i*)ptr, val);
+}
+
+static AVX_KERNEL bool avx_eeq(const unsigned long*a, const unsigned long*b,
+			       unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i diff = _mm256_xor_si256(avx_load(a+idx), avx_load(b+idx));
+	    if (! _mm256_testz_si256(diff, diff))
+		  return false;
+      }
+      return generic_eeq(a+idx, b+idx, words-idx);
+}
+
+static AVX_KERNEL bool avx_any(const unsigned long*a, unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i val = avx_load(a+idx);
+	    if (! _mm256_testz_si256(val, val))
+		  return true;
+      }
+      return generic_any(a+idx, words-idx);
+}
+
+static AVX_KERNEL unsigned avx_scan(const unsigned long*abits,
+				    const unsigned long*bbits, unsigned words)
+{
+      __m256i one = _mm256_setzero_si256();
+      __m256i xz = _mm256_setzero_si256();
+      __m256i ones = _mm256_set1_epi32(-1);
+      __m256i ab = ones;
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i aval = avx_load(abits+idx);
+	    __m256i bval = avx_load(bbits+idx);
+	    one = _mm256_or_si256(one, _mm256_andnot_si256(bval, aval));
+	    xz = _mm256_or_si256(xz, bval);
+	    ab = _mm256_and_si256(ab, _mm256_or_si256(aval, bval));
+      }
+
+      unsigned res = generic_scan(abits+idx, bbits+idx, words-idx);
+      if (! _mm256_testz_si256(one, one)) res |= VEC4_SCAN_ONE;
+      if (! _mm256_testz_si256(xz, xz)) res |= VEC4_SCAN_XZ;
+      if (! _mm256_testc_si256(ab, ones)) res |= VEC4_SCAN_ZERO;
+      return res;
+}
+
+static AVX_KERNEL unsigned long avx_fold_xor(const unsigned long*a, unsigned words)
+{
+      __m256i acc = _mm256_setzero_si256();
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS)
+	    acc = _mm256_xor_si256(acc, avx_load(a+idx));
+
+      unsigned long tmp[AVX_WORDS];
+      avx_store(tmp, acc);
+      return generic_fold_xor(tmp, AVX_WORDS) ^ generic_fold_xor(a+idx, words-idx);
+}
+
+static AVX_KERNEL void avx_and4(unsigned long*abits, unsigned long*bbits,
+				const unsigned long*that_a, const unsigned long*that_b,
+				unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i aval = avx_load(abits+idx);
+	    __m256i bval = avx_load(bbits+idx);
+	    __m256i that_bval = avx_load(that_b+idx);
+	    __m256i tmp1 = _mm256_or_si256(aval, bval);
+	    __m256i tmp2 = _mm256_or_si256(avx_load(that_a+idx), that_bval);
+	    avx_store(abits+idx, _mm256_and_si256(tmp1, tmp2));
+	    avx_store(bbits+idx, _mm256_or_si256(_mm256_and_si256(tmp1, that_bval),
+						 _mm256_and_si256(tmp2, bval)));
+      }
+      generic_and4(abits+idx, bbits+idx, that_a+idx, that_b+idx, words-idx);
+}
+
+static AVX_KERNEL void avx_or4(unsigned long*abits, unsigned long*bbits,
+			       const unsigned long*that_a, const unsigned long*that_b,
+			       unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i aval = avx_load(abits+idx);
+	    __m256i bval = avx_load(bbits+idx);
+	    __m256i that_aval = avx_load(that_a+idx);
+	    __m256i that_bval = avx_load(that_b+idx);
+	    __m256i tmp = _mm256_or_si256(_mm256_or_si256(aval, bval),
+					  _mm256_or_si256(that_aval, that_bval));
+	    __m256i lhs = _mm256_andnot_si256(_mm256_andnot_si256(bval, aval), that_bval);
+	    __m256i rhs = _mm256_andnot_si256(_mm256_andnot_si256(that_bval, that_aval), bval);
+	    avx_store(bbits+idx, _mm256_or_si256(lhs, rhs));
+	    avx_store(abits+idx, tmp);
+      }
+      generic_or4(abits+idx, bbits+idx, that_a+idx, that_b+idx, words-idx);
+}
+
+static AVX_KERNEL void avx_xor4(unsigned long*abits, unsigned long*bbits,
+				const unsigned long*that_a, const unsigned long*that_b,
+				unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i bval = _mm256_or_si256(avx_load(bbits+idx), avx_load(that_b+idx));
+	    __m256i aval = _mm256_xor_si256(avx_load(abits+idx), avx_load(that_a+idx));
+	    avx_store(bbits+idx, bval);
+	    avx_store(abits+idx, _mm256_or_si256(aval, bval));
+      }
+      generic_xor4(abits+idx, bbits+idx, that_a+idx, that_b+idx, words-idx);
+}
+
+static AVX_KERNEL void avx_invert4(unsigned long*abits, const unsigned long*bbits,
+				   unsigned words)
+{
+      __m256i ones = _mm256_set1_epi32(-1);
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i aval = _mm256_xor_si256(avx_load(abits+idx), ones);
+	    avx_store(abits+idx, _mm256_or_si256(aval, avx_load(bbits+idx)));
+      }
+      generic_invert4(abits+idx, bbits+idx, words-idx);
+}
+
+static AVX_KERNEL bool avx_copy_diff(unsigned long*dst, const unsigned long*src,
+				     unsigned words)
+{
+      __m256i diff = _mm256_setzero_si256();
+      unsigned idx = 0;
+      for ( ; idx + AVX_WORDS <= words ; idx += AVX_WORDS) {
+	    __m256i val = avx_load(src+idx);
+	    diff = _mm256_or_si256(diff, _mm256_xor_si256(avx_load(dst+idx), val));
+	    avx_store(dst+idx, val);
+      }
+      bool res = generic_copy_diff(dst+idx, src+idx, words-idx);
+      return res || ! _mm256_testz_si256(diff, diff);
+}
+
+static const vec4_kernels_s avx_kernels = {
+      "avx2",
+      avx_eeq,
+      avx_any,
+      avx_scan,
+      avx_fold_xor,
+      avx_and4,
+      avx_or4,
+      avx_xor4,
+      avx_invert4,
+      avx_copy_diff
+};
+
+#endif
+
+const vec4_kernels_s*const vec4_kernels_list[] = {
+      &generic_kernels,
+#ifdef VEC4_KERNELS_X86
+      &sse_kernels,
+      &avx_kernels,
+#endif
+      0
+};
+
+bool vec4_kernels_supported(const vec4_kernels_s*set)
+{
+#ifdef VEC4_KERNELS_X86
+      if (set == &sse_kernels)
+	    return __builtin_cpu_supports("sse4.2");
+      if (set == &avx_kernels)
+	    return __builtin_cpu_supports("avx2");
+#endif
+      return set == &generic_kernels;
+}
+
+/*
+ * Until the CPU is checked, the generic kernels are used. They give
+ * the same results, so it does not matter if a static constructor
+ * elsewhere happens to run first.
+ */
+const vec4_kernels_s*vec4_kernels = &generic_kernels;
+
+static struct vec4_kernels_select_s {
+      vec4_kernels_select_s()
+      {
+#ifdef VEC4_KERNELS_X86
+	    __builtin_cpu_init();
+#endif
+	    for (unsigned idx = 0 ; vec4_kernels_list[idx] ; idx += 1) {
+		  if (vec4_kernels_supported(vec4_kernels_list[idx]))
+			vec4_kernels = vec4_kernels_list[idx];
+	    }
+      }
+} vec4_kernels_select;
@@ -0,0 +1,74 @@
+#ifndef IVL_vec4_kernels_H
+#define IVL_vec4_kernels_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * These are the bulk operations on the abits/bbits word arrays of
+ * wide vvp_vector4_t objects. All the kernels work on whole words;
+ * the caller takes care of masking a partial last word. There is a
+ * generic version of each kernel, and on x86 hosts there are also
+ * SSE4.2 and AVX2 versions. The best set that the CPU supports is
+ * selected at startup and made available through vec4_kernels.
+ */
+struct vec4_kernels_s {
+      const char*name;
+	// Return true if the arrays are identical.
+      bool (*eeq)(const unsigned long*a, const unsigned long*b, unsigned words);
+	// Return true if any bit of the array is set.
+      bool (*any)(const unsigned long*a, unsigned words);
+	// Return the VEC4_SCAN_* flags that describe the bits.
+      unsigned (*scan)(const unsigned long*abits, const unsigned long*bbits,
+		       unsigned words);
+	// Return the XOR of all the words of the array.
+      unsigned long (*fold_xor)(const unsigned long*a, unsigned words);
+	// The 4-value logic operators, with the result replacing the
+	// (abits,bbits) operand.
+      void (*and4)(unsigned long*abits, unsigned long*bbits,
+		   const unsigned long*that_a, const unsigned long*that_b,
+		   unsigned words);
+      void (*or4)(unsigned long*abits, unsigned long*bbits,
+		  const unsigned long*that_a, const unsigned long*that_b,
+		  unsigned words);
+      void (*xor4)(unsigned long*abits, unsigned long*bbits,
+		   const unsigned long*that_a, const unsigned long*that_b,
+		   unsigned words);
+	// abits = ~abits | bbits
+      void (*invert4)(unsigned long*abits, const unsigned long*bbits,
+		      unsigned words);
+	// Copy the array and return true if the destination changed.
+      bool (*copy_diff)(unsigned long*dst, const unsigned long*src,
+			unsigned words);
+};
+
+  /* The flags returned by the scan kernel. */
+enum { VEC4_SCAN_ONE  = 0x1,  // Some bit is 1
+       VEC4_SCAN_XZ   = 0x2,  // Some bit is X or Z
+       VEC4_SCAN_ZERO = 0x4   // Some bit is 0
+};
+
+extern const vec4_kernels_s*vec4_kernels;
+
+  /* All the kernel sets built into this program, generic first,
+     terminated by a nil pointer. Only the sets for which
+     vec4_kernels_supported() is true may be called. */
+extern const vec4_kernels_s*const vec4_kernels_list[];
+extern bool vec4_kernels_supported(const vec4_kernels_s*set);
+
+#endif /* IVL_vec4_kernels_H */
@@ -37,6 +37,7 @@
 # include  <cstdio>
 # include  <cassert>
 # include  <cstdlib>
+# include  <vector>
 
 using namespace std;
 
@@ -799,12 +800,267 @@ vpiHandle vpi_register_cb(p_cb_data data)
 PLI_INT32 vpi_remove_cb(vpiHandle ref)
 {
       struct __vpiCallback*obj = dynamic_cast<__vpiCallback*>(ref);
-      assert(obj);
+      if (obj == 0) {
+	    fprintf(stderr, "vpi error: vpi_remove_cb() was given an "
+		    "object that is not a callback (type code %d).\n",
+		    ref ? ref->get_type_code() : 0);
+	    return 0;
+      }
       obj->cb_data.cb_rtn = 0;
 
       return 1;
 }
 
+/*
+ * A change set gathers the value changes of its members during a time
+ * step and reports them all with a single call in the ReadOnlySync
+ * region. A value change only sets the dirty flag of the member and,
+ * the first time, appends its index to the changed list. The first
+ * change in a time step also schedules the event that calls the user.
+ *
+ * A signal or real variable member is hooked directly into the list of
+ * change set members of its filter, which run_vpi_callbacks walks
+ * before the callbacks. The other kinds of objects that support
+ * cbValueChange (memory words, part selects, named events) get an
+ * ordinary value change callback that marks the member.
+ */
+class change_set;
+
+struct change_set_event : public vvp_gen_event_s {
+      change_set*set;
+
+      ~change_set_event() override { }
+
+      virtual void run_run() override;
+};
+
+struct change_set_member {
+	// The next member hooked into the same filter.
+      change_set_member*next;
+      change_set*set;
+      PLI_UINT32 idx;
+	// Either the filter the member is hooked into, or the value
+	// change callback that marks the member.
+      vvp_vpi_callback*fil;
+      vpiHandle cb;
+};
+
+class change_set : public __vpiHandle {
+    public:
+      change_set(PLI_INT32 (*rtn)(p_vpip_change_set_data), PLI_BYTE8*data);
+      ~change_set() override;
+
+      change_set(const change_set&) = delete;
+      change_set& operator=(const change_set&) = delete;
+
+      int get_type_code(void) const override;
+
+      PLI_INT32 add_member(vpiHandle obj);
+      inline void mark(PLI_UINT32 idx);
+      void run_changes();
+      void remove();
+
+      bool enabled;
+
+    private:
+      PLI_INT32 (*cb_rtn_)(p_vpip_change_set_data);
+      PLI_BYTE8*user_data_;
+      std::vector<change_set_member*> members_;
+      std::vector<bool> dirty_;
+      std::vector<PLI_UINT32> changed_;
+      change_set_event event_;
+      bool scheduled_;
+      bool removed_;
+};
+
+change_set::change_set(PLI_INT32 (*rtn)(p_vpip_change_set_data), PLI_BYTE8*data)
+: enabled(true), cb_rtn_(rtn), user_data_(data), scheduled_(false), removed_(false)
+{
+      event_.set = this;
+}
+
+change_set::~change_set()
+{
+      for (size_t idx = 0 ; idx < members_.size() ; idx += 1)
+	    delete members_[idx];
+}
+
+int change_set::get_type_code(void) const
+{ return _vpiChangeSet; }
+
+inline void change_set::mark(PLI_UINT32 idx)
+{
+      if (!enabled || dirty_[idx])
+	    return;
+
+      dirty_[idx] = true;
+      changed_.push_back(idx);
+      if (! scheduled_) {
+	    scheduled_ = true;
+	    schedule_generic(&event_, 0, true, true);
+      }
+}
+
+static PLI_INT32 change_set_member_cb(p_cb_data data)
+{
+      change_set_member*mem = (change_set_member*)data->user_data;
+      mem->set->mark(mem->idx);
+      return 0;
+}
+
+/*
+ * Return the filter that runs the value change callbacks of a signal
+ * or a real variable, or nil for the other kinds of objects.
+ */
+static vvp_vpi_callback*change_set_filter(vpiHandle obj)
+{
+      switch (obj->get_type_code()) {
+	  case vpiReg:
+	  case vpiNet:
+	  case vpiIntegerVar:
+	  case vpiBitVar:
+	  case vpiByteVar:
+	  case vpiShortIntVar:
+	  case vpiIntVar:
+	  case vpiLongIntVar: {
+		__vpiSignal*sig = dynamic_cast<__vpiSignal*>(obj);
+		assert(sig);
+		return dynamic_cast<vvp_net_fil_t*>(sig->node->fil);
+	  }
+
+	  case vpiRealVar: {
+		__vpiRealVar*rfp = dynamic_cast<__vpiRealVar*>(obj);
+		assert(rfp);
+		return dynamic_cast<vvp_vpi_callback*>(rfp->net->fil);
+	  }
+
+	  default:
+	    return 0;
+      }
+}
+
+PLI_INT32 change_set::add_member(vpiHandle obj)
+{
+      change_set_member*mem = new change_set_member;
+      mem->next = 0;
+      mem->set = this;
+      mem->idx = members_.size();
+      mem->fil = 0;
+      mem->cb = 0;
+
+	// Automatic variables are left to vpi_register_cb, which
+	// reports the error.
+      vvp_vpi_callback*fil = change_set_filter(obj);
+      if (fil && !::vpi_get(vpiAutomatic, obj)) {
+	    mem->fil = fil;
+	    fil->add_change_member(mem);
+	    members_.push_back(mem);
+	    dirty_.push_back(false);
+	    return mem->idx;
+      }
+
+      s_vpi_time tmp_time;
+      tmp_time.type = vpiSuppressTime;
+      s_cb_data cb;
+      cb.reason = cbValueChange;
+      cb.cb_rtn = change_set_member_cb;
+      cb.obj = obj;
+      cb.time = &tmp_time;
+      cb.value = 0;
+      cb.index = 0;
+      cb.user_data = reinterpret_cast<PLI_BYTE8*>(mem);
+      mem->cb = vpi_register_cb(&cb);
+      if (mem->cb == 0) {
+	    delete mem;
+	    return -1;
+      }
+
+      members_.push_back(mem);
+      dirty_.push_back(false);
+      return mem->idx;
+}
+
+void change_set::run_changes()
+{
+      if (!removed_ && !changed_.empty()) {
+	    s_vpip_change_set_data data;
+	    data.set = this;
+	    data.time.type = vpiSimTime;
+	    vpip_time_to_timestruct(&data.time, schedule_simtime());
+	    data.count = changed_.size();
+	    data.index = &changed_[0];
+	    data.user_data = user_data_;
+
+	    assert(vpi_mode_flag == VPI_MODE_NONE);
+	    vpi_mode_flag = VPI_MODE_ROSYNC;
+	    (cb_rtn_)(&data);
+	    vpi_mode_flag = VPI_MODE_NONE;
+      }
+
+      for (size_t idx = 0 ; idx < changed_.size() ; idx += 1)
+	    dirty_[changed_[idx]] = false;
+      changed_.clear();
+      scheduled_ = false;
+
+      if (removed_)
+	    delete this;
+}
+
+/*
+ * The members are unhooked right away, but if the event is already
+ * scheduled, then the set itself is deleted when the event runs.
+ */
+void change_set::remove()
+{
+      if (removed_)
+	    return;
+
+      removed_ = true;
+      for (size_t idx = 0 ; idx < members_.size() ; idx += 1) {
+	    change_set_member*mem = members_[idx];
+	    if (mem->fil)
+		  mem->fil->remove_change_member(mem);
+	    else
+		  vpi_remove_cb(mem->cb);
+      }
+
+      if (! scheduled_)
+	    delete this;
+}
+
+void change_set_event::run_run()
+{
+      set->run_changes();
+}
+
+vpiHandle vpip_make_change_set(PLI_INT32 (*cb_rtn)(p_vpip_change_set_data),
+			       PLI_BYTE8*user_data)
+{
+      assert(cb_rtn);
+      return new change_set(cb_rtn, user_data);
+}
+
+PLI_INT32 vpip_change_set_add(vpiHandle ref, vpiHandle obj)
+{
+      change_set*set = dynamic_cast<change_set*>(ref);
+      assert(set);
+      return set->add_member(obj);
+}
+
+void vpip_change_set_enable(vpiHandle ref, int flag)
+{
+      change_set*set = dynamic_cast<change_set*>(ref);
+      assert(set);
+      set->enabled = flag != 0;
+}
+
+void vpip_remove_change_set(vpiHandle ref)
+{
+      change_set*set = dynamic_cast<change_set*>(ref);
+      assert(set);
+      set->remove();
+}
+
 void callback_execute(struct __vpiCallback*cur)
 {
       const vpi_mode_t save_mode = vpi_mode_flag;
@@ -832,12 +1088,14 @@ struct __vpi_array_word {
 vvp_vpi_callback::vvp_vpi_callback()
 {
       vpi_callbacks_ = 0;
+      change_members_ = 0;
       array_words_ = 0;
 }
 
 vvp_vpi_callback::~vvp_vpi_callback()
 {
       assert(vpi_callbacks_ == 0);
+      assert(change_members_ == 0);
       assert(array_words_ == 0);
 }
 
@@ -856,6 +1114,23 @@ void vvp_vpi_callback::add_vpi_callback(value_callback*cb)
       vpi_callbacks_ = cb;
 }
 
+void vvp_vpi_callback::add_change_member(change_set_member*mem)
+{
+      mem->next = change_members_;
+      change_members_ = mem;
+}
+
+void vvp_vpi_callback::remove_change_member(change_set_member*mem)
+{
+      change_set_member**cur = &change_members_;
+      while (*cur != mem) {
+	    assert(*cur);
+	    cur = &(*cur)->next;
+      }
+      *cur = mem->next;
+      mem->next = 0;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void vvp_vpi_callback::clear_all_callbacks()
 {
@@ -865,6 +1140,8 @@ void vvp_vpi_callback::clear_all_callbacks()
 	    delete vpi_callbacks_;
 	    vpi_callbacks_ = tmp;
       }
+	// The change set members belong to their sets.
+      change_members_ = 0;
       while (array_words_) {
 	    struct __vpi_array_word*tmp = array_words_->next;
 	    delete array_words_;
@@ -887,6 +1164,9 @@ void vvp_vpi_callback::run_vpi_callbacks()
 	    array_word = array_word->next;
       }
 
+      for (change_set_member*mem = change_members_ ; mem ; mem = mem->next)
+	    mem->set->mark(mem->idx);
+
       value_callback *next = vpi_callbacks_;
       value_callback *prev = 0;
 
@@ -32,6 +32,7 @@
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
+# include  <vector>
 # include  "ivl_alloc.h"
 
 using namespace std;
@@ -275,6 +276,116 @@ void __vpiDarrayVar::vpi_get_value(p_vpi_value val)
       val->format = vpiSuppressVal;
 }
 
+/*
+ * Get or put a range of the elements of the dynamic array. The
+ * elements are moved through the same aval/bval words that the
+ * static arrays use.
+ */
+void __vpiDarrayVar::vpi_get_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+					 unsigned num)
+{
+      unsigned size = get_size();
+      if (index[0] < 0 || (unsigned long)index[0] + num > size) {
+	    fprintf(stderr, "VPI error: vpi_get_value_array: elements %ld "
+		    "through %ld are not all in %s.\n", (long)index[0],
+		    (long)index[0] + (long)num - 1, name_);
+	    return;
+      }
+
+      vvp_darray*aobj = get_vvp_darray();
+      unsigned base = index[0];
+
+      if (dynamic_cast<vvp_darray_real*>(aobj)) {
+	    if (! vpip_array_value_check(arr, true))
+		  return;
+	    vpip_array_value_alloc(arr, 0, num);
+	    for (unsigned idx = 0 ; idx < num ; idx += 1) {
+		  double val;
+		  aobj->get_word(base + idx, val);
+		  if (arr->format == vpiRealVal)
+			arr->value.reals[idx] = val;
+		  else
+			arr->value.shortreals[idx] = val;
+	    }
+	    return;
+      }
+
+      if (dynamic_cast<vvp_darray_string*>(aobj)
+	  || dynamic_cast<vvp_darray_object*>(aobj)) {
+	    fprintf(stderr, "vpi sorry: vpi_get_value_array is not "
+		    "implemented for string or object arrays.\n");
+	    return;
+      }
+
+      if (! vpip_array_value_check(arr, false))
+	    return;
+
+      unsigned width = get_word_size();
+      vpip_array_value_alloc(arr, width, num);
+
+      const unsigned bpw = 8*sizeof(unsigned long);
+      unsigned cnt = (width + bpw - 1) / bpw;
+      std::vector<unsigned long> bits (2*cnt);
+
+      for (unsigned idx = 0 ; idx < num ; idx += 1) {
+	    vvp_vector4_t val;
+	    aobj->get_word(base + idx, val);
+	    vpip_vec4_to_bits(val, &bits[0], &bits[cnt]);
+	    vpip_array_value_get(arr, idx, width, false, &bits[0], &bits[cnt]);
+      }
+}
+
+void __vpiDarrayVar::vpi_put_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+					 unsigned num)
+{
+      unsigned size = get_size();
+      if (index[0] < 0 || (unsigned long)index[0] + num > size) {
+	    fprintf(stderr, "VPI error: vpi_put_value_array: elements %ld "
+		    "through %ld are not all in %s.\n", (long)index[0],
+		    (long)index[0] + (long)num - 1, name_);
+	    return;
+      }
+
+      vvp_darray*aobj = get_vvp_darray();
+      unsigned base = index[0];
+      bool one_flag = (arr->flags & vpiOneValue) != 0;
+
+      if (dynamic_cast<vvp_darray_real*>(aobj)) {
+	    if (! vpip_array_value_check(arr, true))
+		  return;
+	    for (unsigned idx = 0 ; idx < num ; idx += 1) {
+		  unsigned src = one_flag? 0 : idx;
+		  double val = arr->format == vpiRealVal
+			     ? arr->value.reals[src]
+			     : arr->value.shortreals[src];
+		  aobj->set_word(base + idx, val);
+	    }
+	    return;
+      }
+
+      if (dynamic_cast<vvp_darray_string*>(aobj)
+	  || dynamic_cast<vvp_darray_object*>(aobj)) {
+	    fprintf(stderr, "vpi sorry: vpi_put_value_array is not "
+		    "implemented for string or object arrays.\n");
+	    return;
+      }
+
+      if (! vpip_array_value_check(arr, false))
+	    return;
+
+      unsigned width = get_word_size();
+      const unsigned bpw = 8*sizeof(unsigned long);
+      unsigned cnt = (width + bpw - 1) / bpw;
+      std::vector<unsigned long> bits (2*cnt);
+
+      for (unsigned idx = 0 ; idx < num ; idx += 1) {
+	    vpip_array_value_put(arr, one_flag? 0 : idx, width,
+				 &bits[0], &bits[cnt]);
+	    aobj->set_word(base + idx,
+			   vpip_bits_to_vec4(width, &bits[0], &bits[cnt]));
+      }
+}
+
 vvp_darray*__vpiDarrayVar::get_vvp_darray() const
 {
       vvp_fun_signal_object*fun = dynamic_cast<vvp_fun_signal_object*> (get_net()->fun);
@@ -409,7 +520,7 @@ void array_delete(vpiHandle item)
 
       __vpiDarrayVar*dobj = dynamic_cast<__vpiDarrayVar*>(item);
       if (dobj) {
-	    if (dobj->vals_words) delete [] (dobj->vals_words-1);
+	    if (dobj->vals_words) array_delete_words(dobj->vals_words);
 	    delete dobj;
 	    return;
       }
@@ -94,6 +94,18 @@ void __vpiHandle::vpi_get_delays(p_vpi_delay)
 void __vpiHandle::vpi_put_delays(p_vpi_delay)
 { }
 
+void __vpiHandle::vpi_get_value_array(p_vpi_arrayvalue, const PLI_INT32*, unsigned)
+{
+      fprintf(stderr, "VPI error: vpi_get_value_array is not supported "
+	              "for objects of type %d.\n", get_type_code());
+}
+
+void __vpiHandle::vpi_put_value_array(p_vpi_arrayvalue, const PLI_INT32*, unsigned)
+{
+      fprintf(stderr, "VPI error: vpi_put_value_array is not supported "
+	              "for objects of type %d.\n", get_type_code());
+}
+
 __vpiBaseVar::__vpiBaseVar(__vpiScope*scope, const char*name, vvp_net_t*net)
 : scope_(scope), name_(name), net_(net)
 {
@@ -844,6 +856,266 @@ void vpip_vec4_get_value(const vvp_vector4_t&word_val, unsigned width,
       }
 }
 
+/*
+ * The array value functions move the values through words of aval
+ * and bval longs, 8, 16 or 32 bits at a time. The chunks never
+ * straddle a long, and the bits past the width of the word are 0.
+ */
+static const unsigned BITS_PER_LONG = 8*sizeof(unsigned long);
+
+static inline unsigned long bits_chunk_(const unsigned long*bits,
+					unsigned off, unsigned wid)
+{
+      unsigned long val = bits[off/BITS_PER_LONG] >> (off%BITS_PER_LONG);
+      if (wid < BITS_PER_LONG)
+	    val &= (1UL << wid) - 1;
+      return val;
+}
+
+static inline void bits_set_chunk_(unsigned long*bits, unsigned off,
+				   unsigned wid, unsigned long val)
+{
+      if (wid < BITS_PER_LONG)
+	    val &= (1UL << wid) - 1;
+      bits[off/BITS_PER_LONG] |= val << (off%BITS_PER_LONG);
+}
+
+bool vpip_array_value_check(const s_vpi_arrayvalue*arr, bool real_flag)
+{
+      switch (arr->format) {
+	  case vpiIntVal:
+	  case vpiShortIntVal:
+	  case vpiLongIntVal:
+	  case vpiVectorVal:
+	  case vpiRawTwoStateVal:
+	  case vpiRawFourStateVal:
+	    if (! real_flag)
+		  return true;
+	    break;
+	  case vpiRealVal:
+	  case vpiShortRealVal:
+	    if (real_flag)
+		  return true;
+	    break;
+	  default:
+	    break;
+      }
+
+      fprintf(stderr, "vpi sorry: format %d is not implemented for %s "
+	              "array values.\n", (int)arr->format,
+	              real_flag? "real" : "vector");
+      return false;
+}
+
+void vpip_array_value_alloc(p_vpi_arrayvalue arr, unsigned width, unsigned num)
+{
+      if (arr->flags & vpiUserAllocFlag)
+	    return;
+
+      unsigned size = 0;
+      switch (arr->format) {
+	  case vpiIntVal:
+	    size = sizeof(PLI_INT32);
+	    break;
+	  case vpiShortIntVal:
+	    size = sizeof(PLI_INT16);
+	    break;
+	  case vpiLongIntVal:
+	    size = sizeof(PLI_INT64);
+	    break;
+	  case vpiVectorVal:
+	    size = (width + 31) / 32 * sizeof(s_vpi_vecval);
+	    break;
+	  case vpiRawTwoStateVal:
+	    size = (width + 7) / 8;
+	    break;
+	  case vpiRawFourStateVal:
+	    size = 2 * ((width + 7) / 8);
+	    break;
+	  case vpiRealVal:
+	    size = sizeof(double);
+	    break;
+	  case vpiShortRealVal:
+	    size = sizeof(float);
+	    break;
+      }
+
+      arr->value.rawvals = static_cast<PLI_BYTE8*>
+	    (need_result_buf(size * num, RBUF_ARR));
+}
+
+/*
+ * Get the word in abits/bbits into element idx of the array
+ * value. The integer formats read X and Z bits as 0, as vpiIntVal
+ * does, and the raw two state format does the same. The raw four
+ * state format holds the aval bytes of an element followed by its
+ * bval bytes.
+ */
+void vpip_array_value_get(p_vpi_arrayvalue arr, unsigned idx,
+			  unsigned width, bool signed_flag,
+			  const unsigned long*abits, const unsigned long*bbits)
+{
+      switch (arr->format) {
+	  case vpiIntVal:
+	  case vpiShortIntVal:
+	  case vpiLongIntVal: {
+		uint64_t val = 0;
+		unsigned cnt = width < 64? width : 64;
+		for (unsigned off = 0 ; off < cnt ; off += 32) {
+		      uint64_t tmp = bits_chunk_(abits, off, 32)
+			           & ~bits_chunk_(bbits, off, 32);
+		      val |= tmp << off;
+		}
+		if (signed_flag && width < 64 && ((val >> (width-1)) & 1))
+		      val |= ~UINT64_C(0) << width;
+
+		if (arr->format == vpiIntVal)
+		      arr->value.integers[idx] = (PLI_INT32)val;
+		else if (arr->format == vpiShortIntVal)
+		      arr->value.shortints[idx] = (PLI_INT16)val;
+		else
+		      arr->value.longints[idx] = (PLI_INT64)val;
+		break;
+	  }
+
+	  case vpiVectorVal: {
+		unsigned cnt = (width + 31) / 32;
+		p_vpi_vecval op = arr->value.vectors + idx*cnt;
+		for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+		      op[wdx].aval = bits_chunk_(abits, 32*wdx, 32);
+		      op[wdx].bval = bits_chunk_(bbits, 32*wdx, 32);
+		}
+		break;
+	  }
+
+	  case vpiRawTwoStateVal: {
+		unsigned cnt = (width + 7) / 8;
+		PLI_BYTE8*op = arr->value.rawvals + idx*cnt;
+		for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1)
+		      op[bdx] = bits_chunk_(abits, 8*bdx, 8)
+			      & ~bits_chunk_(bbits, 8*bdx, 8);
+		break;
+	  }
+
+	  case vpiRawFourStateVal: {
+		unsigned cnt = (width + 7) / 8;
+		PLI_BYTE8*op = arr->value.rawvals + idx*2*cnt;
+		for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1) {
+		      op[bdx] = bits_chunk_(abits, 8*bdx, 8);
+		      op[cnt+bdx] = bits_chunk_(bbits, 8*bdx, 8);
+		}
+		break;
+	  }
+
+	  default:
+	    assert(0);
+      }
+}
+
+/*
+ * Put element idx of the array value into abits/bbits. The integer
+ * formats are sign extended to the width of the word, as vpiIntVal
+ * is by vpi_put_value.
+ */
+void vpip_array_value_put(const s_vpi_arrayvalue*arr, unsigned idx,
+			  unsigned width, unsigned long*abits,
+			  unsigned long*bbits)
+{
+      unsigned cnt = (width + BITS_PER_LONG - 1) / BITS_PER_LONG;
+      for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+	    abits[wdx] = 0;
+	    bbits[wdx] = 0;
+      }
+
+      switch (arr->format) {
+	  case vpiIntVal:
+	  case vpiShortIntVal:
+	  case vpiLongIntVal: {
+		int64_t val;
+		if (arr->format == vpiIntVal)
+		      val = arr->value.integers[idx];
+		else if (arr->format == vpiShortIntVal)
+		      val = arr->value.shortints[idx];
+		else
+		      val = arr->value.longints[idx];
+
+		for (unsigned off = 0 ; off < width ; off += 32) {
+		      int64_t tmp = off < 64? val >> off : (val < 0? -1 : 0);
+		      bits_set_chunk_(abits, off, 32, (unsigned long)tmp);
+		}
+		break;
+	  }
+
+	  case vpiVectorVal: {
+		unsigned vcnt = (width + 31) / 32;
+		const s_vpi_vecval*op = arr->value.vectors + idx*vcnt;
+		for (unsigned wdx = 0 ; wdx < vcnt ; wdx += 1) {
+		      bits_set_chunk_(abits, 32*wdx, 32, (PLI_UINT32)op[wdx].aval);
+		      bits_set_chunk_(bbits, 32*wdx, 32, (PLI_UINT32)op[wdx].bval);
+		}
+		break;
+	  }
+
+	  case vpiRawTwoStateVal: {
+		unsigned bcnt = (width + 7) / 8;
+		const PLI_BYTE8*op = arr->value.rawvals + idx*bcnt;
+		for (unsigned bdx = 0 ; bdx < bcnt ; bdx += 1)
+		      bits_set_chunk_(abits, 8*bdx, 8, (PLI_UBYTE8)op[bdx]);
+		break;
+	  }
+
+	  case vpiRawFourStateVal: {
+		unsigned bcnt = (width + 7) / 8;
+		const PLI_BYTE8*op = arr->value.rawvals + idx*2*bcnt;
+		for (unsigned bdx = 0 ; bdx < bcnt ; bdx += 1) {
+		      bits_set_chunk_(abits, 8*bdx, 8, (PLI_UBYTE8)op[bdx]);
+		      bits_set_chunk_(bbits, 8*bdx, 8, (PLI_UBYTE8)op[bcnt+bdx]);
+		}
+		break;
+	  }
+
+	  default:
+	    assert(0);
+      }
+
+      if (unsigned tail = width % BITS_PER_LONG) {
+	    unsigned long mask = (1UL << tail) - 1;
+	    abits[cnt-1] &= mask;
+	    bbits[cnt-1] &= mask;
+      }
+}
+
+void vpip_vec4_to_bits(const vvp_vector4_t&val, unsigned long*abits,
+		       unsigned long*bbits)
+{
+      unsigned cnt = (val.size() + BITS_PER_LONG - 1) / BITS_PER_LONG;
+      for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+	    abits[wdx] = 0;
+	    bbits[wdx] = 0;
+      }
+
+      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
+	    unsigned long bit = val.value(idx);
+	    unsigned long mask = 1UL << (idx % BITS_PER_LONG);
+	    if (bit & 1)
+		  abits[idx/BITS_PER_LONG] |= mask;
+	    if (bit & 2)
+		  bbits[idx/BITS_PER_LONG] |= mask;
+      }
+}
+
+vvp_vector4_t vpip_bits_to_vec4(unsigned width, const unsigned long*abits,
+				const unsigned long*bbits)
+{
+      vvp_vector4_t val (width, BIT4_0);
+      for (unsigned idx = 0 ; idx < width ; idx += 1) {
+	    unsigned long abit = abits[idx/BITS_PER_LONG] >> (idx%BITS_PER_LONG);
+	    unsigned long bbit = bbits[idx/BITS_PER_LONG] >> (idx%BITS_PER_LONG);
+	    val.set_bit(idx, (vvp_bit4_t) ((abit&1) | ((bbit&1) << 1)));
+      }
+      return val;
+}
+
 void vpip_vec2_get_value(const vvp_vector2_t&word_val, unsigned width,
 			 bool signed_flag, s_vpi_value*vp)
 {
@@ -1231,6 +1503,45 @@ vpiHandle vpi_put_value(vpiHandle obj, s_vpi_value*vp,
       return 0;
 }
 
+void vpi_get_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
+			 PLI_INT32*index_p, PLI_UINT32 num)
+{
+      assert(object);
+      assert(arrayvalue_p);
+      assert(index_p);
+
+      if (num == 0)
+	    return;
+
+      object->vpi_get_value_array(arrayvalue_p, index_p, num);
+
+      if (vpi_trace) {
+	    fprintf(vpi_trace, "vpi_get_value_array(<%d>..., %d, %u) -> <%d>\n",
+		    object->get_type_code(), (int)index_p[0], (unsigned)num,
+		    (int)arrayvalue_p->format);
+      }
+}
+
+void vpi_put_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
+			 PLI_INT32*index_p, PLI_UINT32 num)
+{
+      assert(object);
+      assert(arrayvalue_p);
+      assert(index_p);
+
+      if (num == 0)
+	    return;
+
+      if (schedule_at_rosync()) {
+            fprintf(stderr, "VPI error: attempted to put a value to "
+			    "array '%s' during a read-only synch "
+			    "callback.\n", vpi_get_str(vpiName, object));
+            return;
+      }
+
+      object->vpi_put_value_array(arrayvalue_p, index_p, num);
+}
+
 vpiHandle vpi_handle(PLI_INT32 type, vpiHandle ref)
 {
       vpiHandle res = 0;
@@ -1354,41 +1665,14 @@ vpiHandle vpi_handle_by_index(vpiHandle ref, PLI_INT32 idx)
 
 static vpiHandle find_name(const char *name, vpiHandle handle)
 {
-      vpiHandle rtn = 0;
       __vpiScope*ref = dynamic_cast<__vpiScope*>(handle);
 
-      /* check module names */
-      if (!strcmp(name, vpi_get_str(vpiName, handle)))
+	/* Look for the name in the objects of this scope, and failing
+	   that check the module name. */
+      vpiHandle rtn = ref->find_intern(name);
+      if (rtn == 0 && !strcmp(name, vpi_get_str(vpiName, handle)))
 	    rtn = handle;
 
-      /* brute force search for the name in all objects in this scope */
-      for (unsigned i = 0 ;  i < ref->intern.size() ;  i += 1) {
-	      /* The standard says that since a port does not have a full
-	       * name it cannot be found by name. Because of this we need
-	       * to skip ports here so the correct handle can be located. */
-	    if (vpi_get(vpiType, ref->intern[i]) == vpiPort) continue;
-	    const char *nm = vpi_get_str(vpiName, ref->intern[i]);
-	    if (nm && !strcmp(name, nm)) {
-		  rtn = ref->intern[i];
-		  break;
-	    } else if (vpi_get(vpiType, ref->intern[i]) == vpiMemory ||
-	               vpi_get(vpiType, ref->intern[i]) == vpiNetArray) {
-		  /* We need to iterate on the words */
-		  vpiHandle word_i, word_h;
-		  word_i = vpi_iterate(vpiMemoryWord, ref->intern[i]);
-		  while (word_i && (word_h = vpi_scan(word_i))) {
-			nm = vpi_get_str(vpiName, word_h);
-			if (nm && !strcmp(name, nm)) {
-			      rtn = word_h;
-			      vpi_free_object(word_i);
-			      break;
-			}
-		  }
-	    }
-	    /* found it yet? */
-	    if (rtn) break;
-      }
-
       return rtn;
 }
 
@@ -1418,11 +1702,6 @@ static char * find_rest(char *name)
 
 static vpiHandle find_scope(const char *name, vpiHandle handle, int depth)
 {
-
-      vpiHandle iter = handle==0
-	    ? vpi_iterate(vpiModule, NULL)
-	    : vpi_iterate(vpiInternalScope, handle);
-
       vector<char> name_buf (strlen(name)+1);
       strcpy(&name_buf[0], name);
       char*nm_first = &name_buf[0];
@@ -1432,6 +1711,28 @@ static vpiHandle find_scope(const char *name, vpiHandle handle, int depth)
 	    *nm_rest++ = 0;
       }
 
+	/* Within a scope the name index usually has the sub-scope, so
+	   only scan the internal scopes if it does not. */
+      if (handle) {
+	    __vpiScope*scope = dynamic_cast<__vpiScope*>(handle);
+	    vpiHandle item = scope? scope->find_intern(nm_first) : 0;
+	    switch (item? vpi_get(vpiType, item) : 0) {
+		case vpiModule:
+		case vpiGenScope:
+		case vpiFunction:
+		case vpiTask:
+		case vpiNamedBegin:
+		case vpiNamedFork:
+		  return nm_rest? find_scope(nm_rest, item, depth+1) : item;
+		default:
+		  break;
+	    }
+      }
+
+      vpiHandle iter = handle==0
+	    ? vpi_iterate(vpiModule, NULL)
+	    : vpi_iterate(vpiInternalScope, handle);
+
       vpiHandle rtn = 0;
       vpiHandle hand;
       while (iter && (hand = vpi_scan(iter))) {
@@ -1567,6 +1868,13 @@ vpiHandle vpi_handle_by_name(const char *name, vpiHandle scope)
 		  tmp = find_scope(nm_path, hand, 0);
 	    }
 	    hand = tmp;
+	    if (hand == 0) {
+		  if (vpi_trace) {
+			fprintf(vpi_trace, "vpi_handle_by_name: "
+				"Path does not exist. Giving up.\n");
+		  }
+		  return 0;
+	    }
       }
 
 	// find_name() expects escaped identifiers to be stripped
@@ -1653,6 +1961,20 @@ tuple<bool, vvp_net_ptr_t, bool> check_connected_to_concat8(vvp_net_ptr_t cur, v
       return {false, vvp_net_ptr_t(nullptr, 0), false};
 }
 
+// The interconnect for port1 may be spliced into the fan-out of net or
+// of any of the concatenations and part selects that net reaches, as
+// found by the functions above.
+static void fanout_changed_from(vvp_net_t*net)
+{
+      net->fanout_changed();
+      for (vvp_net_ptr_t cur = net->out_ ; cur.ptr()
+		 ; cur = cur.ptr()->port[cur.port()]) {
+	    vvp_net_fun_t*fun = cur.ptr()->fun;
+	    if (dynamic_cast<vvp_fun_concat8*>(fun) || dynamic_cast<vvp_fun_part_sa*>(fun) || dynamic_cast<vvp_fun_concat*>(fun))
+		  fanout_changed_from(cur.ptr());
+      }
+}
+
 // Used to get intermodpath for two ports
 vpiHandle vpi_handle_multi(PLI_INT32 type,
                            vpiHandle ref1,
@@ -1790,6 +2112,10 @@ vpiHandle vpi_handle_multi(PLI_INT32 type,
 	    }
       }
 
+	// The interconnect is spliced into the fan-out chains below, so
+	// those nets must stop using their fan-out arrays.
+      fanout_changed_from(net1);
+
 	// Iterate over all nodes connected to port1
       vvp_net_ptr_t cur = net1->out_;
       vvp_net_ptr_t prev = vvp_net_ptr_t(nullptr, 0);
@@ -2102,5 +2428,11 @@ vpip_routines_s vpi_routines = {
     .make_systf_system_defined  = vpip_make_systf_system_defined,
     .mcd_rawwrite               = vpip_mcd_rawwrite,
     .set_return_value           = vpip_set_return_value,
+    .get_value_array            = vpi_get_value_array,
+    .put_value_array            = vpi_put_value_array,
+    .make_change_set            = vpip_make_change_set,
+    .change_set_add             = vpip_change_set_add,
+    .change_set_enable          = vpip_change_set_enable,
+    .remove_change_set          = vpip_remove_change_set,
 };
 #endif
@@ -25,6 +25,7 @@
 # include  "config.h"
 
 # include  <map>
+# include  <unordered_map>
 # include  <set>
 # include  <string>
 # include  <vector>
@@ -134,6 +135,10 @@ class __vpiHandle {
       virtual vpiHandle vpi_index(int idx);
       virtual void vpi_get_delays(p_vpi_delay del);
       virtual void vpi_put_delays(p_vpi_delay del);
+      virtual void vpi_get_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+				       unsigned num);
+      virtual void vpi_put_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+				       unsigned num);
 
 	// Objects may have destroyer functions of their own. If so,
 	// then this virtual method will return a POINTER to that
@@ -270,6 +275,12 @@ class __vpiScope : public __vpiHandle {
 	// TRUE if this is an automatic func/task/block
       inline bool is_automatic() const { return is_automatic_; }
 
+	// Find an item of this scope by its base name. This also
+	// finds the words of memories and net arrays by names like
+	// "mem[3]", but not ports, which have no name to be found
+	// by. Return nil if there is no such item.
+      vpiHandle find_intern(const char*name);
+
     public:
       __vpiScope *scope;
       unsigned file_idx;
@@ -306,6 +317,10 @@ class __vpiScope : public __vpiHandle {
       const char*tname_;
 	/* the scope may be "automatic" */
       bool is_automatic_;
+	/* Index of the intern items by name. It is built on the first
+	   find_intern() and catches up with any items attached since. */
+      std::unordered_map<std::string,vpiHandle> name_index_;
+      size_t name_indexed_;
 };
 
 class vpiScopeFunction  : public __vpiScope {
@@ -796,6 +811,10 @@ struct __vpiArray : public __vpiArrayBase, public __vpiHandle {
       vpiHandle vpi_handle(int code) override;
       inline vpiHandle vpi_iterate(int code) override { return vpi_array_base_iterate(code); }
       vpiHandle vpi_index(int idx) override;
+      void vpi_get_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+			       unsigned num) override;
+      void vpi_put_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+			       unsigned num) override;
 
       void set_word(unsigned idx, unsigned off, const vvp_vector4_t&val);
       void set_word(unsigned idx, double val);
@@ -810,6 +829,16 @@ struct __vpiArray : public __vpiArrayBase, public __vpiHandle {
       void alias_word(unsigned long addr, vpiHandle word, int msb, int lsb);
       void attach_word(unsigned addr, vpiHandle word);
       void word_change(unsigned long addr);
+	// Notify the readers of a range of words that were changed
+	// together. The ports with a variable address are checked
+	// once for the whole range.
+      void word_change(unsigned long base, unsigned long count);
+	// Notify the readers of a word, starting with the list of
+	// variable address ports given (which may be nil).
+      void word_change_(unsigned long addr, vvp_fun_arrayport*ports);
+
+	// Get the vpi handle for a word of a variable array.
+      struct __vpiArrayWord*get_vals_word(unsigned addr);
 
       const char*name; /* Permanently allocated string */
       __vpiDecConst first_addr;
@@ -822,9 +851,22 @@ struct __vpiArray : public __vpiArrayBase, public __vpiHandle {
 	// If this is a var array, then these are used instead of nets.
       vvp_vector4array_t*vals4;
       vvp_darray        *vals;
+	// If vals4 is sparse, the word handles are made a page at a
+	// time, as they are needed, instead of into vals_words.
+      struct __vpiArrayWord**word_pages;
 
+	// The read ports with a variable address. The ports with a
+	// constant address are in word_ports_, indexed by address.
       vvp_fun_arrayport*ports_;
+      std::unordered_map<unsigned long,vvp_fun_arrayport*> word_ports_;
+	// The callbacks on the whole array. The callbacks on single
+	// words are in word_callbacks_, indexed by address.
       struct __vpiCallback *vpi_callbacks;
+      std::unordered_map<unsigned long,struct __vpiCallback*> word_callbacks_;
+	// The number of word_change calls running. A callback may
+	// change a word of the array, and the nested calls must not
+	// delete callbacks that the outer calls are looking at.
+      unsigned word_change_depth_;
       bool signed_flag;
       bool swap_addr;
 
@@ -862,6 +904,10 @@ class __vpiDarrayVar : public __vpiBaseVar, public __vpiArrayBase {
       vpiHandle vpi_index(int index) override;
 
       void vpi_get_value(p_vpi_value val) override;
+      void vpi_get_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+			       unsigned num) override;
+      void vpi_put_value_array(p_vpi_arrayvalue arr, const PLI_INT32*index,
+			       unsigned num) override;
 
     protected:
       vvp_darray*get_vvp_darray() const;
@@ -1157,6 +1203,30 @@ extern void vpip_vec4_get_value(const vvp_vector4_t&word_val, unsigned width,
 extern void vpip_vec2_get_value(const vvp_vector2_t&word_val, unsigned width,
 				bool signed_flag, s_vpi_value*vp);
 extern void vpip_real_get_value(double real, s_vpi_value*vp);
+
+/*
+ * These functions, defined in vpi_priv.cc, move array values between
+ * a s_vpi_arrayvalue and words of aval/bval longs, laid out like the
+ * words of a vvp_vector4array_t. vpip_array_value_check prints a
+ * message and returns false if the format cannot be used for the
+ * array, and vpip_array_value_alloc supplies storage for the values
+ * if the caller did not. The idx is the position of the element in
+ * the s_vpi_arrayvalue.
+ */
+extern bool vpip_array_value_check(const s_vpi_arrayvalue*arr, bool real_flag);
+extern void vpip_array_value_alloc(p_vpi_arrayvalue arr, unsigned width,
+				   unsigned num);
+extern void vpip_array_value_get(p_vpi_arrayvalue arr, unsigned idx,
+				 unsigned width, bool signed_flag,
+				 const unsigned long*abits,
+				 const unsigned long*bbits);
+extern void vpip_array_value_put(const s_vpi_arrayvalue*arr, unsigned idx,
+				 unsigned width, unsigned long*abits,
+				 unsigned long*bbits);
+extern void vpip_vec4_to_bits(const vvp_vector4_t&val, unsigned long*abits,
+			      unsigned long*bbits);
+extern vvp_vector4_t vpip_bits_to_vec4(unsigned width, const unsigned long*abits,
+				       const unsigned long*bbits);
 extern void vpip_string_get_value(const std::string&val, s_vpi_value*vp);
 
 /*
@@ -1168,8 +1238,10 @@ enum vpi_rbuf_t {
 	/* Storage for *_get_value() */
       RBUF_STR,
 	/* Storage for *_get_str() */
+      RBUF_ARR,
+	/* Storage for vpi_get_value_array() */
       RBUF_DEL
-	/* Delete the storage for both buffers. */
+	/* Delete the storage for all the buffers. */
 };
 extern void *need_result_buf(unsigned cnt, vpi_rbuf_t type);
 /* following two routines use need_result_buf(, RBUF_STR) */
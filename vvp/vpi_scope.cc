@@ -339,12 +339,57 @@ static vpiHandle module_iter(int code, vpiHandle obj)
 
 
 __vpiScope::__vpiScope(const char*nam, const char*tnam, bool auto_flag)
-: is_automatic_(auto_flag)
+: is_automatic_(auto_flag), name_indexed_(0)
 {
       name_ = vpip_name_string(nam);
       tname_ = vpip_name_string(tnam? tnam : "");
 }
 
+vpiHandle __vpiScope::find_intern(const char*name)
+{
+      for ( ; name_indexed_ < intern.size() ; name_indexed_ += 1) {
+	    vpiHandle obj = intern[name_indexed_];
+	    if (::vpi_get(vpiType, obj) == vpiPort)
+		  continue;
+	    const char*nm = ::vpi_get_str(vpiName, obj);
+	      /* The first item of a name wins, as with a scan of the
+	         intern list. */
+	    if (nm)
+		  name_index_.insert(make_pair(string(nm), obj));
+      }
+
+      unordered_map<string,vpiHandle>::const_iterator cur
+	    = name_index_.find(name);
+      if (cur != name_index_.end())
+	    return cur->second;
+
+	/* Not a plain name, so maybe a word of a memory or net array.
+	   The index must be written the way the word names itself. */
+      const char*open = strrchr(name, '[');
+      size_t len = strlen(name);
+      if (open == 0 || open == name || name[len-1] != ']')
+	    return 0;
+
+      string idx_str (open+1, name+len-1);
+      char*end;
+      long idx = strtol(idx_str.c_str(), &end, 10);
+      char buf[64];
+      snprintf(buf, sizeof buf, "%ld", idx);
+      if (idx_str.empty() || *end != 0 || idx_str != buf)
+	    return 0;
+
+      cur = name_index_.find(string(name, open-name));
+      if (cur == name_index_.end())
+	    return 0;
+
+      vpiHandle array = cur->second;
+      int type = ::vpi_get(vpiType, array);
+      if (type != vpiMemory && type != vpiNetArray)
+	    return 0;
+
+      return ::vpi_handle_by_index(array, idx);
+}
+
 int __vpiScope::vpi_get(int code)
 {
       switch (code) {
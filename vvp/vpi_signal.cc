@@ -65,8 +65,8 @@ extern const char oct_digits[64];
  */
 void *need_result_buf(unsigned cnt, vpi_rbuf_t type)
 {
-      static void*result_buf[2] = {0, 0};
-      static size_t result_buf_size[2] = {0, 0};
+      static void*result_buf[3] = {0, 0, 0};
+      static size_t result_buf_size[3] = {0, 0, 0};
 
       if (type == RBUF_DEL) {
 	    free(result_buf[RBUF_VAL]);
@@ -77,6 +77,10 @@ void *need_result_buf(unsigned cnt, vpi_rbuf_t type)
 	    result_buf[RBUF_STR] = 0;
 	    result_buf_size[RBUF_STR] = 0;
 
+	    free(result_buf[RBUF_ARR]);
+	    result_buf[RBUF_ARR] = 0;
+	    result_buf_size[RBUF_ARR] = 0;
+
 	    return 0;
       }
 
@@ -28,6 +28,8 @@
 # include  "vvp_cobject.h"
 # include  "vvp_darray.h"
 # include  "class_type.h"
+# include  "statistics.h"
+# include  "profile.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
@@ -283,6 +285,9 @@ struct vthread_s {
       __vpiScope*parent_scope;
 	/* This is used for keeping wait queues. */
       struct vthread_s*wait_next;
+	/* The profiler records for this thread, if profiling. */
+      struct profile_proc_s*profile_proc;
+      struct profile_line_s*profile_line;
 	/* These are used to access automatically allocated items. */
       vvp_context_t wt_context, rd_context;
 	/* These are used to pass non-blocking event control information. */
@@ -740,17 +745,57 @@ void contexts_delete(class __vpiScope*scope)
 }
 #endif
 
+/*
+ * Thread objects are large (the flag and word registers are held
+ * inline) and designs that %fork in a loop create and reap them at a
+ * high rate. Deleted threads are therefore kept on a free list,
+ * chained through the wait_next member, and handed back out by
+ * vthread_new. A recycled thread has already been through cleanup(),
+ * so its stacks are empty, and the argument vectors keep whatever
+ * capacity they had. The list is capped so that a burst of forks
+ * does not pin that much memory for the rest of the simulation.
+ */
+static const unsigned long THREAD_POOL_MAX = 1024;
+static vthread_t thread_pool = 0;
+static unsigned long thread_pool_size = 0;
+
+unsigned long count_thread_forks = 0;
+unsigned long count_thread_reaps = 0;
+unsigned long count_thread_pool_hits = 0;
+
+unsigned long count_thread_pool(void)
+{
+      return thread_pool_size;
+}
+
 /*
  * Create a new thread with the given start address.
  */
 vthread_t vthread_new(vvp_code_t pc, __vpiScope*scope)
 {
-      vthread_t thr = new struct vthread_s;
+      vthread_t thr;
+      if (thread_pool) {
+	    thr = thread_pool;
+	    thread_pool = thr->wait_next;
+	    thread_pool_size -= 1;
+	    count_thread_pool_hits += 1;
+	    thr->args_real.clear();
+	    thr->args_str.clear();
+	    thr->args_vec4.clear();
+	    thr->detached_children.clear();
+	    assert(thr->children.empty());
+      } else {
+	    thr = new struct vthread_s;
+      }
+      count_thread_forks += 1;
+
       thr->pc     = pc;
 	//thr->bits4  = vvp_vector4_t(32);
       thr->parent = 0;
       thr->parent_scope = scope;
       thr->wait_next = 0;
+      thr->profile_proc = profile_flag? profile_process(pc, scope) : 0;
+      thr->profile_line = 0;
       thr->wt_context = 0;
       thr->rd_context = 0;
 
@@ -813,6 +858,16 @@ void vthreads_delete(class __vpiScope*scope)
       }
       scope->threads.clear();
 }
+
+void vthread_pool_delete()
+{
+      while (thread_pool) {
+	    vthread_t tmp = thread_pool->wait_next;
+	    delete thread_pool;
+	    thread_pool = tmp;
+      }
+      thread_pool_size = 0;
+}
 #endif
 
 /*
@@ -875,7 +930,15 @@ static void vthread_reap(vthread_t thr)
 void vthread_delete(vthread_t thr)
 {
       thr->cleanup();
-      delete thr;
+      count_thread_reaps += 1;
+      if (thread_pool_size >= THREAD_POOL_MAX) {
+	    delete thr;
+	    return;
+      }
+
+      thr->wait_next = thread_pool;
+      thread_pool = thr;
+      thread_pool_size += 1;
 }
 
 void vthread_mark_scheduled(vthread_t thr)
@@ -906,6 +969,51 @@ void vthread_delay_delete()
 	    running_thread->delay_delete = 1;
 }
 
+/*
+ * This is the vthread_run loop with the profiler counting. The time
+ * of each run of a thread is charged to its process, and a nested run
+ * (a function call) pauses the clock of the calling thread.
+ */
+static void vthread_run_profiled(vthread_t thr)
+{
+      profile_count_s*outer = profile_enter(0);
+
+      while (thr != 0) {
+	    vthread_t tmp = thr->wait_next;
+	    thr->wait_next = 0;
+
+	    assert(thr->is_scheduled);
+	    thr->is_scheduled = 0;
+
+            running_thread = thr;
+
+	    profile_proc_s*proc = thr->profile_proc;
+	    profile_enter(proc);
+	    proc->runs += 1;
+
+	    for (;;) {
+		  vvp_code_t cp = thr->pc;
+		  thr->pc += 1;
+
+		  if (cp->opcode == &of_FILE_LINE)
+			thr->profile_line = profile_line(cp->handle);
+		  unsigned count = profile_opcode_length(cp->opcode);
+		  proc->instructions += count;
+		  if (thr->profile_line)
+			thr->profile_line->instructions += count;
+
+		  bool rc = (cp->opcode)(thr, cp);
+		  if (rc == false)
+			break;
+	    }
+
+	    thr = tmp;
+      }
+      running_thread = 0;
+
+      profile_enter(outer);
+}
+
 /*
  * This function runs each thread by fetching an instruction,
  * incrementing the PC, and executing the instruction. The thread may
@@ -913,6 +1021,11 @@ void vthread_delay_delete()
  */
 void vthread_run(vthread_t thr)
 {
+      if (profile_flag) {
+	    vthread_run_profiled(thr);
+	    return;
+      }
+
       while (thr != 0) {
 	    vthread_t tmp = thr->wait_next;
 	    thr->wait_next = 0;
@@ -1194,6 +1307,35 @@ bool of_ASSIGN_ARE(vthread_t thr, vvp_code_t cp)
 /*
  * %assign/vec4 <var>, <delay>
  */
+/*
+ * These select how an opcode that works on a signal gets at the
+ * vvp_signal_value of that signal. The generic form uses RTTI every
+ * time the instruction executes. The vvp_code_specialize() function
+ * replaces generic opcodes with variants that use one of the other
+ * forms when the kind of the signal is known at load time.
+ */
+struct sig_any_s {
+      typedef vvp_signal_value sig_t;
+      static sig_t* get(vvp_code_t cp)
+      { return dynamic_cast<vvp_signal_value*> (cp->net->fil); }
+};
+
+  // The filter of the net is known to be a vvp_wire_vec4. That class
+  // is final, so calls through this pointer are not even virtual.
+struct sig_wire4_s {
+      typedef vvp_wire_vec4 sig_t;
+      static sig_t* get(vvp_code_t cp)
+      { return static_cast<vvp_wire_vec4*> (cp->net->fil); }
+};
+
+  // The signal value was located at load time and saved in the
+  // instruction itself.
+struct sig_cached_s {
+      typedef vvp_signal_value sig_t;
+      static sig_t* get(vvp_code_t cp)
+      { return cp->sig; }
+};
+
 bool of_ASSIGN_VEC4(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr (cp->net, 0);
@@ -1310,7 +1452,7 @@ bool of_ASSIGN_VEC4_A_E(vthread_t thr, vvp_code_t cp)
 /*
  * %assign/vec4/off/d <var>, <off>, <del>
  */
-bool of_ASSIGN_VEC4_OFF_D(vthread_t thr, vvp_code_t cp)
+template <class SIG> static bool assign_vec4_off_d_(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr (cp->net, 0);
       unsigned off_index = cp->bit_idx[0];
@@ -1325,7 +1467,7 @@ bool of_ASSIGN_VEC4_OFF_D(vthread_t thr, vvp_code_t cp)
       if (thr->flags[4] == BIT4_1)
 	    return true;
 
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      const typename SIG::sig_t*sig = SIG::get(cp);
       assert(sig);
 
       if (!resize_rval_vec(val, off, sig->value_size()))
@@ -1335,10 +1477,20 @@ bool of_ASSIGN_VEC4_OFF_D(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_ASSIGN_VEC4_OFF_D(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4_off_d_<sig_any_s>(thr, cp);
+}
+
+bool of_ASSIGN_VEC4_OFF_D_W4(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4_off_d_<sig_wire4_s>(thr, cp);
+}
+
 /*
  * %assign/vec4/off/e <var>, <off>
  */
-bool of_ASSIGN_VEC4_OFF_E(vthread_t thr, vvp_code_t cp)
+template <class SIG> static bool assign_vec4_off_e_(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr (cp->net, 0);
       unsigned off_index = cp->bit_idx[0];
@@ -1351,7 +1503,7 @@ bool of_ASSIGN_VEC4_OFF_E(vthread_t thr, vvp_code_t cp)
       if (thr->flags[4] == BIT4_1)
 	    return true;
 
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      const typename SIG::sig_t*sig = SIG::get(cp);
       assert(sig);
 
       if (!resize_rval_vec(val, off, sig->value_size()))
@@ -1366,10 +1518,20 @@ bool of_ASSIGN_VEC4_OFF_E(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_ASSIGN_VEC4_OFF_E(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4_off_e_<sig_any_s>(thr, cp);
+}
+
+bool of_ASSIGN_VEC4_OFF_E_W4(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4_off_e_<sig_wire4_s>(thr, cp);
+}
+
 /*
  * %assign/vec4/d <var-label> <delay>
  */
-bool of_ASSIGN_VEC4D(vthread_t thr, vvp_code_t cp)
+template <class SIG> static bool assign_vec4d_(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr (cp->net, 0);
       unsigned del_index = cp->bit_idx[0];
@@ -1377,7 +1539,7 @@ bool of_ASSIGN_VEC4D(vthread_t thr, vvp_code_t cp)
 
       vvp_vector4_t value = thr->pop_vec4();
 
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      const typename SIG::sig_t*sig = SIG::get(cp);
       assert(sig);
 
       schedule_assign_vector(ptr, 0, sig->value_size(), value, del);
@@ -1385,15 +1547,25 @@ bool of_ASSIGN_VEC4D(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_ASSIGN_VEC4D(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4d_<sig_any_s>(thr, cp);
+}
+
+bool of_ASSIGN_VEC4D_W4(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4d_<sig_wire4_s>(thr, cp);
+}
+
 /*
  * %assign/vec4/e <var-label>
  */
-bool of_ASSIGN_VEC4E(vthread_t thr, vvp_code_t cp)
+template <class SIG> static bool assign_vec4e_(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr (cp->net, 0);
       vvp_vector4_t value = thr->pop_vec4();
 
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      const typename SIG::sig_t*sig = SIG::get(cp);
       assert(sig);
 
       if (thr->ecount == 0) {
@@ -1405,6 +1577,16 @@ bool of_ASSIGN_VEC4E(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_ASSIGN_VEC4E(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4e_<sig_any_s>(thr, cp);
+}
+
+bool of_ASSIGN_VEC4E_W4(vthread_t thr, vvp_code_t cp)
+{
+      return assign_vec4e_<sig_wire4_s>(thr, cp);
+}
+
 /*
  * This is %assign/wr <vpi-label>, <delay>
  *
@@ -4246,7 +4428,7 @@ bool of_LOAD_STRA(vthread_t thr, vvp_code_t cp)
 /*
  * %load/vec4 <net>
  */
-bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
+template <class SIG> static bool load_vec4_(vthread_t thr, vvp_code_t cp)
 {
 	// Push a placeholder onto the stack in order to reserve the
 	// stack space. Use a reference for the stack top as a target
@@ -4254,12 +4436,11 @@ bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
       thr->push_vec4(vvp_vector4_t());
       vvp_vector4_t&sig_value = thr->peek_vec4();
 
-      vvp_net_t*net = cp->net;
-
 	// For the %load to work, the functor must actually be a
 	// signal functor. Only signals save their vector value.
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
+      const typename SIG::sig_t*sig = SIG::get(cp);
       if (sig == 0) {
+	    vvp_net_t*net = cp->net;
 	    cerr << thr->get_fileline()
 	         << "%load/v error: Net arg not a signal? "
 		 << (net->fil ? typeid(*net->fil).name() :
@@ -4276,6 +4457,21 @@ bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
+{
+      return load_vec4_<sig_any_s>(thr, cp);
+}
+
+bool of_LOAD_VEC4_W4(vthread_t thr, vvp_code_t cp)
+{
+      return load_vec4_<sig_wire4_s>(thr, cp);
+}
+
+bool of_LOAD_VEC4_SIG(vthread_t thr, vvp_code_t cp)
+{
+      return load_vec4_<sig_cached_s>(thr, cp);
+}
+
 /*
  * %load/vec4a <arr>, <adrx>
  */
@@ -7668,10 +7864,10 @@ bool of_STORE_STRA(vthread_t thr, vvp_code_t cp)
  * not consistent with the %store/vec4/<etc> instructions which have
  * no <wid>.
  */
-bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
+template <class SIG> static bool store_vec4_(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr(cp->net, 0);
-      const vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      const typename SIG::sig_t*sig = SIG::get(cp);
       unsigned off_index = cp->bit_idx[0];
       unsigned int wid = cp->bit_idx[1];
 
@@ -7712,6 +7908,16 @@ bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
+{
+      return store_vec4_<sig_any_s>(thr, cp);
+}
+
+bool of_STORE_VEC4_W4(vthread_t thr, vvp_code_t cp)
+{
+      return store_vec4_<sig_wire4_s>(thr, cp);
+}
+
 /*
  * %store/vec4a <var-label>, <addr>, <offset>
  */
@@ -8145,3 +8351,139 @@ bool of_REAP_UFUNC(vthread_t thr, vvp_code_t cp)
 
       return true;
 }
+
+/*
+ * Opcodes that locate their signal through RTTI, and the variants of
+ * them that get at the signal directly. The wire4 variant is used if
+ * the filter of the net is exactly a vvp_wire_vec4 (the usual case
+ * for static variables and 4-value nets). The cached variant, if
+ * there is one, saves the vvp_signal_value pointer in the instruction.
+ */
+static const struct {
+      vvp_code_fun generic;
+      vvp_code_fun wire4;
+      vvp_code_fun cached;
+} sig_specialize_table[] = {
+      { &of_LOAD_VEC4,         &of_LOAD_VEC4_W4,         &of_LOAD_VEC4_SIG },
+      { &of_STORE_VEC4,        &of_STORE_VEC4_W4,        0 },
+      { &of_ASSIGN_VEC4D,      &of_ASSIGN_VEC4D_W4,      0 },
+      { &of_ASSIGN_VEC4E,      &of_ASSIGN_VEC4E_W4,      0 },
+      { &of_ASSIGN_VEC4_OFF_D, &of_ASSIGN_VEC4_OFF_D_W4, 0 },
+      { &of_ASSIGN_VEC4_OFF_E, &of_ASSIGN_VEC4_OFF_E_W4, 0 }
+};
+
+void vvp_code_specialize(vvp_code_t cp)
+{
+      const size_t count = sizeof sig_specialize_table
+			 / sizeof sig_specialize_table[0];
+
+      for (size_t idx = 0 ;  idx < count ;  idx += 1) {
+	    if (cp->opcode != sig_specialize_table[idx].generic)
+		  continue;
+
+	    vvp_net_fil_t*fil = cp->net? cp->net->fil : 0;
+	    vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (fil);
+
+	    if (fil && typeid(*fil) == typeid(vvp_wire_vec4)) {
+		  cp->opcode = sig_specialize_table[idx].wire4;
+		  count_opcodes_sig_special += 1;
+
+	    } else if (sig && sig_specialize_table[idx].cached) {
+		  cp->sig = sig;
+		  cp->opcode = sig_specialize_table[idx].cached;
+		  count_opcodes_sig_special += 1;
+
+	    } else {
+		  count_opcodes_sig_generic += 1;
+	    }
+	    return;
+      }
+}
+
+/*
+ * Superinstructions. The codespace_fuse() pass replaces the first
+ * instruction of some very common instruction sequences with one of
+ * these fused opcodes. The fused opcode executes the whole sequence
+ * with direct calls to the component opcodes, which the compiler can
+ * inline here, and then steps the pc past the sequence. This saves
+ * an indirect dispatch (and the trip through the vthread_run loop)
+ * for every instruction but the first.
+ *
+ * The component instructions are left in place in the code space, so
+ * a jump into the middle of a fused sequence still executes correctly.
+ * All but the last component of a sequence must be opcodes that always
+ * return true and do not touch the pc.
+ */
+template <vvp_code_fun OP1, vvp_code_fun OP2>
+static bool of_FUSED2(vthread_t thr, vvp_code_t cp)
+{
+      OP1(thr, cp);
+      thr->pc = cp + 2;
+      return OP2(thr, cp + 1);
+}
+
+template <vvp_code_fun OP1, vvp_code_fun OP2, vvp_code_fun OP3>
+static bool of_FUSED3(vthread_t thr, vvp_code_t cp)
+{
+      OP1(thr, cp);
+      OP2(thr, cp + 1);
+      thr->pc = cp + 3;
+      return OP3(thr, cp + 2);
+}
+
+# define FUSE2(a,b) { 2, { &of_##a, &of_##b, 0 }, &of_FUSED2<&of_##a,&of_##b> }
+# define FUSE3(a,b,c) { 3, { &of_##a, &of_##b, &of_##c }, \
+                        &of_FUSED3<&of_##a,&of_##b,&of_##c> }
+
+# define FUSE_JMPS(a) FUSE2(a,JMP0XZ), FUSE2(a,JMP1XZ), \
+                      FUSE2(a,JMP0), FUSE2(a,JMP1)
+
+/*
+ * The longer sequences are listed first so that they are preferred.
+ */
+# define FUSE_LOADS3(b,c) FUSE3(LOAD_VEC4_W4,b,c), FUSE3(LOAD_VEC4_SIG,b,c), \
+                          FUSE3(LOAD_VEC4,b,c)
+# define FUSE_LOADS2(b) FUSE2(LOAD_VEC4_W4,b), FUSE2(LOAD_VEC4_SIG,b), \
+                        FUSE2(LOAD_VEC4,b)
+
+const struct vvp_fused_code_s vvp_fused_codes[] = {
+	// Increment/decrement of a variable: v = v + <imm>;
+      FUSE3(LOAD_VEC4_W4, ADDI, STORE_VEC4_W4),
+      FUSE3(LOAD_VEC4_W4, SUBI, STORE_VEC4_W4),
+      FUSE3(LOAD_VEC4, ADDI, STORE_VEC4),
+      FUSE3(LOAD_VEC4, SUBI, STORE_VEC4),
+	// Loop and if tests of a variable against a constant.
+      FUSE_LOADS3(CMPIS, JMP0XZ),
+      FUSE_LOADS3(CMPIU, JMP0XZ),
+      FUSE_LOADS3(CMPIE, JMP0XZ),
+      FUSE_LOADS3(CMPINE, JMP0XZ),
+	// if (<1-bit variable>) ...
+      FUSE_LOADS3(FLAG_SET_VEC4, JMP0XZ),
+      FUSE_LOADS3(FLAG_SET_VEC4, JMP1XZ),
+	// Compare followed by a conditional branch.
+      FUSE_JMPS(CMPS),
+      FUSE_JMPS(CMPU),
+      FUSE_JMPS(CMPE),
+      FUSE_JMPS(CMPNE),
+      FUSE_JMPS(CMPIS),
+      FUSE_JMPS(CMPIU),
+      FUSE_JMPS(CMPIE),
+      FUSE_JMPS(CMPINE),
+      FUSE_JMPS(FLAG_SET_VEC4),
+	// Variable and constant copies and operand loads.
+      FUSE2(LOAD_VEC4_W4, STORE_VEC4_W4),
+      FUSE2(PUSHI_VEC4, STORE_VEC4_W4),
+      FUSE2(LOAD_VEC4_W4, LOAD_VEC4_W4),
+      FUSE_LOADS2(STORE_VEC4),
+      FUSE2(PUSHI_VEC4, STORE_VEC4),
+      FUSE_LOADS2(LOAD_VEC4),
+      FUSE_LOADS2(ADDI),
+      FUSE_LOADS2(PUSHI_VEC4),
+      { 0, { 0, 0, 0 }, 0 }
+};
+
+# undef FUSE_LOADS2
+# undef FUSE_LOADS3
+# undef FUSE_JMPS
+# undef FUSE3
+# undef FUSE2
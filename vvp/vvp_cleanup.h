@@ -28,6 +28,7 @@
 extern void codespace_delete(void);
 extern void dec_str_delete(void);
 extern void def_table_delete(void);
+extern void gate_engine_delete(void);
 extern void island_delete(void);
 extern void vpi_mcd_delete(void);
 extern void load_module_delete(void);
@@ -41,6 +42,7 @@ extern void vpi_handle_delete(void);
 extern void vpi_stack_delete(void);
 extern void vvp_net_pool_delete(void);
 extern void ufunc_pool_delete(void);
+extern void profile_delete(void);
 
 extern void A_delete(class __vpiHandle *item);
 extern void APV_delete(class __vpiHandle *item);
@@ -63,6 +65,7 @@ extern void thread_word_delete(class __vpiHandle *item);
 extern void vpi_call_delete(class __vpiHandle *item);
 extern void exec_ufunc_delete(vvp_code_t euf_code);
 extern void vthreads_delete(__vpiScope*scope);
+extern void vthread_pool_delete();
 extern void vvp_net_delete(vvp_net_t *item);
 
 
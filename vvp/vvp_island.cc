@@ -40,7 +40,7 @@ static bool at_EOS = false;
 
 void island_send_value(vvp_net_t*net, const vvp_vector8_t&val)
 {
-      vvp_island_port*fun = dynamic_cast<vvp_island_port*>(net->fun);
+      vvp_island_port*fun = island_port(net);
       if (fun->outvalue .eeq(val))
 	    return;
 
@@ -54,6 +54,7 @@ void island_send_value(vvp_net_t*net, const vvp_vector8_t&val)
 vvp_island::vvp_island()
 {
       flagged_ = false;
+      branch_count_ = 0;
       branches_ = 0;
       ports_ = 0;
       anodes_ = 0;
@@ -74,8 +75,19 @@ vvp_island::~vvp_island()
       }
 }
 
-void vvp_island::flag_island()
+void vvp_island::mark_changed(vvp_island_port*port)
 {
+      if (port->changed)
+	    return;
+
+      port->changed = true;
+      changed_ports_.push_back(port);
+}
+
+void vvp_island::flag_island(vvp_island_port*port)
+{
+      mark_changed(port);
+
       if (flagged_ == true)
 	    return;
 
@@ -104,6 +116,7 @@ void vvp_island::add_port(const char*key, vvp_net_t*net)
       assert(ports_->sym_get_value(key) == 0);
 
       ports_->sym_set_value(key, net);
+      mark_changed(island_port(net));
 }
 
 void vvp_island::add_branch(vvp_island_branch*branch, const char*pa, const char*pb)
@@ -113,6 +126,9 @@ void vvp_island::add_branch(vvp_island_branch*branch, const char*pa, const char*
       branch->a = ports_->sym_get_value(pa);
       branch->b = ports_->sym_get_value(pb);
       assert(branch->a && branch->b);
+      branch->ports[0] = island_port(branch->a);
+      branch->ports[1] = island_port(branch->b);
+      branch->order = branch_count_++;
 
       vvp_branch_ptr_t ptra (branch, 0);
       vvp_branch_ptr_t ptrb (branch, 1);
@@ -130,6 +146,7 @@ void vvp_island::add_branch(vvp_island_branch*branch, const char*pa, const char*
       } else {
 	    branch->link[0] = ptra;
 	    anodes_->sym_set_value(pa, branch);
+	    branch->ports[0]->node = ptra;
       }
 
       if ((cur = anodes_->sym_get_value(pb))) {
@@ -141,6 +158,7 @@ void vvp_island::add_branch(vvp_island_branch*branch, const char*pa, const char*
       } else {
 	    branch->link[1] = ptrb;
 	    bnodes_->sym_set_value(pb, branch);
+	    branch->ports[1]->node = ptrb;
       }
 
       branch->next_branch = branches_;
@@ -168,7 +186,7 @@ void vvp_island::compile_cleanup()
 }
 
 vvp_island_port::vvp_island_port(vvp_island*ip)
-: island_(ip)
+: changed(false), active(false), island_(ip)
 {
 }
 
@@ -184,7 +202,7 @@ void vvp_island_port::recv_vec4(vvp_net_ptr_t, const vvp_vector4_t&bit,
 	    return;
 
       invalue = tmp;
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bit,
@@ -201,7 +219,7 @@ void vvp_island_port::recv_vec8(vvp_net_ptr_t, const vvp_vector8_t&bit)
 	    return;
 
       invalue = bit;
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::recv_vec8_pv(vvp_net_ptr_t, const vvp_vector8_t&bit,
@@ -219,15 +237,17 @@ void vvp_island_port::recv_vec8_pv(vvp_net_ptr_t, const vvp_vector8_t&bit,
 	    }
       }
 
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::force_flag(bool run_now)
 {
-      if (run_now)
+      if (run_now) {
+	    island_->mark_changed(this);
 	    island_->run_island();
-      else
-	    island_->flag_island();
+      } else {
+	    island_->flag_island(this);
+      }
 }
 
 vvp_island_branch::~vvp_island_branch()
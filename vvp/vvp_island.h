@@ -25,6 +25,7 @@
 # include  "symbols.h"
 # include  "schedule.h"
 # include  <list>
+# include  <vector>
 # include  <cassert>
 
 /*
@@ -69,8 +70,14 @@ class vvp_island  : private vvp_gen_event_s {
 	// Ports call this method to flag that something happened at
 	// the input. The island will use this to create an active
 	// event. The run_run() method will then be called by the
-	// scheduler to process whatever happened.
-      void flag_island();
+	// scheduler to process whatever happened. The port is added
+	// to the changed_ports_ list so that the island can limit its
+	// work to the parts of the mesh that the port reaches.
+      void flag_island(vvp_island_port*port);
+
+	// Add the port to the changed_ports_ list without scheduling
+	// the island.
+      void mark_changed(vvp_island_port*port);
 
 	// This is the method that is called, eventually, to process
 	// whatever happened. The derived island class implements this
@@ -86,6 +93,10 @@ class vvp_island  : private vvp_gen_event_s {
 	// island. The derived island class can access this list for
 	// scanning the mesh.
       vvp_island_branch*branches_;
+	// The ports that have changed since the last run of the
+	// island. Every port starts out on this list, so the first
+	// run covers the entire island.
+      std::vector<vvp_island_port*> changed_ports_;
 
     public: /* These methods are used during linking. */
 
@@ -103,6 +114,7 @@ class vvp_island  : private vvp_gen_event_s {
     private:
       void run_run() override;
       bool flagged_;
+      unsigned branch_count_;
 
     private:
 	// During link, the vvp_island keeps these symbol tables for
@@ -149,6 +161,17 @@ class vvp_island_port  : public vvp_net_fun_t {
       vvp_vector8_t outvalue;
       vvp_vector8_t value;
 
+    public: // The island keeps these for its incremental runs.
+	// True if the port is on the changed_ports_ list.
+      bool changed;
+	// Scratch flag for the island while it is running.
+      bool active;
+	// One of the branch endpoints attached to this port, or nil
+	// if the port is not an endpoint of any branch.
+      vvp_sub_pointer_t<vvp_island_branch> node;
+	// The branches that this port is the enable input for.
+      std::vector<vvp_island_branch*> controls;
+
     private:
       vvp_island*island_;
 
@@ -163,9 +186,19 @@ class vvp_island_port  : public vvp_net_fun_t {
       vvp_island_port& operator = (const vvp_island_port&);
 };
 
+/*
+ * The nets of an island are all created by the island compile
+ * functions with a vvp_island_port functor, so there is no need to
+ * check the type of the functor.
+ */
+inline vvp_island_port* island_port(vvp_net_t*net)
+{
+      return static_cast<vvp_island_port*>(net->fun);
+}
+
 inline vvp_vector8_t island_get_value(vvp_net_t*net)
 {
-      const vvp_island_port*fun = dynamic_cast<vvp_island_port*>(net->fun);
+      const vvp_island_port*fun = island_port(net);
       const vvp_wire_vec8*fil = dynamic_cast<vvp_wire_vec8*>(net->fil);
 
       if (fil == 0) {
@@ -188,7 +221,7 @@ inline vvp_vector8_t island_get_value(vvp_net_t*net)
 
 inline vvp_vector8_t island_get_sent_value(vvp_net_t*net)
 {
-      const vvp_island_port*fun = dynamic_cast<vvp_island_port*>(net->fun);
+      const vvp_island_port*fun = island_port(net);
       return fun->outvalue;
 }
 
@@ -214,6 +247,11 @@ struct vvp_island_branch {
 	// Port connections
       vvp_net_t*a;
       vvp_net_t*b;
+	// The functors of the a and b nets.
+      vvp_island_port*ports[2];
+	// The position of the branch in the island. Branches that
+	// are added later have a larger order.
+      unsigned order;
 };
 
 static inline vvp_branch_ptr_t next(vvp_branch_ptr_t cur)
@@ -25,6 +25,7 @@
 # include  "resolv.h"
 # include  "schedule.h"
 # include  "statistics.h"
+# include  "vec4_kernels.h"
 # include  <cstdio>
 # include  <cstring>
 # include  <cstdlib>
@@ -33,6 +34,8 @@
 # include  <climits>
 # include  <cmath>
 # include  <cassert>
+# include  <unordered_set>
+# include  <vector>
 #ifdef CHECK_WITH_VALGRIND
 # include  <valgrind/memcheck.h>
 # include  <map>
@@ -54,15 +57,21 @@ permaheap vvp_net_fil_t::heap_;
 // Allocate around 1Megabyte/chunk.
 static const size_t VVP_NET_CHUNK = 1024*1024/sizeof(vvp_net_t);
 static vvp_net_t*vvp_net_alloc_table = NULL;
-#ifdef CHECK_WITH_VALGRIND
+  // All the chunks are listed so that compile_fanout can visit every
+  // net, and so that the valgrind cleanup can release them.
 static vvp_net_t **vvp_net_pool = NULL;
 static unsigned vvp_net_pool_count = 0;
-#endif
 static size_t vvp_net_alloc_remaining = 0;
 // For statistics, count the vvp_nets allocated and the bytes of alloc
 // chunks allocated.
 unsigned long count_vvp_nets = 0;
 size_t size_vvp_nets = 0;
+unsigned long count_fanout_arrays = 0;
+size_t size_fanout_arrays = 0;
+unsigned long count_sparse_pages = 0;
+
+  // The fan-out arrays of all the nets. See compile_fanout.
+static vvp_fanout_s*vvp_fanout_table = 0;
 
 void* vvp_net_t::operator new (size_t size)
 {
@@ -74,11 +83,11 @@ void* vvp_net_t::operator new (size_t size)
 #ifdef CHECK_WITH_VALGRIND
 	    VALGRIND_MAKE_MEM_NOACCESS(vvp_net_alloc_table, size*VVP_NET_CHUNK);
 	    VALGRIND_CREATE_MEMPOOL(vvp_net_alloc_table, 0, 0);
+#endif
 	    vvp_net_pool_count += 1;
 	    vvp_net_pool = static_cast<vvp_net_t **>(realloc(vvp_net_pool,
 	                   vvp_net_pool_count*sizeof(vvp_net_t **)));
 	    vvp_net_pool[vvp_net_pool_count-1] = vvp_net_alloc_table;
-#endif
       }
 
       vvp_net_t*return_this = vvp_net_alloc_table;
@@ -181,6 +190,9 @@ void vvp_net_pool_delete()
       free(vvp_net_pool);
       vvp_net_pool = NULL;
       vvp_net_pool_count = 0;
+
+      delete[]vvp_fanout_table;
+      vvp_fanout_table = 0;
 }
 #endif
 
@@ -194,11 +206,13 @@ vvp_net_t::vvp_net_t()
 {
       fun = 0;
       fil = 0;
+      fanout_ = 0;
 }
 
 void vvp_net_t::link(vvp_net_ptr_t port_to_link)
 {
       vvp_net_t*net = port_to_link.ptr();
+      fanout_changed();
 
 	// Connect nodes with vvp_fun_modpath_src to the head of the
 	// linked list, so that vvp_fun_modpath_src are always evaluated
@@ -244,6 +258,7 @@ void vvp_net_t::unlink(vvp_net_ptr_t dst_ptr)
 {
       vvp_net_t*net = dst_ptr.ptr();
       unsigned net_port = dst_ptr.port();
+      fanout_changed();
 
       if (out_ == dst_ptr) {
 	      /* If the drive fan-out list starts with this pointer,
@@ -268,6 +283,93 @@ void vvp_net_t::unlink(vvp_net_ptr_t dst_ptr)
       net->port[net_port] = vvp_net_ptr_t(0,0);
 }
 
+static unsigned fanout_count(const vvp_net_t*net)
+{
+      unsigned res = 0;
+      for (vvp_net_ptr_t cur = net->out_ ; cur.ptr()
+		 ; cur = cur.ptr()->port[cur.port()]) {
+	    if (cur.ptr()->fun)
+		  res += 1;
+      }
+      return res;
+}
+
+/*
+ * Copy the fan-out chain of every net that drives more than one
+ * functor into an array. All the arrays are allocated together in
+ * one table, and they are laid out in breadth-first order of the
+ * net graph, so that the arrays of nets that propagate to each other
+ * tend to be near each other. (The nets themselves cannot be moved,
+ * as pointers to them are held all over the run time.)
+ *
+ * The out_ chain stays in place, and a link or unlink of the net
+ * output drops the array so that the chain is used from then on.
+ * The dropped arrays stay in the table, which is never reallocated,
+ * so a propagation that is in progress can safely continue.
+ */
+void vvp_net_t::compile_fanout(void)
+{
+      vector<vvp_net_t*> order;
+      order.reserve(count_vvp_nets);
+      unordered_set<vvp_net_t*> seen;
+
+      for (unsigned chunk = 0 ; chunk < vvp_net_pool_count ; chunk += 1) {
+	    size_t count = VVP_NET_CHUNK;
+	    if (chunk+1 == vvp_net_pool_count)
+		  count -= vvp_net_alloc_remaining;
+
+	    for (size_t idx = 0 ; idx < count ; idx += 1) {
+		  vvp_net_t*root = vvp_net_pool[chunk] + idx;
+		  if (! seen.insert(root).second)
+			continue;
+
+		  size_t pos = order.size();
+		  order.push_back(root);
+		  for ( ; pos < order.size() ; pos += 1) {
+			for (vvp_net_ptr_t cur = order[pos]->out_ ; cur.ptr()
+				   ; cur = cur.ptr()->port[cur.port()]) {
+			      if (seen.insert(cur.ptr()).second)
+				    order.push_back(cur.ptr());
+			}
+		  }
+	    }
+      }
+
+      size_t entries = 0;
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1) {
+	    unsigned cnt = fanout_count(order[idx]);
+	    if (cnt > 1)
+		  entries += cnt + 1;
+      }
+
+      if (entries == 0)
+	    return;
+
+      vvp_fanout_s*fan = new vvp_fanout_s[entries];
+      vvp_fanout_table = fan;
+      size_fanout_arrays = entries * sizeof(vvp_fanout_s);
+
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1) {
+	    vvp_net_t*net = order[idx];
+	    if (fanout_count(net) < 2)
+		  continue;
+
+	    net->fanout_ = fan;
+	    for (vvp_net_ptr_t cur = net->out_ ; cur.ptr()
+		       ; cur = cur.ptr()->port[cur.port()]) {
+		  if (cur.ptr()->fun == 0)
+			continue;
+		  fan->fun = cur.ptr()->fun;
+		  fan->port = cur;
+		  fan += 1;
+	    }
+	    fan->fun = 0;
+	    fan->port = vvp_net_ptr_t(0,0);
+	    fan += 1;
+	    count_fanout_arrays += 1;
+      }
+}
+
 void vvp_net_t::count_drivers(unsigned idx, unsigned counts[4])
 {
       counts[0] = 0;
@@ -588,6 +690,9 @@ unsigned long multiply_with_carry(unsigned long a, unsigned long b,
 
 void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -598,8 +703,20 @@ void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val)
       }
 }
 
+void vvp_send_vec8(const vvp_fanout_s*fan, const vvp_vector8_t&val)
+{
+      if (profile_flag)
+	    profile_count_sends(fan);
+
+      for ( ; fan->fun ; fan += 1)
+	    fan->fun->recv_vec8(fan->port, val);
+}
+
 void vvp_send_real(vvp_net_ptr_t ptr, double val, vvp_context_t context)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -618,10 +735,8 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
       if (size_ == that.size_) {
 	    if (size_ > BITS_PER_WORD) {
 		  unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-		  for (unsigned idx = 0 ;  idx < words ;  idx += 1)
-			abits_ptr_[idx] = that.abits_ptr_[idx];
-		  for (unsigned idx = 0 ;  idx < words ;  idx += 1)
-			bbits_ptr_[idx] = that.bbits_ptr_[idx];
+		  memcpy(abits_ptr_, that.abits_ptr_, words*sizeof(unsigned long));
+		  memcpy(bbits_ptr_, that.bbits_ptr_, words*sizeof(unsigned long));
 	    } else {
 		  abits_val_ = that.abits_val_;
 		  bbits_val_ = that.bbits_val_;
@@ -679,13 +794,10 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 	/* Finally, we know that source and destination are long. copy
 	   words until we get to the last. */
       unsigned bits_to_copy = (that.size_ < size_) ? that.size_ : size_;
-      unsigned word = 0;
-      while (bits_to_copy >= BITS_PER_WORD) {
-	    abits_ptr_[word] = that.abits_ptr_[word];
-	    bbits_ptr_[word] = that.bbits_ptr_[word];
-	    bits_to_copy -= BITS_PER_WORD;
-	    word += 1;
-      }
+      unsigned word = bits_to_copy / BITS_PER_WORD;
+      memcpy(abits_ptr_, that.abits_ptr_, word*sizeof(unsigned long));
+      memcpy(bbits_ptr_, that.bbits_ptr_, word*sizeof(unsigned long));
+      bits_to_copy %= BITS_PER_WORD;
       if (bits_to_copy > 0) {
 	    unsigned long mask = (1UL << bits_to_copy) - 1UL;
 	    abits_ptr_[word] &= ~mask;
@@ -705,10 +817,8 @@ void vvp_vector4_t::copy_from_big_(const vvp_vector4_t&that)
       abits_ptr_ = new unsigned long[2*words];
       bbits_ptr_ = abits_ptr_ + words;
 
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1)
-	    abits_ptr_[idx] = that.abits_ptr_[idx];
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1)
-	    bbits_ptr_[idx] = that.bbits_ptr_[idx];
+	// The abits and bbits of that are also one double-length array.
+      memcpy(abits_ptr_, that.abits_ptr_, 2*words*sizeof(unsigned long));
 }
 
 /*
@@ -1296,22 +1406,14 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		 destination is neatly aligned. That means all but the
 		 last word can be simply copied with no masking. */
 
-	    unsigned remain = that.size_;
-	    unsigned sptr = 0;
+	    unsigned sptr = that.size_ / BITS_PER_WORD;
 	    unsigned dptr = adr / BITS_PER_WORD;
-	    while (remain >= BITS_PER_WORD) {
-		  if (abits_ptr_[dptr] != that.abits_ptr_[sptr]) {
-			diff_flag = true;
-			abits_ptr_[dptr] = that.abits_ptr_[sptr];
-		  }
-		  if (bbits_ptr_[dptr] != that.bbits_ptr_[sptr]) {
-			diff_flag = true;
-			bbits_ptr_[dptr] = that.bbits_ptr_[sptr];
-		  }
-		  dptr += 1;
-		  sptr += 1;
-		  remain -= BITS_PER_WORD;
-	    }
+	    unsigned remain = that.size_ % BITS_PER_WORD;
+	    if (vec4_kernels->copy_diff(abits_ptr_+dptr, that.abits_ptr_, sptr))
+		  diff_flag = true;
+	    if (vec4_kernels->copy_diff(bbits_ptr_+dptr, that.bbits_ptr_, sptr))
+		  diff_flag = true;
+	    dptr += sptr;
 
 	    if (remain > 0) {
 		  unsigned long mask = (1UL << remain) - 1;
@@ -1580,11 +1682,23 @@ void vvp_vector4_t::mov(unsigned dst, unsigned src, unsigned cnt)
 			  // exactly an entire word. For this to be
 			  // true, it must also be true that the
 			  // pointers are aligned. The work is easy,
-			abits_ptr_[dptr] = abits_ptr_[sptr];
-			bbits_ptr_[dptr] = bbits_ptr_[sptr];
-			dptr += 1;
-			sptr += 1;
-			cnt -= BITS_PER_WORD;
+			  // and all the full words can be moved at
+			  // once unless the destination overlaps
+			  // the source from above.
+			unsigned words = cnt / BITS_PER_WORD;
+			if (dptr < sptr || dptr >= sptr+words) {
+			      memmove(abits_ptr_+dptr, abits_ptr_+sptr,
+				      words*sizeof(unsigned long));
+			      memmove(bbits_ptr_+dptr, bbits_ptr_+sptr,
+				      words*sizeof(unsigned long));
+			} else {
+			      words = 1;
+			      abits_ptr_[dptr] = abits_ptr_[sptr];
+			      bbits_ptr_[dptr] = bbits_ptr_[sptr];
+			}
+			dptr += words;
+			sptr += words;
+			cnt -= words * BITS_PER_WORD;
 			continue;
 		  }
 
@@ -1617,6 +1731,9 @@ void vvp_vector4_t::mov(unsigned dst, unsigned src, unsigned cnt)
       }
 }
 
+static void multiply_low(unsigned long*res, const unsigned long*a,
+			 const unsigned long*b, unsigned cnt);
+
 void vvp_vector4_t::mul(const vvp_vector4_t&that)
 {
       assert(size_ == that.size_);
@@ -1674,34 +1791,12 @@ void vvp_vector4_t::mul(const vvp_vector4_t&that)
 	    }
       }
 
-	// Calculate the result into a res array. We need to keep is
-	// separate from the "this" array because we are making
-	// multiple passes.
+	// Calculate the result into a res array, with the same word
+	// multiply (and Karatsuba for wide values) as the
+	// vvp_vector2_t multiply. The bits above size_ in the top
+	// words only reach result bits above size_, which are masked.
       unsigned long*res = new unsigned long[cnt];
-      for (int idx = 0 ; idx < cnt ; idx += 1)
-	    res[idx] = 0;
-
-      for (int mul_a = 0 ; mul_a < cnt ; mul_a += 1) {
-	    unsigned long lval = abits_ptr_[mul_a];
-	    if (mul_a == (cnt-1))
-		  lval &= mask;
-
-	    for (int mul_b = 0 ; mul_b < (cnt-mul_a) ; mul_b += 1) {
-		  unsigned long rval = that.abits_ptr_[mul_b];
-		  if (mul_b == (cnt-1))
-			rval &= mask;
-
-		  unsigned long sum;
-		  unsigned long tmp = multiply_with_carry(lval, rval, sum);
-		  int base = mul_a + mul_b;
-		  unsigned long carry = 0;
-		  res[base] = add_with_carry(res[base], tmp, carry);
-		  for (int add_idx = base+1 ; add_idx < cnt ; add_idx += 1) {
-			res[add_idx] = add_with_carry(res[add_idx], sum, carry);
-			sum = 0;
-		  }
-	    }
-      }
+      multiply_low(res, abits_ptr_, that.abits_ptr_, cnt);
 
 	// Replace the "this" value with the calculated result. We
 	// know a-priori that the bbits are zero and unchanged.
@@ -1710,9 +1805,6 @@ void vvp_vector4_t::mul(const vvp_vector4_t&that)
 	    abits_ptr_[idx] = res[idx];
 
       delete[]res;
-      return;
-
-
 }
 
 bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
@@ -1732,12 +1824,10 @@ bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
-	    if (abits_ptr_[idx] != that.abits_ptr_[idx])
-		  return false;
-	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
-		  return false;
-      }
+      if (! vec4_kernels->eeq(abits_ptr_, that.abits_ptr_, words))
+	    return false;
+      if (! vec4_kernels->eeq(bbits_ptr_, that.bbits_ptr_, words))
+	    return false;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1795,10 +1885,8 @@ bool vvp_vector4_t::has_xz() const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ; idx < words ; idx += 1) {
-	    if (bbits_ptr_[idx])
-		  return true;
-      }
+      if (vec4_kernels->any(bbits_ptr_, words))
+	    return true;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1889,14 +1977,9 @@ void vvp_vector4_t::invert()
 	    abits_val_ = mask & ~abits_val_;
 	    abits_val_ |= bbits_val_;
       } else {
-	    unsigned remaining = size_;
-	    unsigned idx = 0;
-	    while (remaining >= BITS_PER_WORD) {
-		  abits_ptr_[idx] = ~abits_ptr_[idx];
-		  abits_ptr_[idx] |= bbits_ptr_[idx];
-		  idx += 1;
-		  remaining -= BITS_PER_WORD;
-	    }
+	    unsigned idx = size_ / BITS_PER_WORD;
+	    unsigned remaining = size_ % BITS_PER_WORD;
+	    vec4_kernels->invert4(abits_ptr_, bbits_ptr_, idx);
 	    if (remaining > 0) {
 		  unsigned long mask = (1UL<<remaining) - 1UL;
 		  abits_ptr_[idx] = mask & ~abits_ptr_[idx];
@@ -1918,14 +2001,12 @@ vvp_bit4_t vvp_vector4_t::reduce_or() const
 	    if ((bbits_val_ & mask) != 0UL)
 		  return BIT4_X;
       } else {
-	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    unsigned idx;
-	    for (idx = 0; idx < words - 1; idx += 1) {
-		  if ((abits_ptr_[idx] & ~bbits_ptr_[idx]) != 0UL)
-			return BIT4_1;
-		  if (bbits_ptr_[idx] != 0UL)
-			res = BIT4_X;
-	    }
+	    unsigned idx = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD - 1;
+	    unsigned flags = vec4_kernels->scan(abits_ptr_, bbits_ptr_, idx);
+	    if (flags & VEC4_SCAN_ONE)
+		  return BIT4_1;
+	    if (flags & VEC4_SCAN_XZ)
+		  res = BIT4_X;
 	    if ((abits_ptr_[idx] & ~bbits_ptr_[idx] & mask) != 0UL)
 		  return BIT4_1;
 	    if ((bbits_ptr_[idx] & mask) != 0UL)
@@ -1946,14 +2027,12 @@ vvp_bit4_t vvp_vector4_t::reduce_and() const
 	    if ((bbits_val_ & mask) != 0UL)
 		  return BIT4_X;
 	} else {
-	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    unsigned idx;
-	    for (idx = 0; idx < words - 1; idx += 1) {
-		  if ((abits_ptr_[idx] | bbits_ptr_[idx]) != ~0UL)
-			return BIT4_0;
-		  if (bbits_ptr_[idx] != 0UL)
-			res = BIT4_X;
-	    }
+	    unsigned idx = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD - 1;
+	    unsigned flags = vec4_kernels->scan(abits_ptr_, bbits_ptr_, idx);
+	    if (flags & VEC4_SCAN_ZERO)
+		  return BIT4_0;
+	    if (flags & VEC4_SCAN_XZ)
+		  res = BIT4_X;
 	    if ((abits_ptr_[idx] | bbits_ptr_[idx] | ~mask) != ~0UL)
 		  return BIT4_0;
 	    if ((bbits_ptr_[idx] & mask) != 0UL)
@@ -1989,14 +2068,10 @@ vvp_bit4_t vvp_vector4_t::reduce_xor() const
 		  return BIT4_X;
 	    return parity(abits_val_ & mask) ? BIT4_1 : BIT4_0;
       } else {
-	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    unsigned long val_a = 0UL;
-	    unsigned idx;
-	    for (idx = 0; idx < words - 1; idx += 1) {
-		  if (bbits_ptr_[idx] != 0UL)
-			return BIT4_X;
-		  val_a ^= abits_ptr_[idx];
-	    }
+	    unsigned idx = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD - 1;
+	    if (vec4_kernels->any(bbits_ptr_, idx))
+		  return BIT4_X;
+	    unsigned long val_a = vec4_kernels->fold_xor(abits_ptr_, idx);
 	    if ((bbits_ptr_[idx] & mask) != 0UL)
 		  return BIT4_X;
 	    val_a ^= abits_ptr_[idx] & mask;
@@ -2019,14 +2094,8 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 	    bbits_val_ = (tmp1 & that.bbits_val_) | (tmp2 & bbits_val_);
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long tmp1 = abits_ptr_[idx] | bbits_ptr_[idx];
-		  unsigned long tmp2 = that.abits_ptr_[idx] |
-		                       that.bbits_ptr_[idx];
-		  abits_ptr_[idx] = tmp1 & tmp2;
-		  bbits_ptr_[idx] = (tmp1 & that.bbits_ptr_[idx]) |
-		                    (tmp2 & bbits_ptr_[idx]);
-	    }
+	    vec4_kernels->and4(abits_ptr_, bbits_ptr_,
+			       that.abits_ptr_, that.bbits_ptr_, words);
       }
 
       return *this;
@@ -2049,15 +2118,8 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long tmp = abits_ptr_[idx] | bbits_ptr_[idx] |
-	                        that.abits_ptr_[idx] | that.bbits_ptr_[idx];
-		  bbits_ptr_[idx] = ((~abits_ptr_[idx] | bbits_ptr_[idx]) &
-		                     that.bbits_ptr_[idx]) |
-		                    ((~that.abits_ptr_[idx] |
-		                      that.bbits_ptr_[idx]) & bbits_ptr_[idx]);
-		  abits_ptr_[idx] = tmp;
-	    }
+	    vec4_kernels->or4(abits_ptr_, bbits_ptr_,
+			      that.abits_ptr_, that.bbits_ptr_, words);
       }
 
       return *this;
@@ -2077,11 +2139,8 @@ vvp_vector4_t& vvp_vector4_t::operator ^= (const vvp_vector4_t&that)
 	    abits_val_ = (abits_val_ ^ that.abits_val_) | bval;
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long bval = bbits_ptr_[idx] | that.bbits_ptr_[idx];
-		  bbits_ptr_[idx] = bval;
-		  abits_ptr_[idx] = (abits_ptr_[idx] ^ that.abits_ptr_[idx]) | bval;
-	    }
+	    vec4_kernels->xor4(abits_ptr_, bbits_ptr_,
+			       that.abits_ptr_, that.bbits_ptr_, words);
       }
 
       return *this;
@@ -2339,24 +2398,82 @@ vvp_vector4_t vvp_vector4array_t::get_word_(v4cell*cell) const
       return res;
 }
 
-vvp_vector4array_sa::vvp_vector4array_sa(unsigned width__, unsigned words__)
-: vvp_vector4array_t(width__, words__)
+void vvp_vector4array_t::get_word_bits(unsigned idx, unsigned long*abits,
+				       unsigned long*bbits) const
 {
-      array_ = new v4cell[words_];
+      const unsigned bpw = vvp_vector4_t::BITS_PER_WORD;
+      unsigned cnt = (width_ + bpw - 1) / bpw;
+      const v4cell*cell = idx < words_? peek_cell_(idx) : 0;
 
+      if (cell == 0 || (width_ > bpw && cell->abits_ptr_ == 0)) {
+	    for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+		  abits[wdx] = vvp_vector4_t::WORD_X_ABITS;
+		  bbits[wdx] = vvp_vector4_t::WORD_X_BBITS;
+	    }
+      } else if (width_ <= bpw) {
+	    abits[0] = cell->abits_val_;
+	    bbits[0] = cell->bbits_val_;
+      } else {
+	    for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+		  abits[wdx] = cell->abits_ptr_[wdx];
+		  bbits[wdx] = cell->bbits_ptr_[wdx];
+	    }
+      }
+
+      if (unsigned tail = width_ % bpw) {
+	    unsigned long mask = (1UL << tail) - 1;
+	    abits[cnt-1] &= mask;
+	    bbits[cnt-1] &= mask;
+      }
+}
+
+void vvp_vector4array_t::set_word_bits(unsigned idx, const unsigned long*abits,
+				       const unsigned long*bbits)
+{
+      assert(idx < words_);
+      const unsigned bpw = vvp_vector4_t::BITS_PER_WORD;
+      v4cell*cell = poke_cell_(idx);
+
+      if (width_ <= bpw) {
+	    cell->abits_val_ = abits[0];
+	    cell->bbits_val_ = bbits[0];
+	    return;
+      }
+
+      unsigned cnt = (width_ + bpw - 1) / bpw;
+      if (cell->abits_ptr_ == 0) {
+	    cell->abits_ptr_ = new unsigned long[2*cnt];
+	    cell->bbits_ptr_ = cell->abits_ptr_ + cnt;
+      }
+
+      for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+	    cell->abits_ptr_[wdx] = abits[wdx];
+	    cell->bbits_ptr_[wdx] = bbits[wdx];
+      }
+}
+
+void vvp_vector4array_t::init_cells_(v4cell*cell, unsigned count) const
+{
       if (width_ <= vvp_vector4_t::BITS_PER_WORD) {
-	    for (unsigned idx = 0 ; idx < words_ ; idx += 1) {
-		  array_[idx].abits_val_ = vvp_vector4_t::WORD_X_ABITS;
-		  array_[idx].bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  cell[idx].abits_val_ = vvp_vector4_t::WORD_X_ABITS;
+		  cell[idx].bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
 	    }
       } else {
-	    for (unsigned idx = 0 ; idx < words_ ; idx += 1) {
-		  array_[idx].abits_ptr_ = 0;
-		  array_[idx].bbits_ptr_ = 0;
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  cell[idx].abits_ptr_ = 0;
+		  cell[idx].bbits_ptr_ = 0;
 	    }
       }
 }
 
+vvp_vector4array_sa::vvp_vector4array_sa(unsigned width__, unsigned words__)
+: vvp_vector4array_t(width__, words__)
+{
+      array_ = new v4cell[words_];
+      init_cells_(array_, words_);
+}
+
 vvp_vector4array_sa::~vvp_vector4array_sa()
 {
       if (array_) {
@@ -2390,6 +2507,81 @@ vvp_vector4_t vvp_vector4array_sa::get_word(unsigned index) const
       return get_word_(cell);
 }
 
+const vvp_vector4array_t::v4cell*vvp_vector4array_sa::peek_cell_(unsigned index) const
+{
+      return &array_[index];
+}
+
+vvp_vector4array_t::v4cell*vvp_vector4array_sa::poke_cell_(unsigned index)
+{
+      return &array_[index];
+}
+
+vvp_vector4array_sparse::vvp_vector4array_sparse(unsigned width__, unsigned words__)
+: vvp_vector4array_t(width__, words__)
+{
+      npages_ = (words_ + PAGE_WORDS - 1) / PAGE_WORDS;
+      pages_ = new v4cell*[npages_];
+      for (unsigned idx = 0 ; idx < npages_ ; idx += 1)
+	    pages_[idx] = 0;
+}
+
+vvp_vector4array_sparse::~vvp_vector4array_sparse()
+{
+      for (unsigned pdx = 0 ; pdx < npages_ ; pdx += 1) {
+	    v4cell*page = pages_[pdx];
+	    if (page == 0)
+		  continue;
+	    if (width_ > vvp_vector4_t::BITS_PER_WORD) {
+		  for (unsigned idx = 0 ; idx < PAGE_WORDS ; idx += 1)
+			if (page[idx].abits_ptr_)
+			      delete[]page[idx].abits_ptr_;
+	    }
+	    delete[]page;
+      }
+      delete[]pages_;
+}
+
+void vvp_vector4array_sparse::set_word(unsigned index, const vvp_vector4_t&that)
+{
+      assert(index < words_);
+
+      set_word_(poke_cell_(index), that);
+}
+
+vvp_vector4_t vvp_vector4array_sparse::get_word(unsigned index) const
+{
+      if (index >= words_)
+	    return vvp_vector4_t(width_, BIT4_X);
+
+      v4cell*page = pages_[index >> PAGE_BITS];
+      if (page == 0)
+	    return vvp_vector4_t(width_, BIT4_X);
+
+      return get_word_(page + (index & (PAGE_WORDS-1)));
+}
+
+const vvp_vector4array_t::v4cell*vvp_vector4array_sparse::peek_cell_(unsigned index) const
+{
+      const v4cell*page = pages_[index >> PAGE_BITS];
+      if (page == 0)
+	    return 0;
+
+      return page + (index & (PAGE_WORDS-1));
+}
+
+vvp_vector4array_t::v4cell*vvp_vector4array_sparse::poke_cell_(unsigned index)
+{
+      v4cell*&page = pages_[index >> PAGE_BITS];
+      if (page == 0) {
+	    page = new v4cell[PAGE_WORDS];
+	    init_cells_(page, PAGE_WORDS);
+	    count_sparse_pages += 1;
+      }
+
+      return page + (index & (PAGE_WORDS-1));
+}
+
 vvp_vector4array_aa::vvp_vector4array_aa(unsigned width__, unsigned words__)
 : vvp_vector4array_t(width__, words__)
 {
@@ -2403,18 +2595,7 @@ vvp_vector4array_aa::~vvp_vector4array_aa()
 void vvp_vector4array_aa::alloc_instance(vvp_context_t context)
 {
       v4cell*array = new v4cell[words_];
-
-      if (width_ <= vvp_vector4_t::BITS_PER_WORD) {
-	    for (unsigned idx = 0 ; idx < words_ ; idx += 1) {
-		  array[idx].abits_val_ = vvp_vector4_t::WORD_X_ABITS;
-		  array[idx].bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
-	    }
-      } else {
-	    for (unsigned idx = 0 ; idx < words_ ; idx += 1) {
-		  array[idx].abits_ptr_ = 0;
-		  array[idx].bbits_ptr_ = 0;
-	    }
-      }
+      init_cells_(array, words_);
 
       vvp_set_context_item(context, context_idx_, array);
 }
@@ -2476,6 +2657,18 @@ vvp_vector4_t vvp_vector4array_aa::get_word(unsigned index) const
       return get_word_(cell);
 }
 
+const vvp_vector4array_t::v4cell*vvp_vector4array_aa::peek_cell_(unsigned index) const
+{
+      return static_cast<v4cell*>
+            (vthread_get_rd_context_item(context_idx_)) + index;
+}
+
+vvp_vector4array_t::v4cell*vvp_vector4array_aa::poke_cell_(unsigned index)
+{
+      return static_cast<v4cell*>
+            (vthread_get_wt_context_item(context_idx_)) + index;
+}
+
 vvp_vector2_t::vvp_vector2_t()
 {
       vec_ = 0;
@@ -2856,6 +3049,16 @@ static void multiply_long(unsigned long a, unsigned long b,
 {
       assert(sizeof(unsigned long) %2 == 0);
 
+#if defined(__GNUC__) && defined(__SIZEOF_INT128__)
+      // The compiler can use the native double width multiply.
+      if (sizeof(unsigned long) == 8) {
+	    unsigned __int128 res = (unsigned __int128)a * b;
+	    low  = (unsigned long) res;
+	    high = (unsigned long) (res >> 64);
+	    return;
+      }
+#endif
+
       const unsigned long word_mask = (1UL << 4UL*sizeof(a)) - 1UL;
       unsigned long tmpa;
       unsigned long tmpb;
@@ -2889,6 +3092,157 @@ static void multiply_long(unsigned long a, unsigned long b,
       low  = (res[1] << 4UL*sizeof(unsigned long)) | res[0];
 }
 
+/*
+ * res[0..cnt) += val[0..cnt) * mul, and return the carry out of the
+ * top word. This is the inner loop of all the wide multiplies.
+ */
+static unsigned long multiply_add_row(unsigned long*res, const unsigned long*val,
+				      unsigned cnt, unsigned long mul)
+{
+      unsigned long carry = 0;
+      for (unsigned idx = 0 ;  idx < cnt ;  idx += 1) {
+	    unsigned long low, hig;
+	    multiply_long(val[idx], mul, low, hig);
+	    low += carry;
+	    hig += (low < carry)? 1 : 0;
+	    low += res[idx];
+	    hig += (low < res[idx])? 1 : 0;
+	    res[idx] = low;
+	    carry = hig;
+      }
+      return carry;
+}
+
+/*
+ * dst[0..dcnt) += src[0..scnt), with scnt <= dcnt. Return the carry
+ * out of the top of dst.
+ */
+static unsigned long add_words(unsigned long*dst, unsigned dcnt,
+			       const unsigned long*src, unsigned scnt)
+{
+      unsigned long carry = 0;
+      unsigned idx = 0;
+      for ( ; idx < scnt ;  idx += 1)
+	    dst[idx] = add_carry(dst[idx], src[idx], carry);
+      for ( ; carry && idx < dcnt ;  idx += 1)
+	    dst[idx] = add_carry(dst[idx], 0, carry);
+      return carry;
+}
+
+/*
+ * dst[0..dcnt) -= src[0..scnt), with scnt <= dcnt. The caller knows
+ * that the result is not negative.
+ */
+static void sub_words(unsigned long*dst, unsigned dcnt,
+		      const unsigned long*src, unsigned scnt)
+{
+      unsigned long carry = 1;
+      unsigned idx = 0;
+      for ( ; idx < scnt ;  idx += 1)
+	    dst[idx] = add_carry(dst[idx], ~src[idx], carry);
+      for ( ; idx < dcnt ;  idx += 1)
+	    dst[idx] = add_carry(dst[idx], ~0UL, carry);
+}
+
+/*
+ * Wide multiplies switch from the schoolbook method to Karatsuba
+ * when the operands are at least this many words. Below this the
+ * extra additions and temporaries cost more than the multiplies
+ * that Karatsuba saves.
+ */
+static const unsigned KARATSUBA_WORDS = 32;
+
+/*
+ * res[0..2*cnt) = a[0..cnt) * b[0..cnt)
+ */
+static void multiply_full(unsigned long*res, const unsigned long*a,
+			  const unsigned long*b, unsigned cnt)
+{
+      for (unsigned idx = 0 ;  idx < 2*cnt ;  idx += 1)
+	    res[idx] = 0;
+
+      for (unsigned bdx = 0 ;  bdx < cnt ;  bdx += 1) {
+	    if (b[bdx] == 0)
+		  continue;
+	    res[bdx+cnt] = multiply_add_row(res+bdx, a, cnt, b[bdx]);
+      }
+}
+
+static void multiply_karatsuba(unsigned long*res, const unsigned long*a,
+			       const unsigned long*b, unsigned cnt)
+{
+      if (cnt < KARATSUBA_WORDS) {
+	    multiply_full(res, a, b, cnt);
+	    return;
+      }
+
+	// Split the operands as a = a1*W^lo + a0, where a0 has lo
+	// words and a1 has hi >= lo words. The low and high halves
+	// of the result are the products a0*b0 and a1*b1.
+      const unsigned lo = cnt / 2;
+      const unsigned hi = cnt - lo;
+      multiply_karatsuba(res, a, b, lo);
+      multiply_karatsuba(res+2*lo, a+lo, b+lo, hi);
+
+	// The middle term is (a0+a1)*(b0+b1) - a0*b0 - a1*b1, which
+	// is added into the result starting at word lo.
+      unsigned long*sa  = new unsigned long[hi+1];
+      unsigned long*sb  = new unsigned long[hi+1];
+      unsigned long*mid = new unsigned long[2*hi+2];
+      for (unsigned idx = 0 ;  idx < hi ;  idx += 1) {
+	    sa[idx] = a[lo+idx];
+	    sb[idx] = b[lo+idx];
+      }
+      sa[hi] = add_words(sa, hi, a, lo);
+      sb[hi] = add_words(sb, hi, b, lo);
+      multiply_karatsuba(mid, sa, sb, hi+1);
+      sub_words(mid, 2*hi+2, res, 2*lo);
+      sub_words(mid, 2*hi+2, res+2*lo, 2*hi);
+      add_words(res+lo, 2*cnt-lo, mid, 2*hi+2);
+
+      delete[]mid;
+      delete[]sb;
+      delete[]sa;
+}
+
+/*
+ * res[0..cnt) = (a[0..cnt) * b[0..cnt)) truncated to cnt words. This
+ * is what the vvp_vector2_t multiply needs, since the result has
+ * the width of the operands. The truncated product only needs the
+ * full product of the low halves and the low halves of the two
+ * cross products, so the recursion does about half the work of a
+ * full multiply.
+ */
+static void multiply_low(unsigned long*res, const unsigned long*a,
+			 const unsigned long*b, unsigned cnt)
+{
+      if (cnt < KARATSUBA_WORDS) {
+	    for (unsigned idx = 0 ;  idx < cnt ;  idx += 1)
+		  res[idx] = 0;
+	    for (unsigned bdx = 0 ;  bdx < cnt ;  bdx += 1) {
+		  if (b[bdx] == 0)
+			continue;
+		  multiply_add_row(res+bdx, a, cnt-bdx, b[bdx]);
+	    }
+	    return;
+      }
+
+      const unsigned hi = cnt / 2;
+      const unsigned lo = cnt - hi;
+
+      unsigned long*tmp = new unsigned long[2*lo];
+      multiply_karatsuba(tmp, a, b, lo);
+      for (unsigned idx = 0 ;  idx < cnt ;  idx += 1)
+	    res[idx] = tmp[idx];
+
+      multiply_low(tmp, a, b+lo, hi);
+      add_words(res+lo, hi, tmp, hi);
+      multiply_low(tmp, a+lo, b, hi);
+      add_words(res+lo, hi, tmp, hi);
+
+      delete[]tmp;
+}
+
 vvp_vector2_t operator * (const vvp_vector2_t&a, const vvp_vector2_t&b)
 {
       const unsigned bits_per_word = 8 * sizeof(a.vec_[0]);
@@ -2899,38 +3253,149 @@ vvp_vector2_t operator * (const vvp_vector2_t&a, const vvp_vector2_t&b)
 
       unsigned words = (r.wid_ + bits_per_word - 1) / bits_per_word;
 
-      for (unsigned bdx = 0 ;  bdx < words ;  bdx += 1) {
-	    unsigned long tmpb = b.vec_[bdx];
-	    if (tmpb == 0)
-		  continue;
+      multiply_low(r.vec_, a.vec_, b.vec_, words);
 
-	    for (unsigned adx = 0 ;  adx < words ;  adx += 1) {
-		  unsigned long tmpa = a.vec_[adx];
-		  if (tmpa == 0)
-			continue;
+      return r;
+}
+
+/*
+ * The long division works on 32-bit digits so that the quotient
+ * estimate of each step can use a native 64-bit divide on any host.
+ */
+static const unsigned DIGITS_PER_WORD = sizeof(unsigned long) / sizeof(uint32_t);
+
+static unsigned words_to_digits(uint32_t*dig, const unsigned long*val,
+				unsigned words)
+{
+      unsigned cnt = 0;
+      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
+	    unsigned long tmp = val[idx];
+	    for (unsigned ddx = 0 ;  ddx < DIGITS_PER_WORD ;  ddx += 1) {
+		  dig[cnt++] = (uint32_t) tmp;
+		  tmp >>= 16;
+		  tmp >>= 16;
+	    }
+      }
+
+	// Return the number of significant digits.
+      while (cnt > 0 && dig[cnt-1] == 0)
+	    cnt -= 1;
+      return cnt;
+}
+
+static void digits_to_words(unsigned long*val, unsigned words,
+			    const uint32_t*dig, unsigned cnt)
+{
+      unsigned ddx = 0;
+      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
+	    unsigned long tmp = 0;
+	    for (unsigned sh = 0 ;  sh < DIGITS_PER_WORD ;  sh += 1, ddx += 1) {
+		  if (ddx < cnt)
+			tmp |= (unsigned long) dig[ddx] << (32*sh);
+	    }
+	    val[idx] = tmp;
+      }
+}
 
-		  unsigned long low, hig;
-		  multiply_long(tmpa, tmpb, low, hig);
+/*
+ * This is Algorithm D from "Seminumerical Algorithms, Third Edition"
+ * by Donald E. Knuth section 4.3.1. Divide the ucnt digit number u
+ * by the vcnt digit number v, giving the ucnt-vcnt+1 digit quotient
+ * and the vcnt digit remainder. The top digit of v must be non-zero
+ * and ucnt >= vcnt.
+ */
+static void divide_digits(uint32_t*quot, uint32_t*rem,
+			  const uint32_t*u, unsigned ucnt,
+			  const uint32_t*v, unsigned vcnt)
+{
+      const uint64_t base = (uint64_t)1 << 32;
+
+      if (vcnt == 1) {
+	    uint64_t tmp = 0;
+	    for (unsigned idx = ucnt ;  idx > 0 ;  idx -= 1) {
+		  tmp = (tmp << 32) | u[idx-1];
+		  quot[idx-1] = (uint32_t) (tmp / v[0]);
+		  tmp %= v[0];
+	    }
+	    rem[0] = (uint32_t) tmp;
+	    return;
+      }
 
-		  unsigned long carry = 0;
-		  for (unsigned sdx = 0
-			     ; (adx+bdx+sdx) < words
-			     ;  sdx += 1) {
+	// D1: Normalize so that the top divisor digit has its MSB set.
+      unsigned shift = 0;
+      while ((v[vcnt-1] << shift & 0x80000000) == 0)
+	    shift += 1;
+
+      uint32_t*vn = new uint32_t[vcnt];
+      uint32_t*un = new uint32_t[ucnt+1];
+      for (unsigned idx = vcnt-1 ;  idx > 0 ;  idx -= 1)
+	    vn[idx] = (v[idx] << shift) | (shift? v[idx-1] >> (32-shift) : 0);
+      vn[0] = v[0] << shift;
+      un[ucnt] = shift? u[ucnt-1] >> (32-shift) : 0;
+      for (unsigned idx = ucnt-1 ;  idx > 0 ;  idx -= 1)
+	    un[idx] = (u[idx] << shift) | (shift? u[idx-1] >> (32-shift) : 0);
+      un[0] = u[0] << shift;
+
+      for (unsigned jdx = ucnt-vcnt+1 ;  jdx > 0 ;  jdx -= 1) {
+	    const unsigned j = jdx - 1;
+
+	      // D3: Estimate the quotient digit from the top two
+	      // digits. It is at most 2 too large after the test.
+	    uint64_t num = ((uint64_t)un[j+vcnt] << 32) | un[j+vcnt-1];
+	    uint64_t qhat = num / vn[vcnt-1];
+	    uint64_t rhat = num % vn[vcnt-1];
+	    while (qhat >= base
+		   || qhat*vn[vcnt-2] > ((rhat << 32) | un[j+vcnt-2])) {
+		  qhat -= 1;
+		  rhat += vn[vcnt-1];
+		  if (rhat >= base)
+			break;
+	    }
 
-			r.vec_[adx+bdx+sdx] = add_carry(r.vec_[adx+bdx+sdx],
-							low, carry);
-			low = hig;
-			hig = 0;
+	      // D4: Multiply and subtract.
+	    uint64_t carry = 0;
+	    uint64_t borrow = 0;
+	    for (unsigned idx = 0 ;  idx < vcnt ;  idx += 1) {
+		  uint64_t prod = qhat * vn[idx] + carry;
+		  carry = prod >> 32;
+		  uint64_t diff = (uint64_t)un[idx+j] - (uint32_t)prod - borrow;
+		  un[idx+j] = (uint32_t) diff;
+		  borrow = diff >> 63;
+	    }
+	    uint64_t diff = (uint64_t)un[j+vcnt] - carry - borrow;
+	    un[j+vcnt] = (uint32_t) diff;
+
+	      // D5, D6: If the result went negative, then the estimate
+	      // was one too large. Add the divisor back in.
+	    if (diff >> 63) {
+		  qhat -= 1;
+		  carry = 0;
+		  for (unsigned idx = 0 ;  idx < vcnt ;  idx += 1) {
+			uint64_t sum = (uint64_t)un[idx+j] + vn[idx] + carry;
+			un[idx+j] = (uint32_t) sum;
+			carry = sum >> 32;
 		  }
+		  un[j+vcnt] += (uint32_t) carry;
 	    }
+
+	    quot[j] = (uint32_t) qhat;
       }
 
-      return r;
+	// D8: Unnormalize the remainder.
+      for (unsigned idx = 0 ;  idx < vcnt ;  idx += 1)
+	    rem[idx] = (un[idx] >> shift) | (shift? un[idx+1] << (32-shift) : 0);
+
+      delete[]un;
+      delete[]vn;
 }
 
-static void div_mod (vvp_vector2_t dividend, vvp_vector2_t divisor,
-		     vvp_vector2_t&quotient, vvp_vector2_t&remainder)
+/*
+ * The quotient and remainder both have the width of the dividend.
+ */
+void div_mod (const vvp_vector2_t&dividend, const vvp_vector2_t&divisor,
+	      vvp_vector2_t&quotient, vvp_vector2_t&remainder)
 {
+      const unsigned BITS_PER_WORD = 8 * sizeof(unsigned long);
 
       quotient = vvp_vector2_t(0, dividend.size());
 
@@ -2939,34 +3404,32 @@ static void div_mod (vvp_vector2_t dividend, vvp_vector2_t divisor,
 	    exit(255);
       }
 
-      if (dividend < divisor) {
-	    remainder = dividend;
+      remainder = dividend;
+      if (dividend < divisor)
 	    return;
-      }
 
-      vvp_vector2_t mask (1, dividend.size());
+      const unsigned awords = (dividend.wid_ + BITS_PER_WORD-1) / BITS_PER_WORD;
+      const unsigned bwords = (divisor.wid_ + BITS_PER_WORD-1) / BITS_PER_WORD;
 
-	// Make the dividend 1 bit larger to prevent overflow of
-	// divtmp in startup.
-      dividend = vvp_vector2_t(dividend, dividend.size()+1);
-      vvp_vector2_t divtmp (divisor, dividend.size());
+      uint32_t*u = new uint32_t[awords*DIGITS_PER_WORD];
+      uint32_t*v = new uint32_t[bwords*DIGITS_PER_WORD];
+      unsigned ucnt = words_to_digits(u, dividend.vec_, awords);
+      unsigned vcnt = words_to_digits(v, divisor.vec_, bwords);
 
-      while (divtmp < dividend) {
-	    divtmp <<= 1;
-	    mask <<= 1;
-      }
+	// The dividend >= divisor, and the divisor is not zero, so
+	// the digit counts satisfy the requirements of the divide.
+      assert(vcnt > 0 && ucnt >= vcnt);
+      uint32_t*q = new uint32_t[ucnt-vcnt+1];
+      uint32_t*r = new uint32_t[vcnt];
+      divide_digits(q, r, u, ucnt, v, vcnt);
 
-      while (dividend >= divisor) {
-	    if (divtmp <= dividend) {
-		  dividend -= divtmp;
-		  quotient += mask;
-	    }
-
-	    divtmp >>= 1;
-	    mask >>= 1;
-      }
+      digits_to_words(quotient.vec_, awords, q, ucnt-vcnt+1);
+      digits_to_words(remainder.vec_, awords, r, vcnt);
 
-      remainder = vvp_vector2_t(dividend, mask.size());
+      delete[]r;
+      delete[]q;
+      delete[]v;
+      delete[]u;
 }
 
 vvp_vector2_t operator - (const vvp_vector2_t&that)
@@ -3210,14 +3673,37 @@ vvp_vector8_t::vvp_vector8_t(const vvp_vector4_t&that,
       if (size_ == 0)
 	    return;
 
-      if (size_ <= sizeof(val_)) {
+      if (size_ <= sizeof(val_))
 	    ptr_ = 0; // Prefill all val_ bytes
-	    for (unsigned idx = 0 ; idx < size_ ; idx += 1)
-		  val_[idx] = vvp_scalar_t(that.value(idx),str0, str1).raw();
-      } else {
+      else
 	    ptr_ = new unsigned char[size_];
-	    for (unsigned idx = 0 ;  idx < size_ ;  idx += 1)
-		  ptr_[idx] = vvp_scalar_t(that.value(idx), str0, str1).raw();
+
+	// There are only 4 possible results, so make them once and
+	// then pick them by the a/b bits of the source words. The
+	// table is indexed by the vvp_bit4_t encoding.
+      unsigned char map[4];
+      map[BIT4_0] = vvp_scalar_t(BIT4_0, str0, str1).raw();
+      map[BIT4_1] = vvp_scalar_t(BIT4_1, str0, str1).raw();
+      map[BIT4_Z] = vvp_scalar_t(BIT4_Z, str0, str1).raw();
+      map[BIT4_X] = vvp_scalar_t(BIT4_X, str0, str1).raw();
+
+      const unsigned long*abits = that.size_ > vvp_vector4_t::BITS_PER_WORD
+	    ? that.abits_ptr_ : &that.abits_val_;
+      const unsigned long*bbits = that.size_ > vvp_vector4_t::BITS_PER_WORD
+	    ? that.bbits_ptr_ : &that.bbits_val_;
+
+      unsigned char*dst = bytes_();
+      for (unsigned idx = 0 ; idx < size_ ; idx += vvp_vector4_t::BITS_PER_WORD) {
+	    unsigned long aword = *abits++;
+	    unsigned long bword = *bbits++;
+	    unsigned cnt = size_ - idx;
+	    if (cnt > vvp_vector4_t::BITS_PER_WORD)
+		  cnt = vvp_vector4_t::BITS_PER_WORD;
+	    for (unsigned bit = 0 ; bit < cnt ; bit += 1) {
+		  *dst++ = map[(aword&1) | ((bword&1) << 1)];
+		  aword >>= 1;
+		  bword >>= 1;
+	    }
       }
 }
 
@@ -3847,11 +4333,141 @@ unsigned vvp_switch_strength_map[2][8] = {
       }
 };
 
+/*
+ * The vector8 resolve and reduce functions work on the raw scalar
+ * bytes 8 at a time, loaded into a 64bit word with bit idx of the
+ * chunk in byte idx of the word. The per-byte tests use the usual
+ * carry-free tricks:
+ *
+ *    scalars8_driven  - 0x80 in each byte that is not HiZ, that is
+ *                       where (byte&0x77) != 0.
+ *    scalars8_equal   - 0x80 in each byte where the two words match.
+ *    scalars8_gather  - collect the 0x80 bits into an 8bit mask.
+ */
+static inline uint64_t scalars8_load(const unsigned char*src, unsigned cnt)
+{
+      uint64_t res = 0;
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1)
+	    res |= (uint64_t)src[idx] << (8*idx);
+      return res;
+}
+
+static inline void scalars8_store(unsigned char*dst, uint64_t val, unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1)
+	    dst[idx] = val >> (8*idx);
+}
+
+static const uint64_t SCALARS8_HIGH = 0x8080808080808080ULL;
+static const uint64_t SCALARS8_LOW7 = 0x7f7f7f7f7f7f7f7fULL;
+static const uint64_t SCALARS8_STR = 0x7777777777777777ULL;
+
+static inline uint64_t scalars8_driven(uint64_t val)
+{
+      return ((val & SCALARS8_STR) + SCALARS8_LOW7) & SCALARS8_HIGH;
+}
+
+static inline uint64_t scalars8_equal(uint64_t a, uint64_t b)
+{
+      uint64_t diff = a ^ b;
+      return ~(((diff & SCALARS8_LOW7) + SCALARS8_LOW7) | diff) & SCALARS8_HIGH;
+}
+
+static inline unsigned scalars8_gather(uint64_t high)
+{
+      return (high * 0x0002040810204081ULL) >> 56;
+}
+
+vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b)
+{
+      assert(a.size() == b.size());
+      vvp_vector8_t out (a.size());
+
+      const unsigned char*ap = a.bytes_();
+      const unsigned char*bp = b.bytes_();
+      unsigned char*op = out.bytes_();
+
+      for (unsigned idx = 0 ; idx < out.size() ; idx += 8) {
+	    unsigned cnt = out.size() - idx;
+	    if (cnt > 8) cnt = 8;
+
+	    uint64_t aval = scalars8_load(ap+idx, cnt);
+	    uint64_t bval = scalars8_load(bp+idx, cnt);
+	    uint64_t adrv = scalars8_driven(aval);
+	    uint64_t bdrv = scalars8_driven(bval);
+
+	      // Where a is HiZ the result is b, otherwise it is a. That
+	      // covers all the bits that do not really conflict.
+	    uint64_t amask = (adrv >> 7) * 0xff;
+	    uint64_t res = (aval & amask) | (bval & ~amask);
+	    scalars8_store(op+idx, res, cnt);
+
+	    uint64_t conflict = adrv & bdrv & ~scalars8_equal(aval, bval);
+	    if (conflict == 0)
+		  continue;
+
+	    for (unsigned bit = 0 ; bit < cnt ; bit += 1) {
+		  if (! (conflict & (0x80ULL << (8*bit))))
+			continue;
+		  out.set_bit(idx+bit, resolve(a.value(idx+bit), b.value(idx+bit)));
+	    }
+      }
+
+      return out;
+}
+
+/*
+ * The scalar to bit4 mapping is (see vvp_scalar_t::value):
+ *
+ *    HiZ            --> a=0, b=1
+ *    flags 0x00     --> a=0, b=0
+ *    flags 0x88     --> a=1, b=0
+ *    flags 0x80/0x08--> a=1, b=1
+ *
+ * so with f1 the 0x80 flag and f0 the 0x08 flag, a driven bit has
+ * a = f1|f0 and b = f1^f0.
+ */
 vvp_vector4_t reduce4(const vvp_vector8_t&that)
 {
       vvp_vector4_t out (that.size());
-      for (unsigned idx = 0 ;  idx < out.size() ;  idx += 1)
-	    out.set_bit(idx, that.value(idx).value());
+      if (that.size() == 0)
+	    return out;
+
+      const unsigned BPW = vvp_vector4_t::BITS_PER_WORD;
+      unsigned long*abits = out.size_ > BPW? out.abits_ptr_ : &out.abits_val_;
+      unsigned long*bbits = out.size_ > BPW? out.bbits_ptr_ : &out.bbits_val_;
+
+      const unsigned char*src = that.bytes_();
+      for (unsigned base = 0 ; base < that.size() ; base += BPW) {
+	    unsigned long aword = 0;
+	    unsigned long bword = 0;
+	    unsigned wcnt = that.size() - base;
+	    if (wcnt > BPW)
+		  wcnt = BPW;
+	      // Unused bits in the last word stay X, as they would in
+	      // a newly constructed vector.
+	    if (wcnt < BPW) {
+		  aword = ~0UL << wcnt;
+		  bword = ~0UL << wcnt;
+	    }
+
+	    for (unsigned idx = 0 ; idx < wcnt ; idx += 8) {
+		  unsigned cnt = wcnt - idx;
+		  if (cnt > 8) cnt = 8;
+		  uint64_t val = scalars8_load(src+base+idx, cnt);
+		  uint64_t drv = scalars8_driven(val);
+		  uint64_t f1 = val & SCALARS8_HIGH;
+		  uint64_t f0 = (val << 4) & SCALARS8_HIGH;
+		  uint64_t amask = drv & (f1 | f0);
+		  uint64_t bmask = (drv & (f1 ^ f0)) | (~drv & SCALARS8_HIGH);
+		  unsigned long keep = (1UL << cnt) - 1;
+		  aword |= (unsigned long)(scalars8_gather(amask) & keep) << idx;
+		  bword |= (unsigned long)(scalars8_gather(bmask) & keep) << idx;
+	    }
+
+	    *abits++ = aword;
+	    *bbits++ = bword;
+      }
 
       return out;
 }
@@ -243,6 +243,10 @@ class vvp_vector4_t {
       friend class vvp_vector4array_t;
       friend class vvp_vector4array_sa;
       friend class vvp_vector4array_aa;
+      friend class vvp_vector4array_sparse;
+	// The strength vectors convert to and from vector4 words.
+      friend class vvp_vector8_t;
+      friend vvp_vector4_t reduce4(const vvp_vector8_t&that);
 
     public:
       static const vvp_vector4_t nil;
@@ -602,6 +606,15 @@ class vvp_vector4array_t {
       virtual vvp_vector4_t get_word(unsigned idx) const = 0;
       virtual void set_word(unsigned idx, const vvp_vector4_t&that) = 0;
 
+	// Copy a word to or from arrays of aval and bval longs,
+	// without making a vvp_vector4_t. Each array holds
+	// (width+BITS_PER_WORD-1)/BITS_PER_WORD longs. The bits past
+	// the width of the word are returned as zero.
+      void get_word_bits(unsigned idx, unsigned long*abits,
+			 unsigned long*bbits) const;
+      void set_word_bits(unsigned idx, const unsigned long*abits,
+			 const unsigned long*bbits);
+
     protected:
       struct v4cell {
 	    union {
@@ -614,8 +627,15 @@ class vvp_vector4array_t {
 	    };
       };
 
+	// Get the cell of a word for reading, or nil if the word has
+	// not been written, and get the cell of a word for writing.
+      virtual const v4cell*peek_cell_(unsigned idx) const = 0;
+      virtual v4cell*poke_cell_(unsigned idx) = 0;
+
       vvp_vector4_t get_word_(v4cell*cell) const;
       void set_word_(v4cell*cell, const vvp_vector4_t&that);
+	// Set the cells to the X value that all words start with.
+      void init_cells_(v4cell*cell, unsigned count) const;
 
       unsigned width_;
       unsigned words_;
@@ -637,10 +657,40 @@ class vvp_vector4array_sa : public vvp_vector4array_t {
       vvp_vector4_t get_word(unsigned idx) const override;
       void set_word(unsigned idx, const vvp_vector4_t&that) override;
 
+    protected:
+      const v4cell*peek_cell_(unsigned idx) const override;
+      v4cell*poke_cell_(unsigned idx) override;
+
     private:
       v4cell* array_;
 };
 
+/*
+ * Sparse vvp_vector4array_t, for memories that are too large to
+ * allocate in full. The words are kept in pages that are allocated
+ * when a word of the page is first written. The words of a page that
+ * has not been written are all X.
+ */
+class vvp_vector4array_sparse : public vvp_vector4array_t {
+
+    public:
+      vvp_vector4array_sparse(unsigned width, unsigned words);
+      ~vvp_vector4array_sparse() override;
+
+      vvp_vector4_t get_word(unsigned idx) const override;
+      void set_word(unsigned idx, const vvp_vector4_t&that) override;
+
+      enum { PAGE_BITS = 10, PAGE_WORDS = 1 << PAGE_BITS };
+
+    protected:
+      const v4cell*peek_cell_(unsigned idx) const override;
+      v4cell*poke_cell_(unsigned idx) override;
+
+    private:
+      v4cell**pages_;
+      unsigned npages_;
+};
+
 /*
  * Automatically allocated vvp_vector4array_t
  */
@@ -659,6 +709,10 @@ class vvp_vector4array_aa : public vvp_vector4array_t, public automatic_hooks_s
       vvp_vector4_t get_word(unsigned idx) const override;
       void set_word(unsigned idx, const vvp_vector4_t&that) override;
 
+    protected:
+      const v4cell*peek_cell_(unsigned idx) const override;
+      v4cell*poke_cell_(unsigned idx) override;
+
     private:
       unsigned context_idx_;
 };
@@ -677,6 +731,8 @@ class vvp_vector2_t {
       friend bool operator <  (const vvp_vector2_t&, const vvp_vector2_t&);
       friend bool operator <= (const vvp_vector2_t&, const vvp_vector2_t&);
       friend bool operator == (const vvp_vector2_t&, const vvp_vector2_t&);
+      friend void div_mod(const vvp_vector2_t&, const vvp_vector2_t&,
+			  vvp_vector2_t&, vvp_vector2_t&);
 
     public:
       vvp_vector2_t();
@@ -922,6 +978,8 @@ extern std::ostream& operator<< (std::ostream&, vvp_scalar_t);
 class vvp_vector8_t {
 
       friend vvp_vector8_t part_expand(const vvp_vector8_t&, unsigned, unsigned);
+      friend vvp_vector8_t resolve(const vvp_vector8_t&, const vvp_vector8_t&);
+      friend vvp_vector4_t reduce4(const vvp_vector8_t&that);
 
     public:
       explicit vvp_vector8_t(unsigned size =0);
@@ -952,6 +1010,13 @@ class vvp_vector8_t {
       vvp_vector8_t(const vvp_vector8_t&that);
       vvp_vector8_t& operator= (const vvp_vector8_t&that);
 
+    private:
+	// The raw scalar encodings, one byte per bit.
+      const unsigned char*bytes_() const
+	    { return size_ <= sizeof(val_)? val_ : ptr_; }
+      unsigned char*bytes_()
+	    { return size_ <= sizeof(val_)? val_ : ptr_; }
+
     private:
       unsigned size_;
       union {
@@ -961,18 +1026,10 @@ class vvp_vector8_t {
 };
 
   /* Resolve uses the default Verilog resolver algorithm to resolve
-     two drive vectors to a single output. */
-inline vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b)
-{
-      assert(a.size() == b.size());
-      vvp_vector8_t out (a.size());
-
-      for (unsigned idx = 0 ;  idx < out.size() ;  idx += 1) {
-	    out.set_bit(idx, resolve(a.value(idx), b.value(idx)));
-      }
-
-      return out;
-}
+     two drive vectors to a single output. The vectors are processed
+     8 bits at a time, and only bits that actually conflict go
+     through the scalar resolver. */
+extern vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b);
 
   /* This lookup tabke implements the strength reduction implied by
      Verilog standard switch devices. The major dimension selects
@@ -1129,6 +1186,17 @@ template <class T> std::ostream& operator << (std::ostream&out, vvp_sub_pointer_
  * methods of the vvp_net_t class are similar, but they follow the
  * output, possibly filtered, from the vvp_net_t.
  */
+/*
+ * After compile, the fan-out of a net output is also kept as a
+ * contiguous array of the receiving functors and their ports, so that
+ * propagation does not have to chase the out_ chain through the
+ * receiving nets. The array ends with a nil fun.
+ */
+struct vvp_fanout_s {
+      vvp_net_fun_t*fun;
+      vvp_net_ptr_t port;
+};
+
 class vvp_net_t {
     public:
       vvp_net_t();
@@ -1175,6 +1243,18 @@ class vvp_net_t {
     // This needs to be public so that SDF interconnects can be inserted
     public:
       vvp_net_ptr_t out_;
+	// Anything that changes the out_ chain directly must call this
+	// so that the net stops using its fan-out array.
+      void fanout_changed() { fanout_ = 0; }
+
+	// Build the fan-out arrays for all the nets. This is called
+	// once compile is complete.
+      static void compile_fanout(void);
+
+    private:
+      void send_out_vec4_(const vvp_vector4_t&val, vvp_context_t context);
+      void send_out_vec8_(const vvp_vector8_t&val);
+      vvp_fanout_s*fanout_;
 
     public: // Need a better new for these objects.
       static void* operator new(std::size_t size);
@@ -1534,8 +1614,21 @@ class vvp_wide_fun_t : public vvp_net_fun_t {
 };
 
 
+/*
+ * The run time profiler (profile.h) counts the values that each class
+ * of functor receives. Every send function tests the profile_flag
+ * once, and if it is set has the profiler count the receivers that
+ * the value is about to go to.
+ */
+extern bool profile_flag;
+extern void profile_count_sends(vvp_net_ptr_t ptr);
+extern void profile_count_sends(const vvp_fanout_s*fan);
+
 inline void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val, vvp_context_t context)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -1546,12 +1639,26 @@ inline void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val, vvp_contex
       }
 }
 
+inline void vvp_send_vec4(const vvp_fanout_s*fan, const vvp_vector4_t&val,
+			  vvp_context_t context)
+{
+      if (profile_flag)
+	    profile_count_sends(fan);
+
+      for ( ; fan->fun ; fan += 1)
+	    fan->fun->recv_vec4(fan->port, val, context);
+}
+
 extern void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val);
+extern void vvp_send_vec8(const vvp_fanout_s*fan, const vvp_vector8_t&val);
 extern void vvp_send_real(vvp_net_ptr_t ptr, double val,
                           vvp_context_t context);
 
 inline void vvp_send_string(vvp_net_ptr_t ptr, const std::string&val, vvp_context_t context)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -1564,6 +1671,9 @@ inline void vvp_send_string(vvp_net_ptr_t ptr, const std::string&val, vvp_contex
 
 inline void vvp_send_object(vvp_net_ptr_t ptr, vvp_object_t val, vvp_context_t context)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -1596,6 +1706,9 @@ inline void vvp_send_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
 			     unsigned base, unsigned vwid,
 			     vvp_context_t context)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -1609,6 +1722,9 @@ inline void vvp_send_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
 inline void vvp_send_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&val,
 			     unsigned base, unsigned vwid)
 {
+      if (profile_flag)
+	    profile_count_sends(ptr);
+
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next_val = cur->port[ptr.port()];
 
@@ -1619,10 +1735,26 @@ inline void vvp_send_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&val,
       }
 }
 
+inline void vvp_net_t::send_out_vec4_(const vvp_vector4_t&val, vvp_context_t context)
+{
+      if (fanout_)
+	    vvp_send_vec4(fanout_, val, context);
+      else
+	    vvp_send_vec4(out_, val, context);
+}
+
+inline void vvp_net_t::send_out_vec8_(const vvp_vector8_t&val)
+{
+      if (fanout_)
+	    vvp_send_vec8(fanout_, val);
+      else
+	    vvp_send_vec8(out_, val);
+}
+
 inline void vvp_net_t::send_vec4(const vvp_vector4_t&val, vvp_context_t context)
 {
       if (fil == 0) {
-	    vvp_send_vec4(out_, val, context);
+	    send_out_vec4_(val, context);
 	    return;
       }
 
@@ -1631,10 +1763,10 @@ inline void vvp_net_t::send_vec4(const vvp_vector4_t&val, vvp_context_t context)
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec4(out_, val, context);
+	    send_out_vec4_(val, context);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec4(out_, rep, context);
+	    send_out_vec4_(rep, context);
 	    break;
       }
 }
@@ -1664,7 +1796,7 @@ inline void vvp_net_t::send_vec4_pv(const vvp_vector4_t&val,
 inline void vvp_net_t::send_vec8(const vvp_vector8_t&val)
 {
       if (fil == 0) {
-	    vvp_send_vec8(out_, val);
+	    send_out_vec8_(val);
 	    return;
       }
 
@@ -1673,10 +1805,10 @@ inline void vvp_net_t::send_vec8(const vvp_vector8_t&val)
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec8(out_, val);
+	    send_out_vec8_(val);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec8(out_, rep);
+	    send_out_vec8_(rep);
 	    break;
       }
 }
@@ -122,7 +122,7 @@ void vvp_net_t::force_vec4(const vvp_vector4_t&val, const vvp_vector2_t&mask)
       assert(fil);
       fil->force_fil_vec4(val, mask);
       fun->force_flag(false);
-      vvp_send_vec4(out_, val, 0);
+      send_out_vec4_(val, 0);
 }
 
 void vvp_net_t::force_vec8(const vvp_vector8_t&val, const vvp_vector2_t&mask)
@@ -130,7 +130,7 @@ void vvp_net_t::force_vec8(const vvp_vector8_t&val, const vvp_vector2_t&mask)
       assert(fil);
       fil->force_fil_vec8(val, mask);
       fun->force_flag(false);
-      vvp_send_vec8(out_, val);
+      send_out_vec8_(val);
 }
 
 void vvp_net_t::force_real(double val, const vvp_vector2_t&mask)
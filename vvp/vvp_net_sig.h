@@ -409,7 +409,7 @@ class vvp_wire_base  : public vvp_net_fil_t, public vvp_signal_value {
       virtual bool is_forced(unsigned idx) const;
 };
 
-class vvp_wire_vec4 : public vvp_wire_base {
+class vvp_wire_vec4 final : public vvp_wire_base {
 
     public:
       vvp_wire_vec4(unsigned wid, vvp_bit4_t init);
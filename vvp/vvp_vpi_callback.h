@@ -23,6 +23,7 @@
 # include  "vpi_user.h"
 
 class value_callback;
+struct change_set_member;
 
 /*
  * Things derived from vvp_vpi_callback may have callbacks
@@ -41,6 +42,10 @@ class vvp_vpi_callback {
       void attach_as_word(struct __vpiArray* arr, unsigned long addr);
 
       void add_vpi_callback(value_callback*);
+	// Members of a change set are not callbacks. A value change
+	// only marks them changed in their set.
+      void add_change_member(struct change_set_member*);
+      void remove_change_member(struct change_set_member*);
 #ifdef CHECK_WITH_VALGRIND
 	/* This has only been tested at EOS. */
       void clear_all_callbacks(void);
@@ -57,6 +62,7 @@ class vvp_vpi_callback {
 
     private:
       value_callback*vpi_callbacks_;
+      struct change_set_member*change_members_;
       struct __vpi_array_word*array_words_;
 };
 